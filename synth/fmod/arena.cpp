@@ -0,0 +1,41 @@
+/**
+ * @file arena.cpp
+ * @brief Monotonic arena
+ */
+
+#include "arena.h"
+#include <cstring>
+
+namespace FModel {
+
+void* Arena::allocate(size_t size, size_t align) {
+    bytes_used += size;
+    if (size > BLOCK_SIZE / 4) {
+        // Large requests get a block of their own; the current block stays open
+        large_blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+        return large_blocks.back().get();
+    }
+    size_t offset = (block_used + align - 1) & ~(align - 1);
+    if (offset + size > BLOCK_SIZE) {
+        blocks.push_back(std::unique_ptr<char[]>(new char[BLOCK_SIZE]));
+        offset = 0;
+    }
+    block_used = offset + size;
+    return blocks.back().get() + offset;
+}
+
+std::string_view Arena::copy(std::string_view str) {
+    if (str.empty()) return std::string_view();
+    char* dest = static_cast<char*>(allocate(str.size(), 1));
+    std::memcpy(dest, str.data(), str.size());
+    return std::string_view(dest, str.size());
+}
+
+void Arena::reset() {
+    blocks.clear();
+    large_blocks.clear();
+    block_used = BLOCK_SIZE;
+    bytes_used = 0;
+}
+
+} // namespace FModel
@@ -0,0 +1,75 @@
+/**
+ * @file arena.h
+ * @brief Monotonic arena owning the circuit topology
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace FModel {
+
+/**
+ * Bump allocator over large blocks. Objects created in a row sit next to
+ * each other, and nothing is freed individually: reset() and the destructor
+ * release whole blocks without running any destructor, so only types whose
+ * destructors do nothing may live here.
+ */
+class Arena {
+public:
+    Arena() : block_used(BLOCK_SIZE), bytes_used(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Uninitialized storage for size bytes, aligned to align (at most alignof(max_align_t))
+     */
+    void* allocate(size_t size, size_t align);
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Uninitialized array of count trivially destructible elements
+     */
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * @brief Copy of str in the arena, valid until reset()
+     */
+    std::string_view copy(std::string_view str);
+
+    /**
+     * @brief Release everything; pointers into the arena become invalid
+     */
+    void reset();
+
+    size_t bytesUsed() const { return bytes_used; }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 256 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::unique_ptr<char[]>> large_blocks;
+    size_t block_used;   // bytes used in blocks.back()
+    size_t bytes_used;
+};
+
+} // namespace FModel
+
+#endif // ARENA_H
@@ -0,0 +1,449 @@
+/**
+ * @file bench.cpp
+ * @brief Throughput benchmark of the simulation engines
+ *
+ * Runs the generated sample netlists and synthetically scaled designs
+ * (ripple-carry chains of 4-bit adders, wide shift registers) through each
+ * engine that applies to them and prints one JSON object per line:
+ *
+ *   {"design": "adder_chain_256", "engine": "bit-parallel", "components": ...,
+ *    "nets": ..., "gates": ..., "threads": ..., "vectors": ..., "load_ms": ...,
+ *    "compile_ms": ..., "sim_ms": ..., "vectors_per_sec": ...,
+ *    "gate_evals_per_sec": ..., "engine_ms": ..., "engine_vectors_per_sec": ...,
+ *    "engine_gate_evals_per_sec": ..., "peak_rss_kb": ...}
+ *
+ * (bit-parallel lines also carry "kernel_vectors", "kernel_ms" and
+ * "kernel_gate_evals_per_sec").
+ *
+ * load_ms is the whole loadFromNetlist() (parse, validate, compile) and
+ * compile_ms one more compile() on its own. gate_evals_per_sec counts every
+ * gate of the netlist once per vector, whatever the engine skips. Each
+ * design runs in a child process, so peak_rss_kb is the high-water mark of
+ * that design alone. Vectors are seeded random levels on every primary
+ * input with no outputs checked. sim_ms streams them from a packed vector
+ * file, so its rates include decoding every row. engine_ms runs the same
+ * vectors again, decoded beforehand and held in memory, so only applying
+ * them and the engine itself are timed. Applying by name still dominates
+ * the packed engine, so for bit-parallel the kernel is also timed alone:
+ * checkStimulus() drives bit planes of random patterns straight into the
+ * packed schedule, with the circuit as its own golden model, so every
+ * vector is evaluated twice and counted twice. The threads and
+ * shard-vectors engines only run with more than one thread.
+ */
+
+#include "fmodel.h"
+#include "vector_file.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Writes a KiCad netlist of 74xx gates, allocating gate slots IC by IC
+ */
+class SyntheticNetlist {
+public:
+    enum Part { XOR, AND, OR, DFF, NUM_PARTS };
+
+    void input(const std::string& name) { node(name, "JIN_" + name, 1); }
+    void output(const std::string& name) { node(name, "JOUT_" + name, 1); }
+
+    // out = in_a <op> in_b
+    void gate(Part part, const std::string& in_a, const std::string& in_b, const std::string& out) {
+        static const int QUAD_PINS[4][3] = {{1, 2, 3}, {4, 5, 6}, {9, 10, 8}, {12, 13, 11}};
+        const int slot = allocate(part, 4);
+        node(in_a, ic[part], QUAD_PINS[slot][0]);
+        node(in_b, ic[part], QUAD_PINS[slot][1]);
+        node(out, ic[part], QUAD_PINS[slot][2]);
+    }
+
+    // q samples d on the rising edge of clk; PRE/CLR are left open
+    void flipFlop(const std::string& d, const std::string& clk, const std::string& q) {
+        static const int DFF_PINS[2][3] = {{2, 3, 5}, {12, 11, 9}};
+        const int slot = allocate(DFF, 2);
+        node(d, ic[DFF], DFF_PINS[slot][0]);
+        node(clk, ic[DFF], DFF_PINS[slot][1]);
+        node(q, ic[DFF], DFF_PINS[slot][2]);
+    }
+
+    bool write(const std::string& path, const std::string& design) const {
+        std::ofstream file(path);
+        file << "(export (version D)\n  (design (source \"" << design << "\") (tool \"fmodel_bench\"))\n  (components\n";
+        for (const auto& comp : components) {
+            file << "    (comp (ref " << comp.first << ") (value " << comp.second << "))\n";
+        }
+        file << "  )\n  (nets\n";
+        for (size_t n = 0; n < nets.size(); ++n) {
+            file << "    (net (code " << n + 1 << ") (name \"" << nets[n].first << "\")\n";
+            for (const auto& pin : nets[n].second) {
+                file << "      (node (ref " << pin.first << ") (pin " << pin.second << "))\n";
+            }
+            file << "    )\n";
+        }
+        file << "  )\n)\n";
+        return static_cast<bool>(file);
+    }
+
+private:
+    int allocate(Part part, int slots) {
+        static const char* const PART_NUMBERS[NUM_PARTS] = {"74HC86", "74HC08", "74HC32", "74HC74"};
+        if (used[part] == 0 || used[part] == slots) {
+            ic[part] = "U" + std::to_string(components.size() + 1);
+            components.emplace_back(ic[part], PART_NUMBERS[part]);
+            node("VCC", ic[part], 14);
+            node("GND", ic[part], 7);
+            used[part] = 0;
+        }
+        return used[part]++;
+    }
+
+    void node(const std::string& net, const std::string& ref, int pin) {
+        auto it = net_index.find(net);
+        if (it == net_index.end()) {
+            it = net_index.emplace(net, nets.size()).first;
+            nets.emplace_back(net, std::vector<std::pair<std::string, int>>());
+        }
+        nets[it->second].second.emplace_back(ref, pin);
+    }
+
+    std::vector<std::pair<std::string, std::string>> components;
+    std::vector<std::pair<std::string, std::vector<std::pair<std::string, int>>>> nets;
+    std::unordered_map<std::string, size_t> net_index;
+    std::string ic[NUM_PARTS];
+    int used[NUM_PARTS] = {};
+};
+
+// stages chained 4-bit ripple-carry adders: a/b/cin in, sum/cout out
+void buildAdderChain(SyntheticNetlist& netlist, int stages) {
+    const int bits = 4 * stages;
+    netlist.input("cin");
+    std::string carry = "cin";
+    for (int i = 0; i < bits; ++i) {
+        const std::string bit = std::to_string(i);
+        const std::string a = "a_" + bit, b = "b_" + bit, sum = "sum_" + bit;
+        const std::string next = i + 1 == bits ? "cout" : "c_" + std::to_string(i + 1);
+        netlist.input(a);
+        netlist.input(b);
+        netlist.output(sum);
+        netlist.gate(SyntheticNetlist::XOR, a, b, "p_" + bit);
+        netlist.gate(SyntheticNetlist::XOR, "p_" + bit, carry, sum);
+        netlist.gate(SyntheticNetlist::AND, a, b, "g_" + bit);
+        netlist.gate(SyntheticNetlist::AND, "p_" + bit, carry, "t_" + bit);
+        netlist.gate(SyntheticNetlist::OR, "g_" + bit, "t_" + bit, next);
+        carry = next;
+    }
+    netlist.output("cout");
+}
+
+// width parallel shift registers of depth stages on one clock: d in, q out
+void buildShiftRegister(SyntheticNetlist& netlist, int width, int depth) {
+    netlist.input("clk");
+    for (int w = 0; w < width; ++w) {
+        const std::string lane = std::to_string(w);
+        std::string from = "d_" + lane;
+        netlist.input(from);
+        for (int s = 0; s < depth; ++s) {
+            const std::string to = s + 1 == depth ? "q_" + lane : "s" + std::to_string(s) + "_" + lane;
+            netlist.flipFlop(from, "clk", to);
+            from = to;
+        }
+        netlist.output("q_" + lane);
+    }
+}
+
+struct Design {
+    std::string name;
+    std::string netlist;   // path; written by build when it is set
+    std::string clock;     // net the cycle engine pulses, empty if none
+    void (*build)(SyntheticNetlist&, int) = nullptr;
+    int size = 0;
+};
+
+struct Options {
+    std::string netlist_dir = "../netlist/generated";
+    std::string only;
+    uint64_t vectors = 1024;
+    uint64_t kernel_vectors = 1 << 20;
+    uint64_t seed = 1;
+    int threads = 0;
+};
+
+const char* const ENGINES[] = {"event-driven", "levelized", "bit-parallel", "threads", "shard-vectors", "cycle"};
+
+// Random levels on every input except skip (the clock the engine pulses)
+bool writeVectors(const std::string& path, const std::vector<std::string>& inputs, const std::string& skip,
+                  const Options& options) {
+    std::vector<std::string> columns;
+    for (const std::string& name : inputs) {
+        if (name != skip) columns.push_back(name);
+    }
+    ::FModel::VectorFileWriter writer;
+    if (!writer.open(path, columns, {})) return false;
+    std::mt19937_64 random(options.seed);
+    ::FModel::TestVector vector;
+    for (uint64_t v = 0; v < options.vectors; ++v) {
+        uint64_t bits = 0;
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (c % 64 == 0) bits = random();
+            vector.inputs[columns[c]] = (bits >> (c % 64)) & 1 ? ::FModel::LogicLevel::HIGH : ::FModel::LogicLevel::LOW;
+        }
+        if (!writer.write(vector)) return false;
+    }
+    return writer.close();
+}
+
+// Decodes a whole packed vector file into model, replacing its vectors
+bool loadDecodedVectors(::FModel::FModel& model, const std::string& path) {
+    ::FModel::VectorFileReader reader;
+    if (!reader.open(path)) return false;
+    std::vector<::FModel::TestVector> batch;
+    reader.readBatch(batch, reader.size());
+    if (reader.error()) return false;
+    model.clearTestVectors();
+    for (::FModel::TestVector& vector : batch) model.addTestVector(std::move(vector));
+    return true;
+}
+
+// Sets up model for engine; false if the engine does not apply to it
+bool selectEngine(::FModel::FModel& model, const std::string& engine, const Design& design, const Options& options) {
+    const bool sequential = model.isSequential();
+    const bool threaded = engine == "threads" || engine == "shard-vectors";
+    model.setPropagationMode(engine == "event-driven" ? ::FModel::PropagationMode::EVENT_DRIVEN
+                                                      : ::FModel::PropagationMode::LEVELIZED);
+    model.setBitParallel(engine == "bit-parallel");
+    model.setThreads(threaded ? options.threads : 1);
+    model.setVectorSharding(engine == "shard-vectors");
+    model.clearClocks();
+    if (threaded && model.getThreads() == 1) return false;
+    if (engine == "cycle") {
+        if (!sequential || design.clock.empty()) return false;
+        model.addClock(design.clock);
+    }
+    return !sequential || (engine != "bit-parallel" && engine != "shard-vectors");
+}
+
+void printField(std::ostream& out, const char* key, double value) {
+    out << ", \"" << key << "\": " << std::fixed << std::setprecision(value < 100 ? 3 : 0) << value;
+}
+
+// Child process: every engine on one design
+int benchDesign(const Design& design, const std::string& dir, const Options& options) {
+    std::string netlist = design.netlist;
+    if (design.build) {
+        SyntheticNetlist synthetic;
+        design.build(synthetic, design.size);
+        netlist = dir + "/" + design.name + ".net";
+        if (!synthetic.write(netlist, design.name)) {
+            std::cerr << design.name << ": cannot write " << netlist << std::endl;
+            return 1;
+        }
+    }
+
+    ::FModel::FModel model;
+    model.setReportLevel(::FModel::ReportLevel::SILENT);
+    Clock::time_point start = Clock::now();
+    if (!model.loadFromNetlist(netlist)) {
+        std::cerr << design.name << ": failed to load " << netlist << std::endl;
+        return 1;
+    }
+    const double load_ms = millisecondsSince(start);
+    start = Clock::now();
+    if (!model.compile()) return 1;
+    const double compile_ms = millisecondsSince(start);
+
+    const std::vector<std::string> inputs = model.getInputNames();
+    const bool has_clock = !design.clock.empty();
+    const std::string driven_path = dir + "/" + design.name + ".fmv";
+    const std::string cycle_path = dir + "/" + design.name + "_cycles.fmv";
+    if (!writeVectors(driven_path, inputs, "", options) ||
+        (has_clock && !writeVectors(cycle_path, inputs, design.clock, options))) {
+        std::cerr << design.name << ": cannot write test vectors to " << dir << std::endl;
+        return 1;
+    }
+
+    int failed = 0;
+    std::vector<std::string> lines;
+    for (const std::string engine : ENGINES) {
+        if (!selectEngine(model, engine, design, options)) continue;
+        const std::string& vectors_path = engine == "cycle" ? cycle_path : driven_path;
+        if (!model.loadTestVectors(vectors_path)) return 1;
+        start = Clock::now();
+        if (!model.simulate()) {
+            std::cerr << design.name << ": " << engine << " simulation failed" << std::endl;
+            failed = 1;
+            continue;
+        }
+        const double sim_ms = millisecondsSince(start);
+        const double seconds = sim_ms / 1000.0;
+
+        if (!loadDecodedVectors(model, vectors_path)) {
+            std::cerr << design.name << ": cannot decode " << vectors_path << std::endl;
+            return 1;
+        }
+        start = Clock::now();
+        const bool engine_passed = model.simulate();
+        const double engine_ms = millisecondsSince(start);
+        const double engine_seconds = engine_ms / 1000.0;
+        model.clearTestVectors();
+        if (!engine_passed) {
+            std::cerr << design.name << ": " << engine << " in-memory simulation failed" << std::endl;
+            failed = 1;
+            continue;
+        }
+
+        double kernel_ms = 0;
+        if (engine == "bit-parallel") {
+            ::FModel::StimulusOptions stimulus;
+            stimulus.mode = ::FModel::StimulusMode::RANDOM;
+            stimulus.count = options.kernel_vectors;
+            stimulus.seed = options.seed;
+            ::FModel::StimulusReport report;
+            start = Clock::now();
+            if (!model.checkStimulus(stimulus, model, report)) {
+                std::cerr << design.name << ": bit-parallel kernel check failed" << std::endl;
+                failed = 1;
+                continue;
+            }
+            kernel_ms = millisecondsSince(start);
+        }
+        std::ostringstream line;
+        line << "{\"design\": \"" << design.name << "\", \"engine\": \"" << engine << "\""
+             << ", \"components\": " << model.getComponentCount() << ", \"nets\": " << model.getSignalCount()
+             << ", \"gates\": " << model.getGateCount() << ", \"threads\": " << model.getThreads()
+             << ", \"vectors\": " << options.vectors;
+        printField(line, "load_ms", load_ms);
+        printField(line, "compile_ms", compile_ms);
+        printField(line, "sim_ms", sim_ms);
+        printField(line, "vectors_per_sec", options.vectors / seconds);
+        printField(line, "gate_evals_per_sec", options.vectors * static_cast<double>(model.getGateCount()) / seconds);
+        printField(line, "engine_ms", engine_ms);
+        printField(line, "engine_vectors_per_sec", options.vectors / engine_seconds);
+        printField(line, "engine_gate_evals_per_sec", options.vectors * static_cast<double>(model.getGateCount()) / engine_seconds);
+        if (engine == "bit-parallel") {
+            line << ", \"kernel_vectors\": " << options.kernel_vectors;
+            printField(line, "kernel_ms", kernel_ms);
+            printField(line, "kernel_gate_evals_per_sec",
+                       2 * options.kernel_vectors * static_cast<double>(model.getGateCount()) / (kernel_ms / 1000.0));
+        }
+        lines.push_back(line.str());
+    }
+    std::remove(driven_path.c_str());
+    if (has_clock) std::remove(cycle_path.c_str());
+    if (design.build) std::remove(netlist.c_str());
+
+    // The high-water mark covers the whole design, so it goes on every line
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    for (const std::string& line : lines) std::cout << line << ", \"peak_rss_kb\": " << usage.ru_maxrss << "}\n";
+    std::cout.flush();
+    return failed;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --netlists=DIR   Directory of the generated sample netlists (default ../netlist/generated)" << std::endl;
+    std::cout << "  --only=TEXT      Only run designs whose name contains TEXT" << std::endl;
+    std::cout << "  --vectors=N      Random vectors per engine (default 1024)" << std::endl;
+    std::cout << "  --kernel-vectors=N" << std::endl;
+    std::cout << "                   Random patterns for the bit-parallel kernel alone (default 1048576)" << std::endl;
+    std::cout << "  --seed=S         Seed for the random vectors (default 1)" << std::endl;
+    std::cout << "  --threads=N      Threads for the threads and shard-vectors engines (0 = one per core, default)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        try {
+            if (option.rfind("--netlists=", 0) == 0 && option.size() > 11) {
+                options.netlist_dir = option.substr(11);
+            } else if (option.rfind("--only=", 0) == 0) {
+                options.only = option.substr(7);
+            } else if (option.rfind("--vectors=", 0) == 0) {
+                options.vectors = std::stoull(option.substr(10));
+            } else if (option.rfind("--kernel-vectors=", 0) == 0) {
+                options.kernel_vectors = std::stoull(option.substr(17));
+            } else if (option.rfind("--seed=", 0) == 0) {
+                options.seed = std::stoull(option.substr(7));
+            } else if (option.rfind("--threads=", 0) == 0) {
+                options.threads = std::stoi(option.substr(10));
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value in " << option << std::endl;
+            return 1;
+        }
+    }
+    if (options.vectors == 0 || options.kernel_vectors == 0 || options.threads < 0) {
+        std::cerr << "--vectors and --kernel-vectors must be positive and --threads at least 0" << std::endl;
+        return 1;
+    }
+
+    // unit_dffe_top's flip-flops are clocked by GND_UNUSED, so only the
+    // vector engines apply to it
+    std::vector<Design> designs;
+    for (const char* sample : {"adder_4bit", "mux2"}) {
+        designs.push_back(Design{sample, options.netlist_dir + "/" + sample + ".net", ""});
+    }
+    for (const char* sample : {"shift2", "dff_top"}) {
+        designs.push_back(Design{sample, options.netlist_dir + "/" + sample + ".net", "clk"});
+    }
+    designs.push_back(Design{"unit_dffe_top", options.netlist_dir + "/unit_dffe_top.net", ""});
+    for (int stages : {16, 256, 1024}) {
+        designs.push_back(Design{"adder_chain_" + std::to_string(stages), "", "", buildAdderChain, stages});
+    }
+    for (int width : {64, 512}) {
+        designs.push_back(Design{"shift_register_" + std::to_string(width) + "x8", "", "clk",
+                                 [](SyntheticNetlist& netlist, int w) { buildShiftRegister(netlist, w, 8); }, width});
+    }
+
+    char dir_template[] = "/tmp/fmodel_bench.XXXXXX";
+    const char* dir = mkdtemp(dir_template);
+    if (!dir) {
+        std::cerr << "Cannot create a scratch directory in /tmp" << std::endl;
+        return 1;
+    }
+
+    int failed = 0;
+    for (const Design& design : designs) {
+        if (design.name.find(options.only) == std::string::npos) continue;
+        std::cout.flush();
+        const pid_t child = fork();
+        if (child < 0) {
+            std::cerr << "fork failed" << std::endl;
+            failed++;
+            break;
+        }
+        if (child == 0) _exit(benchDesign(design, dir, options));
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << design.name << ": benchmark failed" << std::endl;
+            failed++;
+        }
+    }
+    rmdir(dir);
+    return failed ? 1 : 0;
+}
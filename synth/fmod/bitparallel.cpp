@@ -0,0 +1,126 @@
+/**
+ * @file bitparallel.cpp
+ * @brief Bit-parallel gate kernels (portable 64-bit, AVX2 and AVX-512)
+ */
+
+#include "bitparallel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FMODEL_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace FModel {
+
+void evaluatePackedGates(const PackedGate* gates, size_t count, uint64_t* value, uint64_t* z) {
+    for (size_t i = 0; i < count; ++i) {
+        const PackedGate& g = gates[i];
+        const uint64_t a = value[g.in_a];
+        const uint64_t b = value[g.in_b];
+        const uint64_t rz = z[g.in_a] | z[g.in_b];
+        uint64_t r;
+        switch (g.op) {
+            case GateOp::AND:  r = a & b; break;
+            case GateOp::OR:   r = a | b; break;
+            case GateOp::NAND: r = ~(a & b); break;
+            case GateOp::NOR:  r = ~(a | b); break;
+            case GateOp::XOR:  r = a ^ b; break;
+            case GateOp::NOT:  r = ~a; break;
+            default:           r = 0; break;
+        }
+        value[g.out] = (value[g.out] & rz) | (r & ~rz);
+        z[g.out] &= rz;
+    }
+}
+
+#ifdef FMODEL_X86_SIMD
+
+namespace {
+
+__attribute__((target("avx2")))
+void evaluatePackedGatesAVX2(const PackedGate* gates, size_t count, uint64_t* value, uint64_t* z) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    for (size_t i = 0; i < count; ++i) {
+        const PackedGate& g = gates[i];
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(value + 4 * g.in_a));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(value + 4 * g.in_b));
+        const __m256i rz = _mm256_or_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(z + 4 * g.in_a)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(z + 4 * g.in_b)));
+        __m256i r;
+        switch (g.op) {
+            case GateOp::AND:  r = _mm256_and_si256(a, b); break;
+            case GateOp::OR:   r = _mm256_or_si256(a, b); break;
+            case GateOp::NAND: r = _mm256_xor_si256(_mm256_and_si256(a, b), ones); break;
+            case GateOp::NOR:  r = _mm256_xor_si256(_mm256_or_si256(a, b), ones); break;
+            case GateOp::XOR:  r = _mm256_xor_si256(a, b); break;
+            case GateOp::NOT:  r = _mm256_xor_si256(a, ones); break;
+            default:           r = _mm256_setzero_si256(); break;
+        }
+        __m256i* out_value = reinterpret_cast<__m256i*>(value + 4 * g.out);
+        __m256i* out_z = reinterpret_cast<__m256i*>(z + 4 * g.out);
+        const __m256i old_value = _mm256_loadu_si256(out_value);
+        _mm256_storeu_si256(out_value, _mm256_or_si256(_mm256_and_si256(old_value, rz), _mm256_andnot_si256(rz, r)));
+        _mm256_storeu_si256(out_z, _mm256_and_si256(_mm256_loadu_si256(out_z), rz));
+    }
+}
+
+__attribute__((target("avx512f")))
+void evaluatePackedGatesAVX512(const PackedGate* gates, size_t count, uint64_t* value, uint64_t* z) {
+    const __m512i ones = _mm512_set1_epi64(-1);
+    for (size_t i = 0; i < count; ++i) {
+        const PackedGate& g = gates[i];
+        const __m512i a = _mm512_loadu_si512(value + 8 * g.in_a);
+        const __m512i b = _mm512_loadu_si512(value + 8 * g.in_b);
+        const __m512i rz = _mm512_or_si512(_mm512_loadu_si512(z + 8 * g.in_a), _mm512_loadu_si512(z + 8 * g.in_b));
+        __m512i r;
+        switch (g.op) {
+            case GateOp::AND:  r = _mm512_and_si512(a, b); break;
+            case GateOp::OR:   r = _mm512_or_si512(a, b); break;
+            case GateOp::NAND: r = _mm512_xor_si512(_mm512_and_si512(a, b), ones); break;
+            case GateOp::NOR:  r = _mm512_xor_si512(_mm512_or_si512(a, b), ones); break;
+            case GateOp::XOR:  r = _mm512_xor_si512(a, b); break;
+            case GateOp::NOT:  r = _mm512_xor_si512(a, ones); break;
+            default:           r = _mm512_setzero_si512(); break;
+        }
+        const __m512i old_value = _mm512_loadu_si512(value + 8 * g.out);
+        // rz ? old_value : r
+        _mm512_storeu_si512(value + 8 * g.out, _mm512_ternarylogic_epi64(rz, old_value, r, 0xCA));
+        _mm512_storeu_si512(z + 8 * g.out, _mm512_and_si512(_mm512_loadu_si512(z + 8 * g.out), rz));
+    }
+}
+
+} // namespace
+
+#endif // FMODEL_X86_SIMD
+
+bool packedBackendSupported(PackedBackend backend) {
+    switch (backend) {
+        case PackedBackend::AUTO:
+        case PackedBackend::SCALAR:
+            return true;
+#ifdef FMODEL_X86_SIMD
+        case PackedBackend::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case PackedBackend::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+PackedKernel selectPackedKernel(PackedBackend backend) {
+#ifdef FMODEL_X86_SIMD
+    if (backend == PackedBackend::AUTO || !packedBackendSupported(backend)) {
+        if (packedBackendSupported(PackedBackend::AVX512)) backend = PackedBackend::AVX512;
+        else if (packedBackendSupported(PackedBackend::AVX2)) backend = PackedBackend::AVX2;
+        else backend = PackedBackend::SCALAR;
+    }
+    if (backend == PackedBackend::AVX512) return {PackedBackend::AVX512, 8, "avx512", evaluatePackedGatesAVX512};
+    if (backend == PackedBackend::AVX2) return {PackedBackend::AVX2, 4, "avx2", evaluatePackedGatesAVX2};
+#endif
+    return {PackedBackend::SCALAR, 1, "scalar", evaluatePackedGates};
+}
+
+} // namespace FModel
@@ -0,0 +1,49 @@
+/**
+ * @file bitparallel.h
+ * @brief Bit-parallel gate evaluation over packed test vectors
+ *
+ * Each signal is held as two bit planes: `value` (bit i = level of vector i)
+ * and `z` (bit i set = vector i is FLOATING). Lanes in `z` always have a zero
+ * value bit. A kernel of width W stores W consecutive 64-bit words per signal,
+ * i.e. signal s occupies words [s * W, s * W + W).
+ */
+
+#ifndef BITPARALLEL_H
+#define BITPARALLEL_H
+
+#include "fmodel.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace FModel {
+
+/**
+ * @brief Packed gate kernel and the number of words per signal it works on
+ */
+struct PackedKernel {
+    PackedBackend backend;
+    int words;
+    const char* name;
+    void (*evaluate)(const PackedGate* gates, size_t count, uint64_t* value, uint64_t* z);
+};
+
+/**
+ * @brief Evaluate gates[0, count) of a levelized combinational schedule for
+ *        64 vectors at once
+ *
+ * Follows the scalar model: a gate output is Z whenever any input is Z, and
+ * Z outputs leave the driven net untouched.
+ */
+void evaluatePackedGates(const PackedGate* gates, size_t count, uint64_t* value, uint64_t* z);
+
+bool packedBackendSupported(PackedBackend backend);
+
+/**
+ * @brief Pick the kernel for a backend; AUTO or an unsupported backend
+ *        resolves to the widest one available on this CPU
+ */
+PackedKernel selectPackedKernel(PackedBackend backend = PackedBackend::AUTO);
+
+} // namespace FModel
+
+#endif // BITPARALLEL_H
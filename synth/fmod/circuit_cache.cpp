@@ -0,0 +1,393 @@
+/**
+ * @file circuit_cache.cpp
+ * @brief Binary cache of compiled circuits
+ *
+ * Layout (native byte order, no padding between fields):
+ *   header   magic, version, key, sizes of the raw record types
+ *   model    module name, signals (name, direction flags), component
+ *            instances (id, part, package, pin -> signal index)
+ *   circuit  every CompiledCircuit table as a count followed by raw records,
+ *            then its flags and power-rail indices
+ * Records are copied out of the mapped file with memcpy, so the file needs
+ * no alignment. Component pointers inside CompiledComponent are rebound on
+ * load.
+ */
+
+#include "circuit_cache.h"
+#include "fmodel.h"
+#include "profile.h"
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <unistd.h>
+
+namespace FModel {
+
+namespace {
+
+constexpr uint8_t SIGNAL_INPUT = 1;
+constexpr uint8_t SIGNAL_OUTPUT = 2;
+constexpr uint8_t SIGNAL_INTERNAL = 4;
+
+const uint32_t RECORD_SIZES[] = {
+    sizeof(CompiledComponent), sizeof(CompiledPin), sizeof(CompiledGate), sizeof(PackedGate), sizeof(GateRun),
+    sizeof(CompiledRegister)
+};
+
+class CacheWriter {
+public:
+    template<typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "cache records must be trivially copyable");
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putString(std::string_view str) {
+        put(static_cast<uint32_t>(str.size()));
+        out.append(str.data(), str.size());
+    }
+
+    template<typename T>
+    void putVector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "cache records must be trivially copyable");
+        put(static_cast<uint64_t>(values.size()));
+        out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    const std::string& data() const { return out; }
+
+private:
+    std::string out;
+};
+
+class CacheReader {
+public:
+    explicit CacheReader(std::string_view data) : data(data), pos(0) {}
+
+    template<typename T>
+    bool get(T& value) {
+        if (data.size() - pos < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string_view& str) {
+        uint32_t size = 0;
+        if (!get(size) || data.size() - pos < size) return false;
+        str = data.substr(pos, size);
+        pos += size;
+        return true;
+    }
+
+    template<typename T>
+    bool getVector(std::vector<T>& values) {
+        uint64_t count = 0;
+        if (!get(count) || count > (data.size() - pos) / sizeof(T)) return false;
+        values.resize(count);
+        std::memcpy(values.data(), data.data() + pos, count * sizeof(T));
+        pos += count * sizeof(T);
+        return true;
+    }
+
+    bool atEnd() const { return pos == data.size(); }
+
+private:
+    std::string_view data;
+    size_t pos;
+};
+
+// A record's indices must lie in the tables they index: a damaged file
+// with a valid header fails to load instead of indexing out of bounds
+class CircuitChecker {
+public:
+    CircuitChecker(const CompiledCircuit& cc, size_t signal_count, size_t instance_count)
+        : cc(cc), signals(static_cast<long>(signal_count)), instances(static_cast<long>(instance_count)) {}
+
+    bool valid() const {
+        for (const CompiledComponent& comp : cc.components) {
+            if (!index(comp.instance, instances) || !range(comp.inputs_begin, comp.inputs_end, cc.input_pins.size()) ||
+                !range(comp.outputs_begin, comp.outputs_end, cc.output_pins.size()) ||
+                !range(comp.gates_begin, comp.gates_end, cc.gates.size())) {
+                return false;
+            }
+        }
+        for (const std::vector<CompiledPin>* pins : {&cc.input_pins, &cc.output_pins, &cc.gate_input_pins}) {
+            for (const CompiledPin& pin : *pins) {
+                if (!index(pin.signal, signals)) return false;
+            }
+        }
+        if (!offsets(cc.fanout_offsets, cc.fanout_components.size(), true)) return false;
+        for (int comp : cc.fanout_components) {
+            if (!index(comp, cc.components.size())) return false;
+        }
+        for (const CompiledGate& gate : cc.gates) {
+            // Flip-flop halves have no combinational inputs
+            const bool dff = gate.op == GateOp::DFF;
+            if (gate.op > GateOp::DFF || !index(gate.component, cc.components.size()) ||
+                !range(gate.inputs_begin, gate.inputs_end, cc.gate_input_pins.size()) ||
+                !index(gate.output_signal, signals) || !(dff ? optional(gate.in_a) : index(gate.in_a, signals)) ||
+                !(dff ? optional(gate.in_b) : index(gate.in_b, signals))) {
+                return false;
+            }
+        }
+        for (int gate : cc.schedule) {
+            if (!index(gate, cc.gates.size())) return false;
+        }
+        if (!offsets(cc.level_offsets, cc.schedule.size(), false)) return false;
+        if (cc.dead_signals.size() != static_cast<size_t>(signals)) return false;
+        // The levelized program holds flip-flop halves unless it is bit-parallel
+        if (!packed(cc.packed_gates, true) || !runs(cc.gate_runs, cc.packed_gates.size(), true) ||
+            !runs(cc.parallel_runs, cc.packed_gates.size(), true) ||
+            !offsets(cc.parallel_level_offsets, cc.parallel_runs.size(), false)) {
+            return false;
+        }
+        for (const CompiledRegister& reg : cc.registers) {
+            if (!index(reg.gate, cc.gates.size()) || !optional(reg.d) || !optional(reg.clk) || !optional(reg.pre_n) ||
+                !optional(reg.clr_n) || !optional(reg.q)) {
+                return false;
+            }
+        }
+        return packed(cc.cycle_gates, false) && runs(cc.cycle_runs, cc.cycle_gates.size(), false) && optional(cc.vcc_signal) &&
+               optional(cc.gnd_signal);
+    }
+
+private:
+    static bool index(long value, size_t size) { return value >= 0 && static_cast<size_t>(value) < size; }
+    static bool index(long value, long size) { return value >= 0 && value < size; }
+    static bool range(long begin, long end, size_t size) {
+        return begin >= 0 && begin <= end && static_cast<size_t>(end) <= size;
+    }
+    // A signal index or -1 (unconnected)
+    bool optional(long signal) const { return signal == -1 || index(signal, signals); }
+
+    // Offsets non-decreasing from 0 within total: one per signal plus one,
+    // ending at total, when per_signal; else possibly none (not levelized)
+    bool offsets(const std::vector<int>& values, size_t total, bool per_signal) const {
+        if (values.empty()) return !per_signal;
+        if ((per_signal && values.size() != static_cast<size_t>(signals) + 1) || values.front() != 0) return false;
+        for (size_t i = 1; i < values.size(); ++i) {
+            if (values[i] < values[i - 1]) return false;
+        }
+        return per_signal ? static_cast<size_t>(values.back()) == total : static_cast<size_t>(values.back()) <= total;
+    }
+
+    bool packed(const std::vector<PackedGate>& program, bool with_dff) const {
+        for (const PackedGate& gate : program) {
+            const bool dff = gate.op == GateOp::DFF;
+            if (gate.op > (with_dff ? GateOp::DFF : GateOp::NOT) || !index(gate.out, signals) ||
+                !(dff ? optional(gate.in_a) : index(gate.in_a, signals)) ||
+                !(dff ? optional(gate.in_b) : index(gate.in_b, signals))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool runs(const std::vector<GateRun>& gate_runs, size_t size, bool with_dff) {
+        for (const GateRun& run : gate_runs) {
+            if (run.op > (with_dff ? GateOp::DFF : GateOp::NOT) || !range(run.begin, run.end, size)) return false;
+        }
+        return true;
+    }
+
+    const CompiledCircuit& cc;
+    long signals;
+    long instances;
+};
+
+} // namespace
+
+uint64_t hashBytes(std::string_view data, uint64_t seed) {
+    // Word-at-a-time multiply/xorshift mix; fast enough to key multi-MB
+    // netlists in a few milliseconds
+    const uint64_t mul = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = seed ^ (data.size() * mul);
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        h = (h ^ word) * mul;
+        h ^= h >> 29;
+    }
+    uint64_t tail = 0;
+    if (i < data.size()) std::memcpy(&tail, data.data() + i, data.size() - i);
+    h = (h ^ tail) * mul;
+    h ^= h >> 32;
+    return h;
+}
+
+std::string circuitCachePath(const std::string& dir, uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.fmc", static_cast<unsigned long long>(key));
+    return dir + "/" + name;
+}
+
+std::string FModel::serializeCircuit(uint64_t key) const {
+    FMODEL_PROFILE_SCOPE(profile.get(), CACHE);
+    CacheWriter out;
+    out.put(CIRCUIT_CACHE_MAGIC);
+    out.put(CIRCUIT_CACHE_VERSION);
+    out.put(key);
+    for (uint32_t size : RECORD_SIZES) out.put(size);
+
+    out.putString(module_name);
+    out.put(static_cast<uint32_t>(signals.size()));
+    for (const auto& signal : signals) {
+        out.putString(signal->name);
+        out.put(static_cast<uint8_t>((signal->is_input ? SIGNAL_INPUT : 0) | (signal->is_output ? SIGNAL_OUTPUT : 0) |
+                                     (signal->is_internal ? SIGNAL_INTERNAL : 0)));
+    }
+    out.put(static_cast<uint32_t>(components.size()));
+    for (const auto& instance : components) {
+        out.putString(instance->instance_id);
+        out.putString(instance->part_number);
+        out.putString(instance->package);
+        out.put(instance->pin_count);
+        for (const PinAssignment& pa : *instance) {
+            out.putString(pa.pin);
+            out.put(pa.signal);
+        }
+    }
+
+    const CompiledCircuit& cc = circuit;
+    out.putVector(cc.components);
+    out.putVector(cc.input_pins);
+    out.putVector(cc.output_pins);
+    out.putVector(cc.fanout_offsets);
+    out.putVector(cc.fanout_components);
+    out.putVector(cc.gates);
+    out.putVector(cc.gate_input_pins);
+    out.putVector(cc.schedule);
+    out.putVector(cc.level_offsets);
+    out.putVector(cc.dead_signals);
+    out.putVector(cc.packed_gates);
+    out.putVector(cc.gate_runs);
+    out.putVector(cc.parallel_runs);
+    out.putVector(cc.parallel_level_offsets);
+    out.putVector(cc.registers);
+    out.putVector(cc.cycle_gates);
+    out.putVector(cc.cycle_runs);
+    out.put(cc.multi_driven);
+    out.put(cc.sequential);
+    out.put(cc.levelized);
+    out.put(cc.bit_parallel);
+    out.put(cc.parallel);
+    out.put(cc.cycle_levelized);
+    out.put(cc.vcc_signal);
+    out.put(cc.gnd_signal);
+    return out.data();
+}
+
+bool FModel::writeCircuitCache(const std::string& path, uint64_t key) const {
+    const std::string data = serializeCircuit(key);
+
+    // Write a private temporary and rename it into place, so concurrent runs
+    // never map a half-written file
+    const std::string tmp = path + ".tmp." + std::to_string(::getpid());
+    FILE* file = std::fopen(tmp.c_str(), "wb");
+    if (!file) return false;
+    const bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    if (std::fclose(file) != 0 || !written || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool FModel::readCircuitCache(std::string_view data, uint64_t key) {
+    FMODEL_PROFILE_SCOPE(profile.get(), CACHE);
+    CacheReader in(data);
+    uint32_t magic = 0, version = 0;
+    uint64_t stored_key = 0;
+    if (!in.get(magic) || magic != CIRCUIT_CACHE_MAGIC) return false;
+    if (!in.get(version) || version != CIRCUIT_CACHE_VERSION) return false;
+    if (!in.get(stored_key) || stored_key != key) return false;
+    for (uint32_t size : RECORD_SIZES) {
+        uint32_t stored = 0;
+        if (!in.get(stored) || stored != size) return false;
+    }
+
+    auto fail = [this]() {
+        clearCircuit();
+        return false;
+    };
+
+    std::string_view text;
+    if (!in.getString(text)) return fail();
+    module_name = std::string(text);
+
+    uint32_t signal_count = 0;
+    if (!in.get(signal_count)) return fail();
+    signals.reserve(signal_count);
+    signal_names.reserve(signal_count);
+    for (uint32_t s = 0; s < signal_count; ++s) {
+        uint8_t flags = 0;
+        if (!in.getString(text) || !in.get(flags)) return fail();
+        // Names are unique, so each must intern to the next ID
+        const uint32_t id = signal_names.intern(text);
+        if (id != s) return fail();
+        Signal* signal = arena.create<Signal>(signal_names.view(id), static_cast<int>(id),
+                                              (flags & SIGNAL_INPUT) != 0, (flags & SIGNAL_OUTPUT) != 0);
+        signal->is_internal = (flags & SIGNAL_INTERNAL) != 0;
+        signals.push_back(signal);
+    }
+
+    uint32_t component_count = 0;
+    if (!in.get(component_count)) return fail();
+    components.reserve(component_count);
+    for (uint32_t c = 0; c < component_count; ++c) {
+        std::string_view id, part, package;
+        uint32_t pin_count = 0;
+        if (!in.getString(id) || !in.getString(part) || !in.getString(package) || !in.get(pin_count)) return fail();
+        ComponentInstance* instance = createInstance(id, part, package);
+        if (!instance) return fail();
+        // Pins were written in sorted order, so they can be appended as read
+        instance->pin_assignments = arena.allocateArray<PinAssignment>(pin_count);
+        instance->pin_capacity = pin_count;
+        for (uint32_t p = 0; p < pin_count; ++p) {
+            uint32_t signal = 0;
+            if (!in.getString(text) || !in.get(signal) || signal >= signal_count) return fail();
+            instance->pin_assignments[instance->pin_count++] = PinAssignment{arena.copy(text), signal};
+        }
+    }
+
+    CompiledCircuit cc;
+    if (!in.getVector(cc.components) || !in.getVector(cc.input_pins) || !in.getVector(cc.output_pins) ||
+        !in.getVector(cc.fanout_offsets) || !in.getVector(cc.fanout_components) || !in.getVector(cc.gates) ||
+        !in.getVector(cc.gate_input_pins) || !in.getVector(cc.schedule) || !in.getVector(cc.level_offsets) ||
+        !in.getVector(cc.dead_signals) || !in.getVector(cc.packed_gates) || !in.getVector(cc.gate_runs) ||
+        !in.getVector(cc.parallel_runs) || !in.getVector(cc.parallel_level_offsets) ||
+        !in.getVector(cc.registers) || !in.getVector(cc.cycle_gates) || !in.getVector(cc.cycle_runs) ||
+        !in.get(cc.multi_driven) || !in.get(cc.sequential) || !in.get(cc.levelized) ||
+        !in.get(cc.bit_parallel) || !in.get(cc.parallel) || !in.get(cc.cycle_levelized) ||
+        !in.get(cc.vcc_signal) || !in.get(cc.gnd_signal) ||
+        !in.atEnd()) {
+        return fail();
+    }
+    if (!CircuitChecker(cc, signal_count, components.size()).valid()) return fail();
+    for (CompiledComponent& comp : cc.components) comp.component = components[comp.instance]->component;
+
+    circuit = std::move(cc);
+    ThreadPool* pool = state.pool;
+    state = makeState();
+    state.pool = pool;
+    FMODEL_PROFILE_CALL(profile.get(), resize(signals.size(), circuit.components.size()));
+    compiled = true;
+    return true;
+}
+
+bool FModel::exportCircuit(std::string& image) const {
+    // A hierarchy shares module templates that an image cannot record
+    if (!simulation_ready || !compiled || !module_instances.empty()) return false;
+    image = serializeCircuit(0);
+    return true;
+}
+
+bool FModel::importCircuit(std::string_view image) {
+    if (!signals.empty() || !components.empty()) return false;
+    simulation_ready = readCircuitCache(image, 0);
+    return simulation_ready;
+}
+
+} // namespace FModel
@@ -0,0 +1,36 @@
+/**
+ * @file circuit_cache.h
+ * @brief Binary cache of compiled circuits, keyed by a hash of the netlist
+ *
+ * A cache file holds everything FModel::compile() produces plus the signal
+ * and component tables it was built from, so a later run can skip parsing
+ * and compiling. Files are only trusted when the magic, format version,
+ * record layout and key all match; anything else is treated as a miss.
+ */
+
+#ifndef CIRCUIT_CACHE_H
+#define CIRCUIT_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace FModel {
+
+static constexpr uint32_t CIRCUIT_CACHE_MAGIC = 0x43434D46;   // "FMCC"
+// Bump whenever the serialized layout or the meaning of a compiled field changes
+static constexpr uint32_t CIRCUIT_CACHE_VERSION = 2;
+
+/**
+ * @brief 64-bit non-cryptographic hash of a byte string
+ */
+uint64_t hashBytes(std::string_view data, uint64_t seed = 0);
+
+/**
+ * @brief Cache file for the netlist with the given key: <dir>/<key in hex>.fmc
+ */
+std::string circuitCachePath(const std::string& dir, uint64_t key);
+
+} // namespace FModel
+
+#endif // CIRCUIT_CACHE_H
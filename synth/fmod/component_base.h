@@ -16,9 +16,23 @@ public:
         FLOATING = -1
     };
 
+    // All supported parts are 14-pin DIPs; pins are numbered 1..NUM_PINS
+    static constexpr int NUM_PINS = 14;
+
     virtual ~Component() = default;
     virtual void setPin(int pin, LogicLevel level) = 0;
     virtual LogicLevel getPin(int pin) const = 0;
+
+    /**
+     * @brief Drive several pins in order, then evaluate
+     *
+     * Equivalent to calling setPin() for each pin in turn; parts override it
+     * to re-evaluate their outputs once instead of once per pin.
+     */
+    virtual void setPins(const int* pins, const LogicLevel* levels, int count) {
+        for (int i = 0; i < count; ++i) setPin(pins[i], levels[i]);
+    }
+
     virtual void setPower(bool on) = 0;
     virtual bool isPowerOn() const = 0;
     virtual double getPropagationDelay() const = 0;
@@ -3,7 +3,7 @@
 DualDFF_74HC74::DualDFF_74HC74()
     : powerOn(false), q1_state(Component::LOW), q2_state(Component::LOW),
       last_clk1(Component::LOW), last_clk2(Component::LOW) {
-    for (int pin = 1; pin <= 14; ++pin) pinStates[pin] = Component::FLOATING;
+    pinStates.fill(Component::FLOATING);
     setPin(VCC, Component::HIGH);
     setPin(GND, Component::LOW);
     // Default inactive async controls (active-low)
@@ -12,17 +12,31 @@ DualDFF_74HC74::DualDFF_74HC74()
     pinStates[CLR2_N] = Component::HIGH;
     pinStates[PRE2_N] = Component::HIGH;
     powerOn = true;
+    // Drive Q/Q_N from the initial state and latch the (floating) clocks, so
+    // a floating clock is not mistaken for a LOW level on the first edge
+    updateOutputs();
 }
 
 void DualDFF_74HC74::setPin(int pin, Component::LogicLevel level) {
+    if (pin < 1 || pin > NUM_PINS) return;
     pinStates[pin] = level;
     updateOutputs();
 }
 
 Component::LogicLevel DualDFF_74HC74::getPin(int pin) const {
-    auto it = pinStates.find(pin);
-    if (it != pinStates.end()) return it->second;
-    return Component::FLOATING;
+    if (pin < 1 || pin > NUM_PINS) return Component::FLOATING;
+    return static_cast<Component::LogicLevel>(pinStates[pin]);
+}
+
+void DualDFF_74HC74::setPins(const int* pins, const Component::LogicLevel* levels, int count) {
+    // Same result as setPin() per pin: edges and async controls only act when
+    // a clock/control pin is written, so D writes are batched into one update.
+    for (int i = 0; i < count; ++i) {
+        if (pins[i] < 1 || pins[i] > NUM_PINS) continue;
+        pinStates[pins[i]] = levels[i];
+        if (isControlPin(pins[i])) updateOutputs();
+    }
+    updateOutputs();
 }
 
 void DualDFF_74HC74::setPower(bool on) {
@@ -47,6 +61,11 @@ bool DualDFF_74HC74::isInputPin(int pin) const {
            pin == D2 || pin == CLK2 || pin == PRE2_N || pin == CLR2_N;
 }
 
+bool DualDFF_74HC74::isControlPin(int pin) const {
+    return pin == CLK1 || pin == PRE1_N || pin == CLR1_N || pin == VCC ||
+           pin == CLK2 || pin == PRE2_N || pin == CLR2_N || pin == GND;
+}
+
 bool DualDFF_74HC74::isAsyncPinActive(Component::LogicLevel pre_n, Component::LogicLevel clr_n) const {
     return (pre_n == Component::LOW) || (clr_n == Component::LOW);
 }
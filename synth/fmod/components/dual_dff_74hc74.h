@@ -7,8 +7,8 @@
 #define DUAL_DFF_74HC74_H
 
 #include "../component_base.h"
-#include <map>
-#include <vector>
+#include <array>
+#include <cstdint>
 
 class DualDFF_74HC74 : public Component {
 public:
@@ -23,12 +23,13 @@ public:
 
     void setPin(int pin, LogicLevel level) override;
     LogicLevel getPin(int pin) const override;
+    void setPins(const int* pins, const LogicLevel* levels, int count) override;
     void setPower(bool on) override;
     bool isPowerOn() const override;
     double getPropagationDelay() const override;
 
 private:
-    std::map<int, LogicLevel> pinStates;
+    std::array<int8_t, NUM_PINS + 1> pinStates;  // indexed by pin number, [0] unused
     bool powerOn;
     static constexpr double PROPAGATION_DELAY_NS = 15.0;
 
@@ -40,6 +41,7 @@ private:
     LogicLevel last_clk2;
 
     bool isInputPin(int pin) const;
+    bool isControlPin(int pin) const;
     bool isAsyncPinActive(LogicLevel pre_n, LogicLevel clr_n) const;
     void updateOutputs();
 };
@@ -1,23 +1,14 @@
 #include "quad_not_74hc04.h"
 
 HexInverter_74HC04::HexInverter_74HC04() : powerOn(false) {
-    for (int pin = 1; pin <= 14; pin++) {
-        pinStates[pin] = Component::FLOATING;
-    }
-    gates = {
-        {GATE1_A, GATE1_Y},
-        {GATE2_A, GATE2_Y},
-        {GATE3_A, GATE3_Y},
-        {GATE4_A, GATE4_Y},
-        {GATE5_A, GATE5_Y},
-        {GATE6_A, GATE6_Y}
-    };
+    pinStates.fill(Component::FLOATING);
     setPin(VCC, Component::HIGH);
     setPin(GND, Component::LOW);
     powerOn = true;
 }
 
 void HexInverter_74HC04::setPin(int pin, Component::LogicLevel level) {
+    if (pin < 1 || pin > NUM_PINS) return;
     pinStates[pin] = level;
     if (isInputPin(pin)) {
         updateOutputs();
@@ -25,9 +16,20 @@ void HexInverter_74HC04::setPin(int pin, Component::LogicLevel level) {
 }
 
 Component::LogicLevel HexInverter_74HC04::getPin(int pin) const {
-    auto it = pinStates.find(pin);
-    if (it != pinStates.end()) return it->second;
-    return Component::FLOATING;
+    if (pin < 1 || pin > NUM_PINS) return Component::FLOATING;
+    return static_cast<Component::LogicLevel>(pinStates[pin]);
+}
+
+void HexInverter_74HC04::setPins(const int* pins, const Component::LogicLevel* levels, int count) {
+    bool inputsChanged = false;
+    for (int i = 0; i < count; ++i) {
+        if (pins[i] < 1 || pins[i] > NUM_PINS) continue;
+        pinStates[pins[i]] = levels[i];
+        inputsChanged = inputsChanged || isInputPin(pins[i]);
+    }
+    if (inputsChanged) {
+        updateOutputs();
+    }
 }
 
 void HexInverter_74HC04::setPower(bool on) {
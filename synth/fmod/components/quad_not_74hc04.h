@@ -2,9 +2,8 @@
 #define QUAD_NOT_74HC04_H
 
 #include "../component_base.h"
-#include <map>
-#include <string>
-#include <vector>
+#include <array>
+#include <cstdint>
 
 class HexInverter_74HC04 : public Component {
 public:
@@ -23,6 +22,7 @@ public:
 
     void setPin(int pin, LogicLevel level) override;
     LogicLevel getPin(int pin) const override;
+    void setPins(const int* pins, const LogicLevel* levels, int count) override;
     void setPower(bool on) override;
     bool isPowerOn() const override;
     double getPropagationDelay() const override;
@@ -31,12 +31,19 @@ public:
     LogicLevel getGateOutput(int gateNumber) const;
 
 private:
-    std::map<int, LogicLevel> pinStates;
+    std::array<int8_t, NUM_PINS + 1> pinStates;  // indexed by pin number, [0] unused
     bool powerOn;
     static constexpr double PROPAGATION_DELAY_NS = 8.0;
 
     struct Gate { int inputA, output; };
-    std::vector<Gate> gates;
+    static constexpr Gate gates[6] = {
+        {GATE1_A, GATE1_Y},
+        {GATE2_A, GATE2_Y},
+        {GATE3_A, GATE3_Y},
+        {GATE4_A, GATE4_Y},
+        {GATE5_A, GATE5_Y},
+        {GATE6_A, GATE6_Y}
+    };
 
     bool isInputPin(int pin) const;
     void updateOutputs();
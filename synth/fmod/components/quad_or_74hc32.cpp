@@ -5,21 +5,14 @@
 #include "quad_or_74hc32.h"
 
 QuadOR_74HC32::QuadOR_74HC32() : powerOn(false) {
-    for (int pin = 1; pin <= 14; pin++) {
-        pinStates[pin] = Component::FLOATING;
-    }
-    gates = {
-        {GATE1_A, GATE1_B, GATE1_Y, "Gate 1"},
-        {GATE2_A, GATE2_B, GATE2_Y, "Gate 2"},
-        {GATE3_A, GATE3_B, GATE3_Y, "Gate 3"},
-        {GATE4_A, GATE4_B, GATE4_Y, "Gate 4"}
-    };
+    pinStates.fill(Component::FLOATING);
     setPin(VCC, Component::HIGH);
     setPin(GND, Component::LOW);
     powerOn = true;
 }
 
 void QuadOR_74HC32::setPin(int pin, Component::LogicLevel level) {
+    if (pin < 1 || pin > NUM_PINS) return;
     pinStates[pin] = level;
     if (isInputPin(pin)) {
         updateOutputs();
@@ -27,7 +20,20 @@ void QuadOR_74HC32::setPin(int pin, Component::LogicLevel level) {
 }
 
 Component::LogicLevel QuadOR_74HC32::getPin(int pin) const {
-    return pinStates.at(pin);
+    if (pin < 1 || pin > NUM_PINS) return Component::FLOATING;
+    return static_cast<Component::LogicLevel>(pinStates[pin]);
+}
+
+void QuadOR_74HC32::setPins(const int* pins, const Component::LogicLevel* levels, int count) {
+    bool inputsChanged = false;
+    for (int i = 0; i < count; ++i) {
+        if (pins[i] < 1 || pins[i] > NUM_PINS) continue;
+        pinStates[pins[i]] = levels[i];
+        inputsChanged = inputsChanged || isInputPin(pins[i]);
+    }
+    if (inputsChanged) {
+        updateOutputs();
+    }
 }
 
 void QuadOR_74HC32::setGateInputs(int gateNumber, Component::LogicLevel inputA, Component::LogicLevel inputB) {
@@ -7,9 +7,8 @@
 #define QUAD_OR_74HC32_H
 
 #include "../component_base.h"
-#include <map>
-#include <string>
-#include <vector>
+#include <array>
+#include <cstdint>
 
 class QuadOR_74HC32 : public Component {
 public:
@@ -23,6 +22,7 @@ public:
     QuadOR_74HC32();
     void setPin(int pin, LogicLevel level) override;
     LogicLevel getPin(int pin) const override;
+    void setPins(const int* pins, const LogicLevel* levels, int count) override;
     void setPower(bool on) override;
     bool isPowerOn() const override;
     double getPropagationDelay() const override;
@@ -31,15 +31,20 @@ public:
     LogicLevel getGateOutput(int gateNumber) const;
 
 private:
-    std::map<int, LogicLevel> pinStates;
+    std::array<int8_t, NUM_PINS + 1> pinStates;  // indexed by pin number, [0] unused
     bool powerOn;
     static constexpr double PROPAGATION_DELAY_NS = 8.0;
 
     struct Gate {
         int inputA, inputB, output;
-        std::string name;
+        const char* name;
+    };
+    static constexpr Gate gates[4] = {
+        {GATE1_A, GATE1_B, GATE1_Y, "Gate 1"},
+        {GATE2_A, GATE2_B, GATE2_Y, "Gate 2"},
+        {GATE3_A, GATE3_B, GATE3_Y, "Gate 3"},
+        {GATE4_A, GATE4_B, GATE4_Y, "Gate 4"}
     };
-    std::vector<Gate> gates;
 
     bool isInputPin(int pin) const;
     void updateOutputs();
@@ -0,0 +1,215 @@
+/**
+ * @file fault.cpp
+ * @brief Single stuck-at fault simulation of the loaded test vectors
+ *
+ * Every net except the power rails carries a stuck-at-0 and a stuck-at-1
+ * fault. Each vector runs the packed combinational program once per group
+ * of 63 remaining faults: lane 0 of every word is the fault-free machine and
+ * lane k forces the net of the group's k-th fault, after its driver writes
+ * it (or, for an undriven net such as a primary input, before the pass).
+ * A fault is detected when an output the vector checks is LOW or HIGH in
+ * lane 0 and anything else in the fault's lane, i.e. when the vector would
+ * fail on the faulty board. Detected faults are dropped, so the remaining
+ * vectors only simulate the faults still undetected.
+ *
+ * A net the schedule treats as permanently Z (e.g. one only driven by gates
+ * tied to GND_UNUSED) has no live readers, so its faults are undetectable.
+ */
+
+#include "fmodel.h"
+#include "profile.h"
+#include "vector_file.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace FModel {
+
+namespace {
+
+constexpr int FAULTS_PER_PASS = 63;   // lane 0 is the fault-free machine
+
+// evaluatePackedGates() with each written net forced to its stuck lanes
+void evaluateFaultyGates(const std::vector<PackedGate>& gates, uint64_t* value, uint64_t* z,
+                         const uint64_t* stuck_low, const uint64_t* stuck_high) {
+    for (const PackedGate& g : gates) {
+        const uint64_t a = value[g.in_a];
+        const uint64_t b = value[g.in_b];
+        const uint64_t rz = z[g.in_a] | z[g.in_b];
+        uint64_t r;
+        switch (g.op) {
+            case GateOp::AND:  r = a & b; break;
+            case GateOp::OR:   r = a | b; break;
+            case GateOp::NAND: r = ~(a & b); break;
+            case GateOp::NOR:  r = ~(a | b); break;
+            case GateOp::XOR:  r = a ^ b; break;
+            case GateOp::NOT:  r = ~a; break;
+            default:           r = 0; break;
+        }
+        const uint64_t forced = stuck_low[g.out] | stuck_high[g.out];
+        value[g.out] = (((value[g.out] & rz) | (r & ~rz)) & ~forced) | stuck_high[g.out];
+        z[g.out] &= rz & ~forced;
+    }
+}
+
+} // namespace
+
+bool FModel::simulateFaults(FaultReport& report) {
+    report = FaultReport();
+    if (!simulation_ready || (!compiled && !compile()) || !flattenFor("Fault simulation") || !unoptimize()) {
+        std::cerr << "Circuit not ready for simulation!" << std::endl;
+        return false;
+    }
+    if (!circuit.bit_parallel) {
+        std::cerr << "Fault simulation needs a levelized combinational circuit" << std::endl;
+        return false;
+    }
+
+    const size_t num_signals = signals.size();
+    std::vector<int> fault_nets;
+    for (const Signal* signal : signals) {
+        if (signal->index == circuit.vcc_signal || signal->index == circuit.gnd_signal) continue;
+        for (LogicLevel stuck_at : {LogicLevel::LOW, LogicLevel::HIGH}) {
+            report.faults.push_back(FaultReport::Fault{signal->getName(), stuck_at, 0});
+            fault_nets.push_back(signal->index);
+        }
+    }
+    std::vector<int> remaining(report.faults.size());
+    for (size_t f = 0; f < remaining.size(); ++f) remaining[f] = static_cast<int>(f);
+
+    // Planes of one word per net: the vector's inputs on a reset board, the
+    // levels of the current pass, and the lanes each net is stuck in
+    std::vector<uint64_t> base_value(num_signals), base_z(num_signals);
+    std::vector<uint64_t> value(num_signals), z(num_signals);
+    std::vector<uint64_t> stuck_low(num_signals, 0), stuck_high(num_signals, 0);
+    std::vector<int> checked;
+
+    // Simulates test_vector (1-based number) against the remaining faults
+    auto simulateVector = [&](const TestVector& test_vector, uint64_t number) {
+        std::fill(base_value.begin(), base_value.end(), 0);
+        std::fill(base_z.begin(), base_z.end(), ~uint64_t(0));
+        if (circuit.vcc_signal >= 0) {
+            base_value[circuit.vcc_signal] = ~uint64_t(0);
+            base_z[circuit.vcc_signal] = 0;
+        }
+        if (circuit.gnd_signal >= 0) base_z[circuit.gnd_signal] = 0;
+        for (const auto& input : test_vector.inputs) {
+            const int signal = findSignal(input.first);
+            if (signal < 0) continue;
+            if (circuit.dead_signals[signal]) {
+                std::cerr << "Test vector " << number << " drives " << input.first
+                          << ", which the levelized schedule treats as floating" << std::endl;
+                return false;
+            }
+            base_value[signal] = input.second == LogicLevel::HIGH ? ~uint64_t(0) : 0;
+            base_z[signal] = input.second == LogicLevel::FLOATING ? ~uint64_t(0) : 0;
+        }
+        checked.clear();
+        for (const auto& output : test_vector.expected_outputs) {
+            const int signal = findSignal(output.first);
+            if (signal >= 0) checked.push_back(signal);
+        }
+        if (checked.empty()) return true;
+
+        bool dropped = false;
+        for (size_t first = 0; first < remaining.size(); first += FAULTS_PER_PASS) {
+            const size_t count = std::min<size_t>(FAULTS_PER_PASS, remaining.size() - first);
+            value = base_value;
+            z = base_z;
+            for (size_t k = 0; k < count; ++k) {
+                const int f = remaining[first + k];
+                const uint64_t bit = uint64_t(2) << k;
+                const int net = fault_nets[f];
+                if (report.faults[f].stuck_at == LogicLevel::HIGH) {
+                    stuck_high[net] |= bit;
+                    value[net] |= bit;
+                } else {
+                    stuck_low[net] |= bit;
+                    value[net] &= ~bit;
+                }
+                z[net] &= ~bit;
+            }
+            evaluateFaultyGates(circuit.packed_gates, value.data(), z.data(), stuck_low.data(), stuck_high.data());
+            FMODEL_PROFILE_ADD(profile.get(), packed_passes, 1);
+            FMODEL_PROFILE_ADD(profile.get(), packed_gate_evaluations, circuit.packed_gates.size());
+
+            // Lanes whose level differs from a known fault-free one
+            uint64_t detected = 0;
+            for (int signal : checked) {
+                if (z[signal] & 1) continue;
+                const uint64_t good = (value[signal] & 1) ? ~uint64_t(0) : 0;
+                detected |= (value[signal] ^ good) | z[signal];
+            }
+            for (size_t k = 0; k < count; ++k) {
+                const int f = remaining[first + k];
+                stuck_low[fault_nets[f]] = stuck_high[fault_nets[f]] = 0;
+                if ((detected >> (k + 1)) & 1) {
+                    report.faults[f].detected_by = number;
+                    report.detected++;
+                    remaining[first + k] = -1;
+                    dropped = true;
+                }
+            }
+        }
+        if (dropped) remaining.erase(std::remove(remaining.begin(), remaining.end(), -1), remaining.end());
+        return true;
+    };
+
+    bool ok = true;
+    {
+        FMODEL_PROFILE_SCOPE(profile.get(), SIMULATE);
+        if (!vector_stream) {
+            report.vectors = test_vectors.size();
+            for (size_t i = 0; i < test_vectors.size() && ok && !remaining.empty(); ++i) {
+                ok = simulateVector(test_vectors[i], i + 1);
+            }
+        } else {
+            report.vectors = vector_stream->size();
+            vector_stream->rewind();
+            uint64_t done = 0;
+            while (ok && !remaining.empty()) {
+                const size_t count = vector_stream->readBatch(test_vectors, vector_batch_size);
+                if (count == 0) break;
+                for (size_t i = 0; i < count && ok && !remaining.empty(); ++i) ok = simulateVector(test_vectors[i], done + i + 1);
+                done += count;
+            }
+            if (vector_stream->error()) {
+                std::cerr << "Packed vector file error: " << vector_stream->error() << std::endl;
+                ok = false;
+            }
+        }
+        FMODEL_PROFILE_ADD(profile.get(), vectors, report.vectors);
+    }
+    if (ok) printFaultReport(report);
+    return ok;
+}
+
+void FModel::printFaultReport(const FaultReport& report) const {
+    if (report_level == ReportLevel::SILENT) return;
+    auto describe = [](const FaultReport::Fault& fault) {
+        return fault.net + (fault.stuck_at == LogicLevel::HIGH ? " stuck-at-1" : " stuck-at-0");
+    };
+
+    std::cout << "\n=== Fault Simulation ===" << std::endl;
+    std::cout << "Faults: " << report.faults.size() << " single stuck-at faults on " << report.faults.size() / 2
+              << " nets, " << report.vectors << " test vectors" << std::endl;
+    if (report_level == ReportLevel::VERBOSE) {
+        for (const FaultReport::Fault& fault : report.faults) {
+            std::cout << "  " << describe(fault) << ": ";
+            if (fault.detected_by) {
+                std::cout << "detected by vector " << fault.detected_by << "\n";
+            } else {
+                std::cout << "undetected\n";
+            }
+        }
+    } else if (report_level == ReportLevel::FAILURES && report.detected < report.faults.size()) {
+        std::cout << "Undetected faults:\n";
+        for (const FaultReport::Fault& fault : report.faults) {
+            if (!fault.detected_by) std::cout << "  " << describe(fault) << "\n";
+        }
+    }
+    std::cout << "Fault coverage: " << report.detected << "/" << report.faults.size() << " detected ("
+              << std::fixed << std::setprecision(2) << report.coverage() << "%)" << std::defaultfloat << std::endl;
+}
+
+} // namespace FModel
@@ -4,58 +4,153 @@
  */
 
 #include "fmodel.h"
+#include "bitparallel.h"
+#include "circuit_cache.h"
 #include "components.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+#include "part_descriptors.h"
+#include "profile.h"
+#include "sexpr.h"
+#include "thread_pool.h"
+#include "timed.h"
+#include "vcd.h"
+#include "vector_file.h"
+#include <algorithm>
+#include <sys/stat.h>
 
 namespace FModel {
 
-FModel::FModel() : simulation_ready(false) {
+namespace {
+
+Component::LogicLevel toComponentLevel(LogicLevel lvl) {
+    switch (lvl) {
+        case LogicLevel::LOW: return Component::LOW;
+        case LogicLevel::HIGH: return Component::HIGH;
+        case LogicLevel::FLOATING: default: return Component::FLOATING;
+    }
+}
+
+LogicLevel toFmodelLevel(Component::LogicLevel lvl) {
+    switch (lvl) {
+        case Component::LOW: return LogicLevel::LOW;
+        case Component::HIGH: return LogicLevel::HIGH;
+        case Component::FLOATING: default: return LogicLevel::FLOATING;
+    }
+}
+
+// No part has more than PART_PINS pins, so a longer number is rejected
+// before it can overflow
+bool parsePinNumber(std::string_view str, int& pin) {
+    if (str.empty()) return false;
+    int value = 0;
+    for (char c : str) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+        if (value > PART_PINS) return false;
+    }
+    pin = value;
+    return true;
+}
+
+} // namespace
+
+FModel::FModel()
+    : simulation_ready(false), vector_batch_size(DEFAULT_VECTOR_BATCH), report_level(ReportLevel::VERBOSE), compiled(false),
+      propagation_mode(PropagationMode::LEVELIZED), use_bit_parallel(false), packed_backend(PackedBackend::AUTO),
+      shard_vectors(false), timed_mode(false), optimize_gates(false) {
     initializeComponentFactories();
 }
 
 FModel::~FModel() {
-    // Cleanup handled by smart pointers
+    // Topology objects go with the arena's blocks; nothing is freed one by one
 }
 
+namespace {
+
+// Parts hold only fixed-size arrays and flags, so skipping their (empty)
+// destructors when the arena is released leaks nothing
+template <typename Part>
+Component* createPart(Arena& arena) {
+    return new (arena.allocate(sizeof(Part), alignof(Part))) Part();
+}
+
+} // namespace
+
 void FModel::initializeComponentFactories() {
-    component_factories["74HC08"] = []() -> std::shared_ptr<Component> {
-        return std::make_shared<QuadAND_74HC08>();
-    };
-    
-    component_factories["74HC32"] = []() -> std::shared_ptr<Component> {
-        return std::make_shared<QuadOR_74HC32>();
-    };
-    
-    component_factories["74HC00"] = []() -> std::shared_ptr<Component> {
-        return std::make_shared<QuadNAND_74HC00>();
-    };
-    
-    component_factories["74HC02"] = []() -> std::shared_ptr<Component> {
-        return std::make_shared<QuadNOR_74HC02>();
-    };
-    
-    component_factories["74HC86"] = []() -> std::shared_ptr<Component> {
-        return std::make_shared<QuadXOR_74HC86>();
-    };
-    component_factories["74HC04"] = []() -> std::shared_ptr<Component> {
-        return std::make_shared<HexInverter_74HC04>();
-    };
-    component_factories["74HC74"] = []() -> std::shared_ptr<Component> {
-        return std::make_shared<DualDFF_74HC74>();
-    };
+    component_factories["74HC08"] = createPart<QuadAND_74HC08>;
+    component_factories["74HC32"] = createPart<QuadOR_74HC32>;
+    component_factories["74HC00"] = createPart<QuadNAND_74HC00>;
+    component_factories["74HC02"] = createPart<QuadNOR_74HC02>;
+    component_factories["74HC86"] = createPart<QuadXOR_74HC86>;
+    component_factories["74HC04"] = createPart<HexInverter_74HC04>;
+    component_factories["74HC74"] = createPart<DualDFF_74HC74>;
 }
 
 bool FModel::loadFromNetlist(const std::string& netlist_file) {
-    std::cout << "Loading netlist from: " << netlist_file << std::endl;
+    if (report_level != ReportLevel::SILENT) {
+        std::cout << "Loading netlist from: " << netlist_file << std::endl;
+    }
     
-    if (!parseNetlistFile(netlist_file)) {
+    // Map the file instead of copying it; the parsers work on the view
+    MappedFile file;
+    if (!file.open(netlist_file)) {
+        std::cerr << "Cannot open netlist file: " << netlist_file << std::endl;
         std::cerr << "Failed to parse netlist file: " << netlist_file << std::endl;
         return false;
     }
+    return loadNetlistData(netlist_file, file.data());
+}
+
+bool FModel::loadFromNetlistData(const std::string& netlist_name, std::string_view content) {
+    if (report_level != ReportLevel::SILENT) {
+        std::cout << "Loading netlist from memory: " << netlist_name << std::endl;
+    }
+    return loadNetlistData(netlist_name, content);
+}
+
+bool FModel::loadNetlistData(const std::string& netlist_file, std::string_view content) {
+    // The cache key covers the netlist bytes and the loader that reads them;
+    // it is only consulted for an empty model, as the cache replaces it whole
+    const bool use_cache = !cache_dir.empty() && signals.empty() && components.empty();
+    std::string cache_path;
+    uint64_t cache_key = 0;
+    if (use_cache) {
+        const bool kicad = netlist_file.size() >= 4 && netlist_file.substr(netlist_file.size() - 4) == ".net";
+        cache_key = hashBytes(content, kicad ? 1 : 2);
+        cache_path = circuitCachePath(cache_dir, cache_key);
+        MappedFile cached;
+        if (cached.open(cache_path) && readCircuitCache(cached.data(), cache_key)) {
+            simulation_ready = true;
+            if (report_level != ReportLevel::SILENT) {
+                std::cout << "Loaded compiled circuit from cache: " << cache_path << std::endl;
+            }
+            if (report_level == ReportLevel::VERBOSE) printCircuitInfo();
+            return true;
+        }
+    }
     
-    simulation_ready = validateCircuit();
+    if (!parseNetlistFile(netlist_file, content)) {
+        std::cerr << "Failed to parse netlist file: " << netlist_file << std::endl;
+        return false;
+    }
+    
+    simulation_ready = validateCircuit() && compile();
+    // A shared hierarchy is cheap to compile and is not cached
+    if (simulation_ready && use_cache && module_instances.empty()) {
+        // A cache that cannot be written only costs the next run its speedup
+        ::mkdir(cache_dir.c_str(), 0777);
+        if (!writeCircuitCache(cache_path, cache_key)) {
+            std::cerr << "Warning: cannot write circuit cache " << cache_path << std::endl;
+        } else if (report_level == ReportLevel::VERBOSE) {
+            std::cout << "Wrote compiled circuit cache: " << cache_path << std::endl;
+        }
+    }
     if (simulation_ready) {
-        std::cout << "Circuit loaded and validated successfully!" << std::endl;
-        printCircuitInfo();
+        if (report_level != ReportLevel::SILENT) {
+            std::cout << "Circuit loaded and validated successfully!" << std::endl;
+        }
+        if (report_level == ReportLevel::VERBOSE) printCircuitInfo();
     } else {
         std::cerr << "Circuit validation failed!" << std::endl;
     }
@@ -63,247 +158,266 @@ bool FModel::loadFromNetlist(const std::string& netlist_file) {
     return simulation_ready;
 }
 
-bool FModel::parseNetlistFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Cannot open netlist file: " << filename << std::endl;
-        return false;
-    }
-    
-    std::string content((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
-    file.close();
-    
+bool FModel::parseNetlistFile(const std::string& filename, std::string_view content) {
+    FMODEL_PROFILE_SCOPE(profile.get(), PARSE);
     // Dispatch based on file extension: .net (KiCad), else assume json (legacy)
     if (filename.size() >= 4 && filename.substr(filename.size() - 4) == ".net") {
         return parseKiCadNetlist(content);
     }
+    return parseJsonNetlist(content);
+}
 
-    // Parse module name
-    size_t module_pos = content.find("\"module_name\"");
-    if (module_pos != std::string::npos) {
-        size_t colon_pos = content.find(":", module_pos);
-        size_t quote1 = content.find("\"", colon_pos);
-        size_t quote2 = content.find("\"", quote1 + 1);
-        module_name = content.substr(quote1 + 1, quote2 - quote1 - 1);
-    }
-    
-    // Parse inputs
-    size_t inputs_pos = content.find("\"inputs\"");
-    if (inputs_pos != std::string::npos) {
-        size_t bracket_start = content.find("[", inputs_pos);
-        size_t bracket_end = content.find("]", bracket_start);
-        
-        if (bracket_start != std::string::npos && bracket_end != std::string::npos) {
-            std::string inputs_section = content.substr(bracket_start + 1, bracket_end - bracket_start - 1);
-            
-            // Find all input names
-            size_t pos = 0;
-            while ((pos = inputs_section.find("\"name\"", pos)) != std::string::npos) {
-                size_t colon_pos = inputs_section.find(":", pos);
-                size_t quote1 = inputs_section.find("\"", colon_pos);
-                size_t quote2 = inputs_section.find("\"", quote1 + 1);
-                std::string input_name = inputs_section.substr(quote1 + 1, quote2 - quote1 - 1);
-                createSignal(input_name, true, false);
-                pos = quote2;
-            }
-        }
+bool FModel::parseJsonNetlist(std::string_view content) {
+    // Streaming walk over the verilog_to_pcb_final.py --json layout:
+    // {"module_name", "inputs"/"outputs": [{"name", "width"}],
+    //  "ic_instances": [{"instance_id", "part_number", "package",
+    //  "pin_assignments": {"pin": "net"}, "gates": [...]}]}. Unknown members
+    // are skipped structurally, so member order and extra fields don't matter.
+    // A --hierarchical netlist adds "module_instances" to any module and the
+    // module templates under the top-level "modules".
+    JsonReader json(content);
+    if (!parseJsonModule(json, true)) {
+        std::cerr << "Netlist parse error at line " << json.line() << ": "
+                  << (json.error() ? json.error() : "malformed JSON") << std::endl;
+        return false;
     }
-    
-    // Parse outputs
-    size_t outputs_pos = content.find("\"outputs\"");
-    if (outputs_pos != std::string::npos) {
-        size_t bracket_start = content.find("[", outputs_pos);
-        size_t bracket_end = content.find("]", bracket_start);
-        
-        if (bracket_start != std::string::npos && bracket_end != std::string::npos) {
-            std::string outputs_section = content.substr(bracket_start + 1, bracket_end - bracket_start - 1);
-            
-            // Find all output names
-            size_t pos = 0;
-            while ((pos = outputs_section.find("\"name\"", pos)) != std::string::npos) {
-                size_t colon_pos = outputs_section.find(":", pos);
-                size_t quote1 = outputs_section.find("\"", colon_pos);
-                size_t quote2 = outputs_section.find("\"", quote1 + 1);
-                std::string output_name = outputs_section.substr(quote1 + 1, quote2 - quote1 - 1);
-                createSignal(output_name, false, true);
-                pos = quote2;
+    std::vector<char> progress(modules.size(), 0);
+    return bindModules(*this, progress);
+}
+
+bool FModel::parseJsonModule(JsonReader& json, bool top) {
+    // Ports are few; collect them so a name declared twice keeps its widest
+    // declaration, as the generator does when it writes connectors
+    struct Port { std::string name; long width; };
+    auto parsePorts = [&](std::vector<Port>& ports) {
+        return json.forEachElement([&]() {
+            Port port{std::string(), 1};
+            if (!json.forEachMember([&](std::string_view key) {
+                    std::string_view name;
+                    if (key == "name") {
+                        if (!json.readString(name)) return false;
+                        port.name = std::string(name);
+                        return true;
+                    }
+                    if (key == "width") return json.readInteger(port.width);
+                    return json.skipValue();
+                })) return false;
+            for (Port& existing : ports) {
+                if (existing.name == port.name) {
+                    existing.width = std::max(existing.width, port.width);
+                    return true;
+                }
             }
+            ports.push_back(std::move(port));
+            return true;
+        });
+    };
+
+    // Pins are buffered per instance so the component can be created once
+    // its part number is known, wherever the members appear
+    auto parseInstance = [&]() {
+        std::string instance_id, part_number, package;
+        std::vector<std::pair<std::string, int>> pins;
+        if (!json.forEachMember([&](std::string_view key) {
+                std::string* field = key == "instance_id" ? &instance_id
+                                   : key == "part_number" ? &part_number
+                                   : key == "package" ? &package : nullptr;
+                if (field) {
+                    std::string_view value;
+                    if (!json.readString(value)) return false;
+                    *field = std::string(value);
+                    return true;
+                }
+                if (key != "pin_assignments") return json.skipValue();
+                return json.forEachMember([&](std::string_view pin) {
+                    std::string pin_name(pin);
+                    std::string_view net;
+                    if (!json.readString(net)) return false;
+                    pins.emplace_back(std::move(pin_name), createSignal(net, false, false)->index);
+                    return true;
+                });
+            })) return false;
+
+        addComponent(instance_id, part_number, package);
+        ComponentInstance* instance = findComponent(instance_id);
+        if (!instance) return true;
+        for (const auto& pin : pins) {
+            connectPin(*instance, pin.first, pin.second);
         }
-    }
-    
-    // Parse IC instances
-    size_t instances_pos = content.find("\"ic_instances\"");
-    if (instances_pos != std::string::npos) {
-        size_t bracket_start = content.find("[", instances_pos);
-        size_t bracket_end = content.find("]", bracket_start);
-        
-        if (bracket_start != std::string::npos && bracket_end != std::string::npos) {
-            std::string instances_section = content.substr(bracket_start + 1, bracket_end - bracket_start - 1);
-            
-            // Find all instances
-            size_t pos = 0;
-            while ((pos = instances_section.find("\"instance_id\"", pos)) != std::string::npos) {
-                // Extract instance ID
-                size_t colon_pos = instances_section.find(":", pos);
-                size_t quote1 = instances_section.find("\"", colon_pos);
-                size_t quote2 = instances_section.find("\"", quote1 + 1);
-                std::string instance_id = instances_section.substr(quote1 + 1, quote2 - quote1 - 1);
-                
-                // Extract part number
-                size_t part_pos = instances_section.find("\"part_number\"", pos);
-                size_t part_colon = instances_section.find(":", part_pos);
-                size_t part_quote1 = instances_section.find("\"", part_colon);
-                size_t part_quote2 = instances_section.find("\"", part_quote1 + 1);
-                std::string part_number = instances_section.substr(part_quote1 + 1, part_quote2 - part_quote1 - 1);
-                
-                // Extract package
-                size_t pkg_pos = instances_section.find("\"package\"", pos);
-                size_t pkg_colon = instances_section.find(":", pkg_pos);
-                size_t pkg_quote1 = instances_section.find("\"", pkg_colon);
-                size_t pkg_quote2 = instances_section.find("\"", pkg_quote1 + 1);
-                std::string package = instances_section.substr(pkg_quote1 + 1, pkg_quote2 - pkg_quote1 - 1);
-                
-                // Create component
-                addComponent(instance_id, part_number, package);
-                
-                // Extract pin assignments
-                size_t pin_pos = instances_section.find("\"pin_assignments\"", pos);
-                if (pin_pos != std::string::npos) {
-                    size_t pin_brace_start = instances_section.find("{", pin_pos);
-                    size_t pin_brace_end = instances_section.find("}", pin_brace_start);
-                    
-                    if (pin_brace_start != std::string::npos && pin_brace_end != std::string::npos) {
-                        std::string pin_section = instances_section.substr(pin_brace_start + 1, pin_brace_end - pin_brace_start - 1);
-                        
-                        // Parse pin assignments
-                        size_t pin_parse_pos = 0;
-                        while ((pin_parse_pos = pin_section.find("\"", pin_parse_pos)) != std::string::npos) {
-                            size_t pin_quote1 = pin_parse_pos;
-                            size_t pin_quote2 = pin_section.find("\"", pin_quote1 + 1);
-                            std::string pin_num = pin_section.substr(pin_quote1 + 1, pin_quote2 - pin_quote1 - 1);
-                            
-                            size_t colon_pos = pin_section.find(":", pin_quote2);
-                            size_t signal_quote1 = pin_section.find("\"", colon_pos);
-                            size_t signal_quote2 = pin_section.find("\"", signal_quote1 + 1);
-                            std::string signal_name = pin_section.substr(signal_quote1 + 1, signal_quote2 - signal_quote1 - 1);
-                            
-                            connectSignal(instance_id, pin_num, signal_name);
-                            pin_parse_pos = signal_quote2;
-                        }
-                    }
+        return true;
+    };
+
+    // Module instances are bound once every template has been read
+    auto parseModuleInstance = [&]() {
+        ModuleInstance instance;
+        if (!json.forEachMember([&](std::string_view key) {
+                std::string* field = key == "instance_name" ? &instance.name
+                                   : key == "module_name" ? &instance.module_name : nullptr;
+                if (field) {
+                    std::string_view value;
+                    if (!json.readString(value)) return false;
+                    *field = std::string(value);
+                    return true;
                 }
-                
-                pos = instances_section.find("\"instance_id\"", pos + 1);
+                if (key != "connections") return json.skipValue();
+                return json.forEachMember([&](std::string_view port) {
+                    std::string port_name(port);
+                    std::string_view net;
+                    if (!json.readString(net)) return false;
+                    instance.connections.emplace_back(std::move(port_name), createSignal(net, false, false)->index);
+                    return true;
+                });
+            })) return false;
+        module_instances.push_back(std::move(instance));
+        return true;
+    };
+
+    auto parseModule = [&]() {
+        auto module = std::make_unique<FModel>();
+        module->report_level = ReportLevel::SILENT;
+        if (!module->parseJsonModule(json, false)) return false;
+        modules.push_back(std::move(module));
+        return true;
+    };
+
+    std::vector<Port> inputs, outputs;
+    const bool parsed = json.forEachMember([&](std::string_view key) {
+        if (key == "module_name") {
+            std::string_view name;
+            if (!json.readString(name)) return false;
+            module_name = std::string(name);
+            return true;
+        }
+        if (key == "inputs") return parsePorts(inputs);
+        if (key == "outputs") return parsePorts(outputs);
+        if (key == "ic_instances") return json.forEachElement(parseInstance);
+        if (key == "module_instances") return json.forEachElement(parseModuleInstance);
+        if (key == "modules" && top) return json.forEachElement(parseModule);
+        return json.skipValue();
+    });
+    if (!parsed) return false;
+
+    // Buses are flattened to name_0..name_{width-1}, matching the nets the
+    // generator connects to its JIN_/JOUT_ connectors
+    auto markPorts = [&](const std::vector<Port>& ports, bool is_input) {
+        for (const Port& port : ports) {
+            for (long bit = 0; bit < std::max(port.width, 1L); bit++) {
+                auto signal = createSignal(port.width > 1 ? port.name + "_" + std::to_string(bit) : port.name);
+                (is_input ? signal->is_input : signal->is_output) = true;
+                signal->is_internal = !signal->is_input && !signal->is_output;
             }
         }
-    }
+    };
+    markPorts(inputs, true);
+    markPorts(outputs, false);
     
     return true;
 }
 
-bool FModel::parseKiCadNetlist(const std::string& content) {
-    // Extremely lightweight S-expression-ish parser tailored to the sample .net
-    // Extract components U1/U2/U3 and their part numbers (value)
-    // Then extract all nets with (node (ref Ui) (pin N)) and connect pins to net name
+bool FModel::parseKiCadNetlist(std::string_view content) {
+    // One pass over the S-expression tree: (export ... (components (comp ...))
+    // (nets (net (name "...") (node (ref U1) (pin 3)) ...))). Tokens are views
+    // into the buffer; strings are only materialized for stored names.
+    using Tok = SExprTokenizer::TokenType;
+    SExprTokenizer tokens(content);
+    bool have_components = false;
+    const char* problem = "malformed S-expression";
 
-    // Components
-    size_t comps_pos = content.find("(components");
-    if (comps_pos == std::string::npos) return false;
-    size_t nets_pos = content.find("(nets", comps_pos);
-    std::string comps_section = content.substr(comps_pos, nets_pos - comps_pos);
+    auto fail = [&]() {
+        std::cerr << "Netlist parse error at line " << tokens.line() << ": "
+                  << (tokens.error() ? tokens.error() : problem) << std::endl;
+        return false;
+    };
+    // Calls field(key) for every "(key ...)" child of the current list; the
+    // callback must consume the child up to its CLOSE.
+    auto forEachField = [&](auto&& field) {
+        for (;;) {
+            const SExprTokenizer::Token t = tokens.next();
+            if (t.type == Tok::CLOSE) return true;
+            if (t.type == Tok::END) problem = "unexpected end of file";
+            if (t.type == Tok::END || t.type == Tok::ERROR) return false;
+            if (t.type != Tok::OPEN) continue;
+            const SExprTokenizer::Token key = tokens.next();
+            if (key.type == Tok::CLOSE) continue;
+            if (key.type != Tok::ATOM) {
+                problem = key.type == Tok::END ? "unexpected end of file" : "expected a list name";
+                return false;
+            }
+            if (!field(key.text)) return false;
+        }
+    };
 
-    size_t comp_pos = 0;
-    while ((comp_pos = comps_section.find("(comp (ref ", comp_pos)) != std::string::npos) {
-        size_t ref_start = comp_pos + std::string("(comp (ref ").size();
-        size_t ref_end = comps_section.find(")", ref_start);
-        if (ref_end == std::string::npos) break;
-        std::string instance_id = comps_section.substr(ref_start, ref_end - ref_start);
+    auto parseComp = [&]() {
+        std::string_view ref, value;
+        if (!forEachField([&](std::string_view key) {
+                if (key == "ref") return tokens.readValue(ref);
+                if (key == "value") return tokens.readValue(value);
+                return tokens.skipList();
+            })) return false;
+        // Only add known logic ICs; skip connectors and others
+        if (value.substr(0, 2) == "74") {
+            addComponent(std::string(ref), std::string(value), "DIP-14");
+        }
+        return true;
+    };
 
-        size_t next_comp = comps_section.find("(comp (ref ", ref_end);
-        size_t comp_block_end = (next_comp == std::string::npos) ? comps_section.size() : next_comp;
-        std::string comp_block = comps_section.substr(ref_end, comp_block_end - ref_end);
+    auto parseNet = [&]() {
+        Signal* net = nullptr;
+        return forEachField([&](std::string_view key) {
+            if (key == "name") {
+                std::string_view name;
+                if (!tokens.readValue(name)) return false;
+                const int existing = findSignal(name);
+                net = existing >= 0 ? signals[existing] : createSignal(name, false, false);
+                return true;
+            }
+            if (key != "node" || !net) return tokens.skipList();
 
-        size_t value_pos = comp_block.find("(value ");
-        if (value_pos == std::string::npos) { comp_pos = comp_block_end; continue; }
-        size_t value_start = value_pos + std::string("(value ").size();
-        size_t value_end = comp_block.find(")", value_start);
-        if (value_end == std::string::npos) { comp_pos = comp_block_end; continue; }
-        std::string part_number = comp_block.substr(value_start, value_end - value_start);
-
-        // Only add known logic ICs; skip connectors and others
-        if (part_number.rfind("74", 0) == 0) {
-            addComponent(instance_id, part_number, "DIP-14");
-        }
-        comp_pos = comp_block_end;
-    }
-
-    // Nets
-    if (nets_pos == std::string::npos) return true;
-    size_t nets_end = content.find("\n)\n", nets_pos);
-    std::string nets_section = content.substr(nets_pos, (nets_end == std::string::npos ? content.size() : nets_end) - nets_pos);
-
-    size_t net_pos = 0;
-    while ((net_pos = nets_section.find("(net ", net_pos)) != std::string::npos) {
-        // Net name
-        size_t name_pos = nets_section.find("(name \"", net_pos);
-        if (name_pos == std::string::npos) break;
-        size_t name_start = name_pos + 7;
-        size_t name_end = nets_section.find("\"", name_start);
-        std::string net_name = nets_section.substr(name_start, name_end - name_start);
-        if (signal_map.find(net_name) == signal_map.end()) {
-            createSignal(net_name, false, false);
-        }
-
-        // Nodes
-        size_t node_pos = name_end;
-        while ((node_pos = nets_section.find("(node (ref ", node_pos)) != std::string::npos) {
-            size_t ref_start = node_pos + 11;
-            size_t ref_end = nets_section.find(")", ref_start);
-            std::string ref = nets_section.substr(ref_start, ref_end - ref_start);
-            size_t pin_pos = nets_section.find("(pin ", ref_end);
-            if (pin_pos == std::string::npos) break;
-            size_t pin_start = pin_pos + 5;
-            size_t pin_end = nets_section.find(")", pin_start);
-            std::string pin = nets_section.substr(pin_start, pin_end - pin_start);
+            std::string_view ref, pin;
+            if (!forEachField([&](std::string_view node_key) {
+                    if (node_key == "ref") return tokens.readValue(ref);
+                    if (node_key == "pin") return tokens.readValue(pin);
+                    return tokens.skipList();
+                })) return false;
 
             // Use connector nodes to classify signal direction
-            if (ref.rfind("JIN_", 0) == 0) {
-                auto it = signal_map.find(net_name);
-                if (it != signal_map.end()) {
-                    it->second->is_input = true;
-                    if (it->second->is_output) {
-                        it->second->is_internal = false;
-                    }
-                }
-            } else if (ref.rfind("JOUT_", 0) == 0) {
-                auto it = signal_map.find(net_name);
-                if (it != signal_map.end()) {
-                    it->second->is_output = true;
-                    if (it->second->is_input) {
-                        it->second->is_internal = false;
-                    }
-                }
+            if (ref.substr(0, 4) == "JIN_") {
+                net->is_input = true;
+                if (net->is_output) net->is_internal = false;
+            } else if (ref.substr(0, 5) == "JOUT_") {
+                net->is_output = true;
+                if (net->is_input) net->is_internal = false;
             }
 
             // Connect only if component exists; otherwise treat as external connector
-            if (component_map.find(ref) != component_map.end()) {
-                connectSignal(ref, pin, net_name);
+            if (ComponentInstance* instance = findComponent(ref)) {
+                connectPin(*instance, pin, net->index);
             }
+            return true;
+        });
+    };
 
-            // advance
-            node_pos = pin_end;
-            // Stop this net's nodes when we hit a new (net
-            size_t peek_net = nets_section.find("(net ", pin_end);
-            size_t peek_node = nets_section.find("(node (ref ", pin_end);
-            if (peek_net != std::string::npos && (peek_node == std::string::npos || peek_net < peek_node)) break;
-        }
-        net_pos = nets_section.find("(net ", net_pos + 5);
+    if (tokens.next().type != Tok::OPEN) {
+        problem = "expected '('";
+        return fail();
     }
+    tokens.next();   // export
+    const bool parsed = forEachField([&](std::string_view section) {
+        if (section == "components") {
+            have_components = true;
+            return forEachField([&](std::string_view key) { return key == "comp" ? parseComp() : tokens.skipList(); });
+        }
+        if (section == "nets") {
+            return forEachField([&](std::string_view key) { return key == "net" ? parseNet() : tokens.skipList(); });
+        }
+        return tokens.skipList();
+    });
+    if (!parsed) return fail();
+    if (!have_components) return false;
 
     // Create explicit power signals if present
-    if (signal_map.find("VCC") == signal_map.end()) createSignal("VCC", false, false);
-    if (signal_map.find("GND") == signal_map.end()) createSignal("GND", false, false);
+    if (findSignal("VCC") < 0) createSignal("VCC", false, false);
+    if (findSignal("GND") < 0) createSignal("GND", false, false);
 
     module_name = "kicad_netlist";
     return true;
@@ -311,89 +425,311 @@ bool FModel::parseKiCadNetlist(const std::string& content) {
 
 bool FModel::addComponent(const std::string& instance_id, const std::string& part_number, 
                          const std::string& package) {
-    auto component = std::make_shared<ComponentInstance>(instance_id, part_number, package);
-    component->component = createComponent(part_number);
-    
-    if (!component->component) {
+    ComponentInstance* component = createInstance(instance_id, part_number, package);
+    if (!component) {
         std::cerr << "Failed to create component: " << part_number << std::endl;
         return false;
     }
+    compiled = false;
     
-    components.push_back(component);
-    component_map[instance_id] = component;
-    
-    std::cout << "Added component: " << instance_id << " (" << part_number << ")" << std::endl;
+    if (report_level == ReportLevel::VERBOSE) {
+        std::cout << "Added component: " << instance_id << " (" << part_number << ")" << std::endl;
+    }
     return true;
 }
 
-std::shared_ptr<Component> FModel::createComponent(const std::string& part_number) {
+ComponentInstance* FModel::createInstance(std::string_view instance_id, std::string_view part_number,
+                                          std::string_view package) {
     auto factory = component_factories.find(part_number);
-    if (factory != component_factories.end()) {
-        return factory->second();
+    if (factory == component_factories.end()) {
+        std::cerr << "Unknown component type: " << part_number << std::endl;
+        return nullptr;
     }
-    
-    std::cerr << "Unknown component type: " << part_number << std::endl;
-    return nullptr;
+
+    // A repeated instance ID names the latest instance, as before
+    const uint32_t id = instance_names.intern(instance_id);
+    ComponentInstance* instance = arena.create<ComponentInstance>(instance_names.view(id), factory->first,
+                                                                  arena.copy(package));
+    instance->component = factory->second(arena);
+    if (id == instance_components.size()) instance_components.push_back(0);
+    instance_components[id] = static_cast<int>(components.size());
+    components.push_back(instance);
+    return instance;
+}
+
+ComponentInstance* FModel::findComponent(std::string_view instance_id) const {
+    const uint32_t id = instance_names.find(instance_id);
+    return id == StringTable::NOT_FOUND ? nullptr : components[instance_components[id]];
 }
 
 bool FModel::connectSignal(const std::string& instance_id, const std::string& pin, 
                           const std::string& signal_name) {
-    auto component = component_map.find(instance_id);
-    if (component == component_map.end()) {
+    ComponentInstance* component = findComponent(instance_id);
+    if (!component) {
         std::cerr << "Component not found: " << instance_id << std::endl;
         return false;
     }
     
-    component->second->addPinAssignment(pin, signal_name);
-    
     // Create signal if it doesn't exist
-    if (signal_map.find(signal_name) == signal_map.end()) {
-        createSignal(signal_name, false, false);
+    int signal = findSignal(signal_name);
+    if (signal < 0) {
+        signal = createSignal(signal_name, false, false)->index;
     }
     
-    std::cout << "Connected " << instance_id << " pin " << pin << " to signal " << signal_name << std::endl;
+    connectPin(*component, pin, signal);
     return true;
 }
 
-std::shared_ptr<Signal> FModel::getSignal(const std::string& name) {
-    auto it = signal_map.find(name);
-    if (it != signal_map.end()) {
-        return it->second;
+void FModel::connectPin(ComponentInstance& instance, std::string_view pin, int signal) {
+    instance.addPinAssignment(arena, pin, static_cast<uint32_t>(signal));
+    compiled = false;
+    
+    if (report_level == ReportLevel::VERBOSE) {
+        std::cout << "Connected " << instance.instance_id << " pin " << pin << " to signal " << signals[signal]->name << std::endl;
+    }
+}
+
+void ComponentInstance::addPinAssignment(Arena& arena, std::string_view pin, uint32_t signal) {
+    PinAssignment* it = std::lower_bound(pin_assignments, pin_assignments + pin_count, pin,
+                                         [](const PinAssignment& pa, std::string_view key) { return pa.pin < key; });
+    if (it != pin_assignments + pin_count && it->pin == pin) {
+        it->signal = signal;
+        return;
     }
-    return nullptr;
+    const size_t at = static_cast<size_t>(it - pin_assignments);
+    if (pin_count == pin_capacity) {
+        // Room for every pin of a part up front; a wider netlist abandons the
+        // old array to the arena
+        pin_capacity = std::max<uint32_t>(Component::NUM_PINS, pin_capacity * 2);
+        PinAssignment* grown = arena.allocateArray<PinAssignment>(pin_capacity);
+        std::copy(pin_assignments, pin_assignments + pin_count, grown);
+        pin_assignments = grown;
+    }
+    std::copy_backward(pin_assignments + at, pin_assignments + pin_count, pin_assignments + pin_count + 1);
+    pin_assignments[at] = PinAssignment{arena.copy(pin), signal};
+    pin_count++;
+}
+
+int FModel::findSignal(std::string_view name) const {
+    const uint32_t id = signal_names.find(name);
+    return id == StringTable::NOT_FOUND ? -1 : static_cast<int>(id);
 }
 
-std::shared_ptr<Signal> FModel::createSignal(const std::string& name, bool is_input, bool is_output) {
-    auto signal = std::make_shared<Signal>(name, is_input, is_output);
+Signal* FModel::getSignal(const std::string& name) {
+    const int signal = findSignal(name);
+    return signal >= 0 ? signals[signal] : nullptr;
+}
+
+Signal* FModel::createSignal(std::string_view name, bool is_input, bool is_output) {
+    // Net names are interned: the ID doubles as the signal index, and
+    // Signal::name views the table's single copy of the string
+    const int existing = findSignal(name);
+    if (existing >= 0) return signals[existing];
+    
+    const uint32_t id = signal_names.intern(name);
+    Signal* signal = arena.create<Signal>(signal_names.view(id), static_cast<int>(id), is_input, is_output);
     signals.push_back(signal);
-    signal_map[name] = signal;
+    state.signal_levels.push_back(LogicLevel::FLOATING);
+    compiled = false;
     return signal;
 }
 
 void FModel::setSignalLevel(const std::string& signal_name, LogicLevel level) {
-    auto signal = getSignal(signal_name);
-    if (signal) {
-        signal->setLevel(level);
+    const int signal = findSignal(signal_name);
+    if (signal >= 0) {
+        state.signal_levels[signal] = level;
     }
 }
 
 LogicLevel FModel::getSignalLevel(const std::string& signal_name) const {
-    auto it = signal_map.find(signal_name);
-    if (it != signal_map.end()) {
-        return it->second->getLevel();
+    const int signal = findSignal(signal_name);
+    if (signal >= 0) {
+        return state.signal_levels[signal];
     }
     return LogicLevel::FLOATING;
 }
 
+bool FModel::compile() {
+    // Resolve every pin of every instance to an integer signal index once, so
+    // the propagation loop never hashes or compares strings.
+    FMODEL_PROFILE_SCOPE(profile.get(), COMPILE);
+    FMODEL_PROFILE_ADD(profile.get(), compiles, 1);
+    CompiledCircuit result;
+
+    result.vcc_signal = findSignal("VCC");
+    result.gnd_signal = findSignal("GND");
+
+    for (size_t i = 0; i < components.size(); ++i) {
+        const auto& compInst = components[i];
+        if (!compInst->component) continue;
+        const PartDescriptor* part = findPartDescriptor(compInst->part_number);
+        if (!part) {
+            std::cerr << "No part descriptor for " << compInst->part_number << " (" << compInst->instance_id << ")" << std::endl;
+            return false;
+        }
+
+        CompiledComponent cc;
+        cc.component = compInst->component;
+        cc.instance = static_cast<int>(i);
+        cc.inputs_begin = static_cast<int>(result.input_pins.size());
+        cc.outputs_begin = static_cast<int>(result.output_pins.size());
+        cc.gates_begin = cc.gates_end = 0;
+        cc.sequential = part->op == GateOp::DFF;
+
+        // pin_assignments iterates in pin-name order; keep that order, since
+        // stateful parts such as the 74HC74 observe the order inputs are driven.
+        for (const PinAssignment& pa : *compInst) {
+            const int sig = static_cast<int>(pa.signal);
+            if (sig == result.vcc_signal || sig == result.gnd_signal) continue;
+
+            int pinNum = 0;
+            if (!parsePinNumber(pa.pin, pinNum)) {
+                std::cerr << "Invalid pin '" << pa.pin << "' on " << compInst->instance_id << std::endl;
+                return false;
+            }
+
+            const PinRole role = (pinNum >= 1 && pinNum <= PART_PINS) ? part->pins[pinNum] : PinRole::NONE;
+            CompiledPin cp{pinNum, sig};
+            if (role == PinRole::OUTPUT) {
+                result.output_pins.push_back(cp);
+            } else if (role == PinRole::INPUT) {
+                result.input_pins.push_back(cp);
+            }
+        }
+
+        cc.inputs_end = static_cast<int>(result.input_pins.size());
+        cc.outputs_end = static_cast<int>(result.output_pins.size());
+        result.components.push_back(cc);
+        result.sequential = result.sequential || cc.sequential;
+    }
+
+    buildGates(result);
+    buildFanout(result);
+    if (levelize(result)) buildPackedSchedule(result);
+    buildCycleSchedule(result);
+
+    circuit = std::move(result);
+    if (!module_instances.empty() && !compileHierarchy()) {
+        flattenHierarchy();
+        return compile();
+    }
+    ThreadPool* pool = state.pool;
+    state = makeState();
+    state.pool = pool;
+    FMODEL_PROFILE_CALL(profile.get(), resize(signals.size(), circuit.components.size()));
+    compiled = true;
+    return true;
+}
+
+void FModel::buildGates(CompiledCircuit& compiled_circuit) const {
+    // Split every component into its logic cells, in output-pin order. A
+    // combinational cell with an unconnected input can only output Z and is
+    // dropped; flip-flop halves are always kept, their state is observable.
+    CompiledCircuit& cc = compiled_circuit;
+    cc.gates.clear();
+    cc.gate_input_pins.clear();
+
+    for (size_t c = 0; c < cc.components.size(); ++c) {
+        CompiledComponent& comp = cc.components[c];
+        const PartDescriptor* part = findPartDescriptor(components[comp.instance]->part_number);
+        comp.gates_begin = static_cast<int>(cc.gates.size());
+        for (int o = comp.outputs_begin; o < comp.outputs_end; ++o) {
+            const CompiledPin& out = cc.output_pins[o];
+            const CellDescriptor* cell = nullptr;
+            for (int k = 0; k < part->num_cells; ++k) {
+                if (part->cells[k].output == out.pin) cell = &part->cells[k];
+            }
+            if (!cell) continue;
+
+            CompiledGate gate;
+            gate.op = part->op;
+            gate.component = static_cast<int>(c);
+            gate.output_pin = out.pin;
+            gate.output_signal = out.signal;
+            gate.inputs_begin = static_cast<int>(cc.gate_input_pins.size());
+            // Keep the component's pin-name order within the cell (see compile())
+            for (int i = comp.inputs_begin; i < comp.inputs_end; ++i) {
+                const CompiledPin& cp = cc.input_pins[i];
+                if (std::find(cell->inputs, cell->inputs + cell->num_inputs, cp.pin) != cell->inputs + cell->num_inputs) {
+                    cc.gate_input_pins.push_back(cp);
+                }
+            }
+            gate.inputs_end = static_cast<int>(cc.gate_input_pins.size());
+            if (!comp.sequential && gate.inputs_end - gate.inputs_begin != cell->num_inputs) {
+                cc.gate_input_pins.resize(gate.inputs_begin);
+                continue;
+            }
+            gate.in_a = comp.sequential ? -1 : cc.gate_input_pins[gate.inputs_begin].signal;
+            gate.in_b = comp.sequential ? -1 : cc.gate_input_pins[gate.inputs_end - 1].signal;
+            cc.gates.push_back(gate);
+        }
+        comp.gates_end = static_cast<int>(cc.gates.size());
+    }
+}
+
+void FModel::buildFanout(CompiledCircuit& compiled_circuit) const {
+    // Counting pass, then fill: a CSR table from signal index to the
+    // components that read it, each component listed once per signal.
+    const size_t num_signals = signals.size();
+    std::vector<int>& offsets = compiled_circuit.fanout_offsets;
+    std::vector<int>& fanout = compiled_circuit.fanout_components;
+    offsets.assign(num_signals + 1, 0);
+
+    auto forEachReader = [&](auto&& visit) {
+        std::vector<int> last_reader(num_signals, -1);
+        for (size_t c = 0; c < compiled_circuit.components.size(); ++c) {
+            const CompiledComponent& cc = compiled_circuit.components[c];
+            for (int i = cc.inputs_begin; i < cc.inputs_end; ++i) {
+                int sig = compiled_circuit.input_pins[i].signal;
+                if (last_reader[sig] == static_cast<int>(c)) continue;
+                last_reader[sig] = static_cast<int>(c);
+                visit(sig, static_cast<int>(c));
+            }
+        }
+    };
+
+    forEachReader([&](int sig, int) { offsets[sig + 1]++; });
+    for (size_t s = 0; s < num_signals; ++s) offsets[s + 1] += offsets[s];
+
+    fanout.assign(offsets[num_signals], 0);
+    std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    forEachReader([&](int sig, int comp) { fanout[cursor[sig]++] = comp; });
+}
+
 bool FModel::loadTestVectors(const std::string& test_file) {
-    std::cout << "Loading test vectors from: " << test_file << std::endl;
+    if (report_level != ReportLevel::SILENT) {
+        std::cout << "Loading test vectors from: " << test_file << std::endl;
+    }
+    
+    FMODEL_PROFILE_SCOPE(profile.get(), VECTORS);
+    // Packed files are not loaded: simulate() streams them in batches
+    if (isVectorFile(test_file)) {
+        auto reader = std::make_unique<VectorFileReader>();
+        if (!reader->open(test_file)) {
+            std::cerr << "Packed vector file error: " << reader->error() << std::endl;
+            std::cerr << "Failed to parse test vector file: " << test_file << std::endl;
+            return false;
+        }
+        vector_stream = std::move(reader);
+        // The vectors become batch slots; nothing of an earlier file carries over
+        test_vectors.clear();
+        test_results.clear();
+        if (report_level != ReportLevel::SILENT) {
+            std::cout << "Streaming " << vector_stream->size() << " packed test vectors (batches of "
+                      << vector_batch_size << ")" << std::endl;
+        }
+        return true;
+    }
     
+    vector_stream.reset();
     if (!parseTestVectorFile(test_file)) {
         std::cerr << "Failed to parse test vector file: " << test_file << std::endl;
         return false;
     }
     
-    std::cout << "Loaded " << test_vectors.size() << " test vectors" << std::endl;
+    if (report_level != ReportLevel::SILENT) {
+        std::cout << "Loaded " << test_vectors.size() << " test vectors" << std::endl;
+    }
     return true;
 }
 
@@ -424,7 +760,7 @@ bool FModel::parseTestVectorFile(const std::string& filename) {
             }
             current_test = TestVector(line.substr(1, line.length() - 2));
             in_test = true;
-        } else if (in_test && line.find("=") != std::string::npos) {
+        } else if (line.find("=") != std::string::npos) {
             // Parse signal assignment
             size_t eq_pos = line.find("=");
             std::string signal_name = line.substr(0, eq_pos);
@@ -436,15 +772,30 @@ bool FModel::parseTestVectorFile(const std::string& filename) {
             value_str.erase(0, value_str.find_first_not_of(" \t"));
             value_str.erase(value_str.find_last_not_of(" \t") + 1);
             
+            // Header directive before the first vector: "clock = <net>"
+            if (!in_test) {
+                if (signal_name == "clock" && !value_str.empty()) addClock(value_str);
+                continue;
+            }
+            // "cycles = N", unless the circuit has a net of that name
+            if (signal_name == "cycles" && findSignal(signal_name) < 0) {
+                if (value_str.empty() || value_str.find_first_not_of("0123456789") != std::string::npos) {
+                    std::cerr << "Invalid cycle count in " << current_test.description << ": " << value_str << std::endl;
+                    return false;
+                }
+                current_test.cycles = std::stoull(value_str);
+                continue;
+            }
+            
             LogicLevel level = stringToLogicLevel(value_str);
 
             // Prefer direction info from netlist (JIN_/JOUT_ connectors)
             bool is_input = false;
             bool is_output = false;
-            auto sig_it = signal_map.find(signal_name);
-            if (sig_it != signal_map.end()) {
-                is_input = sig_it->second->is_input;
-                is_output = sig_it->second->is_output;
+            const int signal = findSignal(signal_name);
+            if (signal >= 0) {
+                is_input = signals[signal]->is_input;
+                is_output = signals[signal]->is_output;
             }
             // Fallback to legacy heuristics only if unknown
             if (!is_input && !is_output) {
@@ -491,8 +842,60 @@ void FModel::addTestVector(const TestVector& test_vector) {
     test_vectors.push_back(test_vector);
 }
 
+void FModel::addTestVector(TestVector&& test_vector) {
+    test_vectors.push_back(std::move(test_vector));
+}
+
 void FModel::clearTestVectors() {
     test_vectors.clear();
+    test_results.clear();
+    vector_stream.reset();
+}
+
+bool FModel::writeVectorFile(const std::string& path) const {
+    for (const TestVector& tv : test_vectors) {
+        if (tv.cycles != 1) {
+            std::cerr << "Packed vector files do not store cycle counts: " << path << std::endl;
+            return false;
+        }
+    }
+    
+    // Columns are every signal any vector drives or checks, in name order
+    std::map<std::string, bool> inputs, outputs;
+    for (const TestVector& tv : test_vectors) {
+        for (const auto& input : tv.inputs) inputs[input.first] = true;
+        for (const auto& expected : tv.expected_outputs) outputs[expected.first] = true;
+    }
+    std::vector<std::string> input_columns, output_columns;
+    for (const auto& input : inputs) input_columns.push_back(input.first);
+    for (const auto& output : outputs) output_columns.push_back(output.first);
+
+    VectorFileWriter writer;
+    if (!writer.open(path, input_columns, output_columns)) {
+        std::cerr << "Cannot write vector file: " << path << std::endl;
+        return false;
+    }
+    for (const TestVector& tv : test_vectors) writer.write(tv);
+    if (!writer.close()) {
+        std::cerr << "Cannot write vector file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void FModel::setThreads(int num_threads) {
+    // 0 selects one thread per core; a pool of one is no pool at all
+    if (num_threads == 0) num_threads = ThreadPool::hardwareThreads();
+    if (num_threads <= 1) {
+        thread_pool.reset();
+    } else if (!thread_pool || thread_pool->size() != num_threads) {
+        thread_pool = std::make_unique<ThreadPool>(num_threads);
+    }
+    state.pool = thread_pool.get();
+}
+
+int FModel::getThreads() const {
+    return thread_pool ? thread_pool->size() : 1;
 }
 
 bool FModel::simulate() {
@@ -501,155 +904,801 @@ bool FModel::simulate() {
         return false;
     }
     
-    std::cout << "\n=== Starting Simulation ===" << std::endl;
-    std::cout << "Running " << test_vectors.size() << " test vectors..." << std::endl;
+    if (!compiled && !compile()) {
+        std::cerr << "Circuit failed to compile!" << std::endl;
+        return false;
+    }
     
-    bool all_passed = true;
+    state.settled = false;
+    last_vector_count = last_failed_count = 0;
+    const bool cycle_based = !clock_names.empty();
+    const char* flat_feature = cycle_based ? "Cycle-based simulation"
+                             : timed_mode ? "Timed simulation"
+                             : !waveform_path.empty() ? "Waveform tracing"
+                             : use_bit_parallel ? "Bit-parallel simulation"
+                             : propagation_mode == PropagationMode::EVENT_DRIVEN ? "Event-driven propagation"
+                             : thread_pool && !shard_vectors ? "Multi-threaded evaluation" : nullptr;
+    if (flat_feature && !flattenFor(flat_feature)) {
+        std::cerr << "Circuit failed to compile!" << std::endl;
+        return false;
+    }
+    if (cycle_based && timed_mode) {
+        std::cerr << "Timed and cycle-based simulation cannot be combined!" << std::endl;
+        return false;
+    }
+    if (cycle_based && !bindClocks()) {
+        std::cerr << "Circuit cannot be simulated cycle by cycle!" << std::endl;
+        return false;
+    }
+    // Only the levelized and cycle-based engines run the optimized programs
+    const char* unoptimized = timed_mode ? "Timed simulation"
+                            : !waveform_path.empty() ? "Waveform tracing"
+                            : !module_instances.empty() ? "Hierarchical simulation"
+                            : propagation_mode == PropagationMode::EVENT_DRIVEN && !cycle_based ? "Event-driven propagation"
+                            : nullptr;
+    if (optimize_gates && !unoptimized) {
+        optimizeCircuit(vectorNets(), cycle_based);
+    } else if (!unoptimize()) {
+        std::cerr << "Circuit failed to compile!" << std::endl;
+        return false;
+    } else if (optimize_gates && report_level != ReportLevel::SILENT) {
+        std::cout << unoptimized << " evaluates every gate of the netlist; not optimizing" << std::endl;
+    }
+    if (!waveform_path.empty() && !startWaveform()) return false;
+    if (timed_mode) startTimedRun();
     
-    for (size_t i = 0; i < test_vectors.size(); i++) {
-        std::cout << "\n--- Test Vector " << (i + 1) << ": " << test_vectors[i].description << " ---" << std::endl;
+    const bool report = report_level != ReportLevel::SILENT;
+    const bool sharded = thread_pool && shard_vectors && !circuit.sequential && !waveform;
+    if (report) {
+        std::cout << "\n=== Starting Simulation ===" << std::endl;
+        std::cout << "Running " << (vector_stream ? vector_stream->size() : test_vectors.size()) << " test vectors..." << std::endl;
+        if (waveform) {
+            std::cout << "Waveform: " << waveform->size() << " nets to " << waveform_path << std::endl;
+        }
         
-        if (!simulateTestVector(test_vectors[i])) {
-            all_passed = false;
+        if (timed_mode) {
+            std::cout << "Timed simulation: " << circuit.gates.size() << " gates, resolution "
+                      << timed_engine->tick_ps / 1000.0 << " ns" << std::endl;
+        } else if (cycle_based) {
+            std::cout << "Cycle-based simulation: clock";
+            for (const std::string& name : clock_names) std::cout << " " << name;
+            std::cout << "; " << circuit.registers.size() << " registers, " << circuit.cycle_gates.size()
+                      << " combinational gates per cycle" << std::endl;
+        } else {
+            if (!module_instances.empty()) {
+                std::cout << "Hierarchical simulation: " << module_instances.size() << " module instances, "
+                          << hierarchy.level_count << " level slots (own nets plus instance slices)" << std::endl;
+            }
+            const bool cycle_counts = std::any_of(test_vectors.begin(), test_vectors.end(),
+                                                  [](const TestVector& tv) { return tv.cycles != 1; });
+            if (cycle_counts) {
+                std::cout << "Warning: cycle counts need a named clock (--clock=NAME); running each vector once" << std::endl;
+            }
+            if (thread_pool && shard_vectors && waveform) {
+                std::cout << "Waveform tracing runs vectors in order on one state; not sharding" << std::endl;
+            } else if (thread_pool && shard_vectors && !sharded) {
+                std::cout << "Vector sharding needs a circuit without flip-flops (their state carries across vectors); "
+                          << "running vectors in order" << std::endl;
+            }
+            if (sharded) {
+                std::cout << "Threads: " << thread_pool->size() << " (test vectors sharded across threads)" << std::endl;
+            } else if (thread_pool) {
+                const bool single_pass = propagation_mode == PropagationMode::LEVELIZED || (use_bit_parallel && circuit.bit_parallel);
+                if (circuit.parallel && single_pass) {
+                    std::cout << "Threads: " << thread_pool->size() << " (one barrier per level)" << std::endl;
+                } else {
+                    std::cout << "Multi-threaded evaluation needs a levelized circuit with single-driver nets; using one thread" << std::endl;
+                }
+            }
+            if (use_bit_parallel && waveform) {
+                std::cout << "Waveform tracing needs the level of every net per vector; using scalar simulation" << std::endl;
+            } else if (use_bit_parallel && !circuit.bit_parallel) {
+                std::cout << "Bit-parallel mode needs a levelized combinational circuit; using scalar simulation" << std::endl;
+            } else if (use_bit_parallel) {
+                const PackedKernel kernel = selectPackedKernel(packed_backend);
+                std::cout << "Bit-parallel backend: " << kernel.name << " (" << 64 * kernel.words << " vectors per pass)" << std::endl;
+            }
         }
     }
     
-    std::cout << "\n=== Simulation Complete ===" << std::endl;
-    std::cout << "Overall Result: " << (all_passed ? "PASS" : "FAIL") << std::endl;
+    bool all_passed = true;
+    if (!vector_stream) {
+        // Results are buffered and reported once at the end
+        runTestVectors();
+        last_vector_count = test_results.size();
+        last_failed_count = 0;
+        for (const TestResult& result : test_results) {
+            if (!result.passed) last_failed_count++;
+        }
+        all_passed = last_failed_count == 0;
+        printTestResults();
+    } else {
+        // Each batch reuses test_vectors and test_results, so memory stays
+        // bounded by the batch size; only the counts outlive a batch
+        size_t done = 0;
+        size_t failed = 0;
+        vector_stream->rewind();
+        auto read_batch = [&]() {
+            FMODEL_PROFILE_SCOPE(profile.get(), VECTORS);
+            return vector_stream->readBatch(test_vectors, vector_batch_size);
+        };
+        while (const size_t count = read_batch()) {
+            runTestVectors();
+            failed += reportResults(done);
+            done += count;
+        }
+        if (vector_stream->error()) {
+            std::cerr << "Packed vector file error: " << vector_stream->error() << std::endl;
+        }
+        last_vector_count = done;
+        last_failed_count = failed;
+        all_passed = failed == 0 && !vector_stream->error();
+        if (report_level != ReportLevel::SILENT) printSummary(done, failed);
+    }
+    
+    if (!finishWaveform()) all_passed = false;
+    if (report && timed_mode) printTimingReport();
+    if (report) {
+        std::cout << "\n=== Simulation Complete ===" << std::endl;
+        std::cout << "Overall Result: " << (all_passed ? "PASS" : "FAIL") << std::endl;
+    }
     
     return all_passed;
 }
 
-bool FModel::simulateTestVector(const TestVector& test_vector) {
-    // Reset circuit
-    resetCircuit();
+void FModel::runTestVectors() {
+    FMODEL_PROFILE_SCOPE(profile.get(), SIMULATE);
+    FMODEL_PROFILE_ADD(profile.get(), vectors, test_vectors.size());
+    test_results.assign(test_vectors.size(), TestResult());
+    const bool sharded = thread_pool && shard_vectors && !circuit.sequential && !waveform;
+    if (timed_mode) {
+        simulateTimed();
+    } else if (!clock_names.empty()) {
+        simulateCycles();
+    } else if (sharded) {
+        simulateSharded();
+    } else if (use_bit_parallel && circuit.bit_parallel && !waveform) {
+        simulateBitParallel();
+    } else {
+        for (size_t i = 0; i < test_vectors.size(); i++) {
+            test_results[i] = runTestVector(state, test_vectors[i]);
+            if (waveform) {
+                // One time unit per vector
+                waveform->sample(state.signal_levels.data());
+                waveform->advance(1);
+            }
+        }
+    }
+}
+
+void FModel::printTestResults() const {
+    // Emit the buffered results of the last simulate() at the report level
+    if (report_level == ReportLevel::SILENT) return;
     
-    // Apply input stimuli
+    const size_t count = std::min(test_results.size(), test_vectors.size());
+    printSummary(count, reportResults(0));
+}
+
+size_t FModel::reportResults(size_t first) const {
+    FMODEL_PROFILE_SCOPE(profile.get(), REPORT);
+    // Print the buffered vectors the report level asks for, numbered from
+    // first; returns how many failed
+    const size_t count = std::min(test_results.size(), test_vectors.size());
+    size_t failed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!test_results[i].passed) failed++;
+        if (report_level == ReportLevel::VERBOSE || (report_level == ReportLevel::FAILURES && !test_results[i].passed)) {
+            printTestVector(i, first + i + 1);
+        }
+    }
+    return failed;
+}
+
+void FModel::printSummary(size_t count, size_t failed) const {
+    FMODEL_PROFILE_SCOPE(profile.get(), REPORT);
+    if (report_level != ReportLevel::VERBOSE) {
+        std::cout << "\nVectors: " << (count - failed) << " passed, " << failed << " failed (" << count << " total)\n";
+    }
+    std::cout.flush();
+}
+
+void FModel::printTestVector(size_t index, size_t number) const {
+    std::cout << "\n--- Test Vector " << number;
+    if (!test_vectors[index].description.empty()) std::cout << ": " << test_vectors[index].description;
+    std::cout << " ---\n";
+    printInputs(test_vectors[index]);
+    printOutputs(test_results[index]);
+}
+
+bool FModel::simulateTestVector(const TestVector& test_vector) {
+    if ((!compiled && !compile()) || !unoptimize()) {
+        std::cerr << "Circuit failed to compile!" << std::endl;
+        return false;
+    }
+
+    if (!clock_names.empty() && (!flattenFor("Cycle-based simulation") || !bindClocks())) return false;
+    TestResult result = clock_names.empty() ? runTestVector(state, test_vector) : runCycleVector(state, test_vector);
+    if (report_level == ReportLevel::VERBOSE || (report_level == ReportLevel::FAILURES && !result.passed)) {
+        printInputs(test_vector);
+        printOutputs(result);
+    }
+    return result.passed;
+}
+
+SimulationState FModel::makeState() const {
+    SimulationState sim;
+    sim.signal_levels.assign(levelCount(), LogicLevel::FLOATING);
+    sim.event_queue.assign(circuit.components.size(), 0);
+    sim.event_queued.assign(circuit.components.size(), 0);
+    sim.register_state.assign(circuit.registers.size(), LogicLevel::LOW);
+#ifdef FMODEL_PROFILE
+    sim.profile = profile.get();
+#endif
+    return sim;
+}
+
+bool FModel::applyInputs(SimulationState& sim, const TestVector& test_vector) const {
+    // Returns whether the vector can use the levelized single pass
+    bool single_pass = circuit.levelized && propagation_mode == PropagationMode::LEVELIZED;
     for (const auto& input : test_vector.inputs) {
-        setSignalLevel(input.first, input.second);
-        std::cout << "Input " << input.first << " = " << logicLevelToString(input.second) << std::endl;
+        const int signal = findSignal(input.first);
+        if (signal >= 0) {
+            sim.signal_levels[signal] = input.second;
+            // A net the schedule treats as permanently Z is being driven
+            if (circuit.dead_signals[signal]) single_pass = false;
+        }
     }
+    return single_pass;
+}
+
+TestResult FModel::runTestVector(SimulationState& sim, const TestVector& test_vector) const {
+    // Reset circuit
+    resetCircuit(sim);
     
-    // Propagate signals through circuit generically
-    propagateSignals();
-    
-    // Check outputs
-    bool test_passed = true;
-    std::cout << "\nOutputs:" << std::endl;
+    // Apply input stimuli, then propagate signals through circuit generically
+    if (!module_instances.empty()) {
+        applyInputs(sim, test_vector);
+        evaluateHierarchy(sim, sim.signal_levels.data());
+    } else if (applyInputs(sim, test_vector)) {
+        evaluateLevelized(sim);
+    } else {
+        propagateSignals(sim);
+    }
+    FMODEL_PROFILE_CALL(sim.profile, countToggles(sim.profile_levels, sim.signal_levels));
     
-    for (const auto& expected : test_vector.expected_outputs) {
-        LogicLevel actual = getSignalLevel(expected.first);
-        LogicLevel expected_level = expected.second;
-        
-        std::cout << expected.first << ": Expected " << logicLevelToString(expected_level) 
-                  << ", Got " << logicLevelToString(actual);
-        
-        if (actual == expected_level) {
-            std::cout << " [PASS]" << std::endl;
-        } else {
-            std::cout << " [FAIL]" << std::endl;
-            test_passed = false;
+    return checkOutputs(sim, test_vector);
+}
+
+void FModel::simulateSharded() {
+    // Vectors of a circuit without stateful parts are independent: split them
+    // into contiguous shards, each simulated in a private state against the
+    // shared compiled circuit; results land in test_results in vector order.
+    const size_t count = test_vectors.size();
+    std::vector<TestResult>& results = test_results;
+
+    if (use_bit_parallel && circuit.bit_parallel) {
+        const PackedKernel kernel = selectPackedKernel(packed_backend);
+        const size_t lanes_per_pass = 64 * static_cast<size_t>(kernel.words);
+        const int batches = static_cast<int>((count + lanes_per_pass - 1) / lanes_per_pass);
+        thread_pool->parallelFor(batches, [&](int batch) {
+            SimulationState sim = makeState();
+            const size_t first = batch * lanes_per_pass;
+            runPackedBatch(sim, kernel, first, std::min(lanes_per_pass, count - first), results);
+        });
+    } else {
+        // A few shards per thread, so work stealing can even out slow shards
+        const int shards = static_cast<int>(std::min(count, static_cast<size_t>(thread_pool->size()) * 4));
+        thread_pool->parallelFor(shards, [&](int shard) {
+            SimulationState sim = makeState();
+            const size_t begin = count * shard / shards;
+            const size_t end = count * (shard + 1) / shards;
+            for (size_t i = begin; i < end; ++i) results[i] = runTestVector(sim, test_vectors[i]);
+        });
+    }
+}
+
+void FModel::simulateBitParallel() {
+    // Pack 64 vectors per word (W words per signal for the SIMD kernels) and
+    // run the levelized combinational schedule once per batch.
+    const PackedKernel kernel = selectPackedKernel(packed_backend);
+    const size_t lanes_per_pass = 64 * static_cast<size_t>(kernel.words);
+
+    for (size_t batch = 0; batch < test_vectors.size(); batch += lanes_per_pass) {
+        runPackedBatch(state, kernel, batch, std::min(lanes_per_pass, test_vectors.size() - batch), test_results);
+    }
+}
+
+void FModel::resetPackedState(SimulationState& sim, size_t words) const {
+    // Every net Z except the forced power rails
+    const size_t num_signals = signals.size();
+    sim.packed_value.assign(num_signals * words, 0);
+    sim.packed_z.assign(num_signals * words, ~uint64_t(0));
+    for (size_t w = 0; w < words; ++w) {
+        if (circuit.vcc_signal >= 0) {
+            sim.packed_value[circuit.vcc_signal * words + w] = ~uint64_t(0);
+            sim.packed_z[circuit.vcc_signal * words + w] = 0;
         }
+        if (circuit.gnd_signal >= 0) sim.packed_z[circuit.gnd_signal * words + w] = 0;
     }
-    
-    return test_passed;
 }
 
-void FModel::propagateSignals() {
-    // Iterate until stable or max iterations to propagate through multi-stage logic
-    const int max_iters = 8;
-    for (int iter = 0; iter < max_iters; ++iter) {
-        // snapshot
-        std::vector<LogicLevel> before;
-        before.reserve(signals.size());
-        for (const auto& s : signals) before.push_back(s->getLevel());
+void FModel::runPackedBatch(SimulationState& sim, const PackedKernel& kernel, size_t first, size_t lanes,
+                            std::vector<TestResult>& results) const {
+    // Simulate test_vectors[first, first + lanes) in one packed pass
+    const size_t words = static_cast<size_t>(kernel.words);
 
-        updateComponentOutputs();
+    resetPackedState(sim, words);
 
-        // Removed hardcoded adder heuristics to keep generic across designs
+    bool packable = true;
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        const uint64_t bit = uint64_t(1) << (lane % 64);
+        for (const auto& input : test_vectors[first + lane].inputs) {
+            const int idx = findSignal(input.first);
+            if (idx < 0) continue;
+            if (circuit.dead_signals[idx]) packable = false;
+            const size_t word = idx * words + lane / 64;
+            sim.packed_value[word] &= ~bit;
+            sim.packed_z[word] &= ~bit;
+            if (input.second == LogicLevel::HIGH) sim.packed_value[word] |= bit;
+            if (input.second == LogicLevel::FLOATING) sim.packed_z[word] |= bit;
+        }
+    }
+
+    if (!packable) {
+        // A vector drives a net the schedule assumes is Z: run the batch scalar
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            results[first + lane] = runTestVector(sim, test_vectors[first + lane]);
+        }
+        return;
+    }
+
+    evaluatePackedSchedule(sim, kernel);
 
-        bool changed = false;
-        for (size_t i = 0; i < signals.size(); ++i) {
-            if (signals[i]->getLevel() != before[i]) { changed = true; break; }
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        const TestVector& test_vector = test_vectors[first + lane];
+        for (const auto& expected : test_vector.expected_outputs) {
+            const int idx = findSignal(expected.first);
+            if (idx < 0) continue;
+            const size_t word = idx * words + lane / 64;
+            const unsigned shift = lane % 64;
+            if ((sim.packed_z[word] >> shift) & 1) {
+                sim.signal_levels[idx] = LogicLevel::FLOATING;
+            } else {
+                sim.signal_levels[idx] = ((sim.packed_value[word] >> shift) & 1) ? LogicLevel::HIGH : LogicLevel::LOW;
+            }
         }
-        if (!changed) break;
+        results[first + lane] = checkOutputs(sim, test_vector);
+    }
+}
+
+void FModel::printInputs(const TestVector& test_vector) const {
+    if (!clock_names.empty() && test_vector.cycles != 1) {
+        std::cout << "Clock cycles: " << test_vector.cycles << '\n';
+    }
+    for (const auto& input : test_vector.inputs) {
+        std::cout << "Input " << input.first << " = " << logicLevelToString(input.second) << '\n';
     }
 }
 
-void FModel::updateComponentOutputs() {
-    auto toComponentLevel = [](LogicLevel lvl) -> Component::LogicLevel {
-        switch (lvl) {
-            case LogicLevel::LOW: return Component::LOW;
-            case LogicLevel::HIGH: return Component::HIGH;
-            case LogicLevel::FLOATING: default: return Component::FLOATING;
+TestResult FModel::checkOutputs(const SimulationState& sim, const TestVector& test_vector) const {
+    TestResult result;
+    result.outputs.reserve(test_vector.expected_outputs.size());
+    for (const auto& expected : test_vector.expected_outputs) {
+        const int signal = findSignal(expected.first);
+        const LogicLevel actual = signal >= 0 ? sim.signal_levels[signal] : LogicLevel::FLOATING;
+        result.outputs.push_back(TestResult::Output{expected.first, expected.second, actual});
+        if (actual != expected.second) result.passed = false;
+    }
+    return result;
+}
+
+void FModel::printOutputs(const TestResult& result) const {
+    std::cout << "\nOutputs:\n";
+    
+    for (const auto& output : result.outputs) {
+        std::cout << output.signal << ": Expected " << logicLevelToString(output.expected) 
+                  << ", Got " << logicLevelToString(output.actual);
+        
+        if (output.actual == output.expected) {
+            std::cout << " [PASS]\n";
+        } else {
+            std::cout << " [FAIL]\n";
         }
-    };
-    auto toFmodelLevel = [](Component::LogicLevel lvl) -> LogicLevel {
-        switch (lvl) {
-            case Component::LOW: return LogicLevel::LOW;
-            case Component::HIGH: return LogicLevel::HIGH;
-            case Component::FLOATING: default: return LogicLevel::FLOATING;
+    }
+}
+
+bool FModel::levelize(CompiledCircuit& compiled_circuit) const {
+    // Drop gates whose output can never leave Z, and topologically sort the
+    // rest (Kahn, one wave per level).
+    CompiledCircuit& cc = compiled_circuit;
+    cc.schedule.clear();
+    cc.level_offsets.clear();
+    cc.multi_driven = false;
+    cc.levelized = false;
+
+    const int num_signals = static_cast<int>(signals.size());
+    cc.dead_signals.assign(num_signals, 0);
+
+    const int num_gates = static_cast<int>(cc.gates.size());
+    std::vector<int> reader_offsets(num_signals + 1, 0);
+    std::vector<int> driver_count(num_signals, 0);
+    for (const CompiledGate& g : cc.gates) {
+        driver_count[g.output_signal]++;
+        for (int i = g.inputs_begin; i < g.inputs_end; ++i) reader_offsets[cc.gate_input_pins[i].signal + 1]++;
+    }
+    for (int s = 0; s < num_signals; ++s) reader_offsets[s + 1] += reader_offsets[s];
+    std::vector<int> readers(reader_offsets[num_signals]);
+    {
+        std::vector<int> cursor(reader_offsets.begin(), reader_offsets.end() - 1);
+        for (int g = 0; g < num_gates; ++g) {
+            for (int i = cc.gates[g].inputs_begin; i < cc.gates[g].inputs_end; ++i) {
+                readers[cursor[cc.gate_input_pins[i].signal]++] = g;
+            }
         }
+    }
+
+    // Liveness: a combinational gate outputs Z whenever any input is Z, so a
+    // gate with an undriven pin, or fed only through such gates, is dead.
+    std::vector<char> net_live(num_signals, 0);
+    std::vector<char> gate_live(num_gates, 0);
+    std::vector<int> missing(num_gates);
+    std::vector<int> pending;
+    auto markNetLive = [&](int s) {
+        if (net_live[s]) return;
+        net_live[s] = 1;
+        pending.push_back(s);
     };
-    auto isPowerSignal = [](const std::string& name) {
-        return name == "VCC" || name == "GND";
+    auto markGateLive = [&](int g) {
+        if (gate_live[g]) return;
+        gate_live[g] = 1;
+        markNetLive(cc.gates[g].output_signal);
     };
-    auto isOutputPin = [](const std::string& part, int pin) {
-        if (part == "74HC02") {
-            return pin == 1 || pin == 4 || pin == 10 || pin == 13;
+    for (int s = 0; s < num_signals; ++s) {
+        if (driver_count[s] == 0 || signals[s]->is_input || s == cc.vcc_signal || s == cc.gnd_signal) {
+            markNetLive(s);
         }
-        if (part == "74HC04") {
-            return pin == 2 || pin == 4 || pin == 6 || pin == 8 || pin == 10 || pin == 12;
+    }
+    for (int g = 0; g < num_gates; ++g) {
+        missing[g] = cc.gates[g].inputs_end - cc.gates[g].inputs_begin;
+        if (cc.gates[g].op == GateOp::DFF) markGateLive(g);
+    }
+    while (!pending.empty()) {
+        int s = pending.back();
+        pending.pop_back();
+        for (int r = reader_offsets[s]; r < reader_offsets[s + 1]; ++r) {
+            int g = readers[r];
+            if (--missing[g] == 0) markGateLive(g);
         }
-        if (part == "74HC74") {
-            return pin == 5 || pin == 9; // Q outputs
+    }
+    for (int s = 0; s < num_signals; ++s) cc.dead_signals[s] = !net_live[s];
+
+    // Kahn's algorithm over live gates; every pin waits on every live driver of its net
+    std::vector<int> live_drivers(num_signals, 0);
+    for (int g = 0; g < num_gates; ++g) {
+        if (gate_live[g]) live_drivers[cc.gates[g].output_signal]++;
+    }
+    std::vector<int> indegree(num_gates, 0);
+    std::vector<int> frontier;
+    int num_live = 0;
+    for (int g = 0; g < num_gates; ++g) {
+        if (!gate_live[g]) continue;
+        num_live++;
+        for (int i = cc.gates[g].inputs_begin; i < cc.gates[g].inputs_end; ++i) {
+            indegree[g] += live_drivers[cc.gate_input_pins[i].signal];
         }
-        // 74HC00/08/32/86 share outputs on 3,6,8,11
-        return pin == 3 || pin == 6 || pin == 8 || pin == 11;
-    };
+        if (indegree[g] == 0) frontier.push_back(g);
+    }
+    while (!frontier.empty()) {
+        cc.level_offsets.push_back(static_cast<int>(cc.schedule.size()));
+        std::vector<int> next;
+        for (int g : frontier) {
+            cc.schedule.push_back(g);
+            int s = cc.gates[g].output_signal;
+            for (int r = reader_offsets[s]; r < reader_offsets[s + 1]; ++r) {
+                int reader = readers[r];
+                if (gate_live[reader] && --indegree[reader] == 0) next.push_back(reader);
+            }
+        }
+        std::sort(next.begin(), next.end());
+        frontier.swap(next);
+    }
+    cc.level_offsets.push_back(static_cast<int>(cc.schedule.size()));
 
-    for (auto& compInst : components) {
-        if (!compInst->component) continue;
-        const std::string& part = compInst->part_number;
-
-        // No special-cases: treat all components by declared pin roles
-
-        // Drive inputs (generic)
-        for (const auto& pa : compInst->pin_assignments) {
-            int pinNum = std::stoi(pa.first);
-            const std::string& sig = pa.second;
-            if (isPowerSignal(sig)) continue;
-            if (isOutputPin(part, pinNum)) continue; // don't drive outputs
-            LogicLevel lvl = getSignalLevel(sig);
-            compInst->component->setPin(pinNum, toComponentLevel(lvl));
-        }
-
-        // Read outputs (generic)
-        for (const auto& pa : compInst->pin_assignments) {
-            int pinNum = std::stoi(pa.first);
-            const std::string& sig = pa.second;
-            if (isPowerSignal(sig)) continue;
-            if (!isOutputPin(part, pinNum)) continue; // only outputs
-            Component::LogicLevel out = compInst->component->getPin(pinNum);
-            if (out != Component::FLOATING) {
-                setSignalLevel(sig, toFmodelLevel(out));
+    if (static_cast<int>(cc.schedule.size()) != num_live) {
+        bool through_registers = false;
+        std::vector<std::string_view> loop_parts;
+        for (int g = 0; g < num_gates; ++g) {
+            if (!gate_live[g] || indegree[g] == 0) continue;
+            through_registers = through_registers || cc.gates[g].op == GateOp::DFF;
+            const std::string_view id = components[cc.components[cc.gates[g].component].instance]->instance_id;
+            if (std::find(loop_parts.begin(), loop_parts.end(), id) == loop_parts.end()) loop_parts.push_back(id);
+        }
+        std::cerr << (through_registers ? "Feedback loop through registers" : "Combinational loop")
+                  << " detected via";
+        for (const auto& id : loop_parts) std::cerr << " " << id;
+        std::cerr << "; using event-driven propagation" << std::endl;
+        cc.schedule.clear();
+        cc.level_offsets.clear();
+        return false;
+    }
+
+    // Group each level by gate type so evaluation runs same-op loops. Gates
+    // in one level are independent, unless several drive the same net and
+    // the last write wins; keep the original order then.
+    bool multi_driven = false;
+    for (int s = 0; s < num_signals; ++s) multi_driven = multi_driven || live_drivers[s] > 1;
+    cc.multi_driven = multi_driven;
+    if (!multi_driven) {
+        for (size_t l = 0; l + 1 < cc.level_offsets.size(); ++l) {
+            std::stable_sort(cc.schedule.begin() + cc.level_offsets[l], cc.schedule.begin() + cc.level_offsets[l + 1],
+                             [&](int x, int y) { return cc.gates[x].op < cc.gates[y].op; });
+        }
+    }
+
+    cc.levelized = true;
+    return true;
+}
+
+void FModel::buildPackedSchedule(CompiledCircuit& compiled_circuit) const {
+    // Flatten the schedule into packed gates and same-op runs; only purely
+    // combinational circuits can run many vectors per pass
+    CompiledCircuit& cc = compiled_circuit;
+    cc.packed_gates.clear();
+    cc.gate_runs.clear();
+    cc.bit_parallel = true;
+    for (size_t i = 0; i < cc.schedule.size(); ++i) {
+        const CompiledGate& gate = cc.gates[cc.schedule[i]];
+        PackedGate pg;
+        pg.op = gate.op;
+        pg.in_a = gate.in_a;
+        pg.in_b = gate.in_b;
+        pg.out = gate.output_signal;
+        cc.packed_gates.push_back(pg);
+        if (gate.op == GateOp::DFF) cc.bit_parallel = false;
+
+        const int pos = static_cast<int>(i);
+        if (cc.gate_runs.empty() || cc.gate_runs.back().op != gate.op) {
+            cc.gate_runs.push_back(GateRun{gate.op, pos, pos + 1});
+        } else {
+            cc.gate_runs.back().end = pos + 1;
+        }
+    }
+
+    // Per-level tasks for the multi-threaded engine. Gates of one level are
+    // independent when every net has a single driver; combinational runs are
+    // cut into chunks, while a level's flip-flop halves stay in one task since
+    // the two halves of a 74HC74 share a Component.
+    cc.parallel_runs.clear();
+    cc.parallel_level_offsets.clear();
+    cc.parallel = !cc.multi_driven;
+    for (size_t l = 0; l + 1 < cc.level_offsets.size(); ++l) {
+        cc.parallel_level_offsets.push_back(static_cast<int>(cc.parallel_runs.size()));
+        const size_t level_runs = cc.parallel_runs.size();
+        for (int i = cc.level_offsets[l]; i < cc.level_offsets[l + 1]; ++i) {
+            const GateOp op = cc.gates[cc.schedule[i]].op;
+            const bool extend = cc.parallel_runs.size() > level_runs && cc.parallel_runs.back().op == op &&
+                                (op == GateOp::DFF || cc.parallel_runs.back().end - cc.parallel_runs.back().begin < PARALLEL_CHUNK_GATES);
+            if (extend) {
+                cc.parallel_runs.back().end = i + 1;
+            } else {
+                cc.parallel_runs.push_back(GateRun{op, i, i + 1});
             }
         }
     }
+    cc.parallel_level_offsets.push_back(static_cast<int>(cc.parallel_runs.size()));
+}
+
+void FModel::evaluateLevelized(SimulationState& sim) const {
+    // Every live gate runs exactly once: its inputs are final by construction.
+    FMODEL_PROFILE_ADD(sim.profile, levelized_passes, 1);
+    FMODEL_PROFILE_ADD(sim.profile, gate_evaluations, circuit.packed_gates.size());
+    if (!sim.pool || !circuit.parallel) {
+        for (const GateRun& run : circuit.gate_runs) evaluateRun(sim, run);
+        return;
+    }
+    // One fork/join per level; the join is the barrier before the next level
+    for (size_t l = 0; l + 1 < circuit.parallel_level_offsets.size(); ++l) {
+        const int first = circuit.parallel_level_offsets[l];
+        sim.pool->parallelFor(circuit.parallel_level_offsets[l + 1] - first,
+                              [&](int task) { evaluateRun(sim, circuit.parallel_runs[first + task]); });
+    }
 }
 
-void FModel::resetCircuit() {
-    for (auto& signal : signals) {
-        signal->setLevel(LogicLevel::FLOATING);
+void FModel::evaluateRun(SimulationState& sim, const GateRun& run) const {
+    // Combinational runs are evaluated from the truth tables in place
+    LogicLevel* levels = sim.signal_levels.data();
+    const PackedGate* gates = circuit.packed_gates.data() + run.begin;
+    const int count = run.end - run.begin;
+    switch (run.op) {
+        case GateOp::AND:  evaluateGateRun<GateOp::AND>(gates, count, levels); break;
+        case GateOp::OR:   evaluateGateRun<GateOp::OR>(gates, count, levels); break;
+        case GateOp::NAND: evaluateGateRun<GateOp::NAND>(gates, count, levels); break;
+        case GateOp::NOR:  evaluateGateRun<GateOp::NOR>(gates, count, levels); break;
+        case GateOp::XOR:  evaluateGateRun<GateOp::XOR>(gates, count, levels); break;
+        case GateOp::NOT:  evaluateGateRun<GateOp::NOT>(gates, count, levels); break;
+        case GateOp::DFF:
+            for (int i = run.begin; i < run.end; ++i) evaluateSequentialGate(sim, circuit.gates[circuit.schedule[i]]);
+            break;
     }
+}
+
+void FModel::evaluatePackedSchedule(SimulationState& sim, const PackedKernel& kernel) const {
+    FMODEL_PROFILE_ADD(sim.profile, packed_passes, 1);
+    FMODEL_PROFILE_ADD(sim.profile, packed_gate_evaluations, circuit.packed_gates.size());
+    uint64_t* value = sim.packed_value.data();
+    uint64_t* z = sim.packed_z.data();
+    if (!sim.pool || !circuit.parallel) {
+        kernel.evaluate(circuit.packed_gates.data(), circuit.packed_gates.size(), value, z);
+        return;
+    }
+    for (size_t l = 0; l + 1 < circuit.parallel_level_offsets.size(); ++l) {
+        const int first = circuit.parallel_level_offsets[l];
+        sim.pool->parallelFor(circuit.parallel_level_offsets[l + 1] - first, [&](int task) {
+            const GateRun& run = circuit.parallel_runs[first + task];
+            kernel.evaluate(circuit.packed_gates.data() + run.begin, run.end - run.begin, value, z);
+        });
+    }
+}
+
+void FModel::evaluateSequentialGate(SimulationState& sim, const CompiledGate& gate) const {
+    FMODEL_PROFILE_CALL(sim.profile, countComponent(gate.component));
+    const LogicLevel out = evaluateGateOutput(sim, gate);
+    if (out != LogicLevel::FLOATING) {
+        sim.signal_levels[gate.output_signal] = out;
+    }
+}
+
+LogicLevel FModel::evaluateGateOutput(SimulationState& sim, const CompiledGate& gate) const {
+    // Level the cell drives for the current nets; flip-flop halves go
+    // through their part, which also updates its stored state
+    if (gate.op != GateOp::DFF) return evaluateGate(gate.op, sim.signal_levels[gate.in_a], sim.signal_levels[gate.in_b]);
+    Component* component = circuit.components[gate.component].component;
+    driveInputs(sim, component, &circuit.gate_input_pins[gate.inputs_begin], gate.inputs_end - gate.inputs_begin);
+    return toFmodelLevel(component->getPin(gate.output_pin));
+}
+
+void FModel::propagateSignals(SimulationState& sim) const {
+    // Event-driven: after a reset every net may have changed, so seed the
+    // worklist with all components in netlist order, then only re-evaluate
+    // components whose inputs changed until nothing is pending.
+    const int num_components = static_cast<int>(circuit.components.size());
+    if (num_components == 0) return;
+
+    std::fill(sim.event_queued.begin(), sim.event_queued.end(), 0);
+    sim.queue_head = 0;
+    sim.queue_size = 0;
+    for (int c = 0; c < num_components; ++c) scheduleComponent(sim, c);
+    drainEvents(sim);
+}
+
+void FModel::drainEvents(SimulationState& sim) const {
+    // Evaluate queued components until none is pending; the queue is empty
+    // again on return
+    const int num_components = static_cast<int>(circuit.components.size());
+
+    // Guard against circuits that never settle (e.g. ring oscillators)
+    const long max_evaluations = static_cast<long>(num_components) * MAX_EVALUATIONS_PER_COMPONENT;
+    long evaluations = 0;
+    while (sim.queue_size > 0) {
+        if (evaluations++ >= max_evaluations) {
+            std::cerr << "Warning: circuit did not settle after " << max_evaluations
+                      << " component evaluations (oscillation?)" << std::endl;
+            for (; sim.queue_size > 0; sim.queue_size--) {
+                sim.event_queued[sim.event_queue[sim.queue_head]] = 0;
+                sim.queue_head = (sim.queue_head + 1) % num_components;
+            }
+            break;
+        }
+        int c = sim.event_queue[sim.queue_head];
+        sim.queue_head = (sim.queue_head + 1) % num_components;
+        sim.queue_size--;
+        sim.event_queued[c] = 0;
+        evaluateComponent(sim, c);
+    }
+    // Past the limit, evaluations counts the one that was refused
+    FMODEL_PROFILE_CALL(sim.profile, countPropagation(std::min(evaluations, max_evaluations), evaluations <= max_evaluations));
+}
+
+void FModel::scheduleComponent(SimulationState& sim, int index) const {
+    // Each component is queued at most once, so a ring of size N suffices
+    if (sim.event_queued[index]) return;
+    sim.event_queued[index] = 1;
+    const int num_components = static_cast<int>(circuit.components.size());
+    sim.event_queue[(sim.queue_head + sim.queue_size) % num_components] = index;
+    sim.queue_size++;
+}
+
+void FModel::driveInputs(const SimulationState& sim, Component* component, const CompiledPin* pins, int count) const {
+    // Hand the part all of its input levels at once so it evaluates once
+    int pin_numbers[Component::NUM_PINS];
+    Component::LogicLevel levels[Component::NUM_PINS];
+    int pending = 0;
+    for (int i = 0; i < count; ++i) {
+        pin_numbers[pending] = pins[i].pin;
+        levels[pending] = toComponentLevel(sim.signal_levels[pins[i].signal]);
+        if (++pending == Component::NUM_PINS) {
+            component->setPins(pin_numbers, levels, pending);
+            pending = 0;
+        }
+    }
+    if (pending > 0) component->setPins(pin_numbers, levels, pending);
+}
+
+void FModel::evaluateComponent(SimulationState& sim, int index) const {
+    const CompiledComponent& cc = circuit.components[index];
+    FMODEL_PROFILE_CALL(sim.profile, countComponent(index));
+
+    if (!cc.sequential) {
+        // Combinational part: evaluate its cells straight from the nets, all
+        // outputs before any write, as driving the part would
+        LogicLevel outputs[PART_MAX_CELLS];
+        for (int g = cc.gates_begin; g < cc.gates_end; ++g) {
+            const CompiledGate& gate = circuit.gates[g];
+            outputs[g - cc.gates_begin] = evaluateGate(gate.op, sim.signal_levels[gate.in_a], sim.signal_levels[gate.in_b]);
+        }
+        for (int g = cc.gates_begin; g < cc.gates_end; ++g) {
+            updateNet(sim, circuit.gates[g].output_signal, outputs[g - cc.gates_begin]);
+        }
+        return;
+    }
+
+    // Drive inputs
+    if (cc.inputs_end > cc.inputs_begin) {
+        driveInputs(sim, cc.component, &circuit.input_pins[cc.inputs_begin], cc.inputs_end - cc.inputs_begin);
+    }
+
+    // Read outputs
+    for (int i = cc.outputs_begin; i < cc.outputs_end; ++i) {
+        const CompiledPin& cp = circuit.output_pins[i];
+        updateNet(sim, cp.signal, toFmodelLevel(cc.component->getPin(cp.pin)));
+    }
+}
+
+void FModel::updateNet(SimulationState& sim, int signal, LogicLevel level) const {
+    // A floating output does not drive the net; a changed net wakes its fanout
+    if (level == LogicLevel::FLOATING || sim.signal_levels[signal] == level) return;
+    sim.signal_levels[signal] = level;
+    FMODEL_PROFILE_CALL(sim.profile, countNetEvent(signal));
+    for (int f = circuit.fanout_offsets[signal]; f < circuit.fanout_offsets[signal + 1]; ++f) {
+        scheduleComponent(sim, circuit.fanout_components[f]);
+    }
+}
+
+void FModel::resetCircuit(SimulationState& sim) const {
+    sim.settled = false;
+    std::fill(sim.signal_levels.begin(), sim.signal_levels.end(), LogicLevel::FLOATING);
     // Force power rails
-    auto vcc_it = signal_map.find("VCC");
-    if (vcc_it != signal_map.end()) vcc_it->second->setLevel(LogicLevel::HIGH);
-    auto gnd_it = signal_map.find("GND");
-    if (gnd_it != signal_map.end()) gnd_it->second->setLevel(LogicLevel::LOW);
+    if (circuit.vcc_signal >= 0) sim.signal_levels[circuit.vcc_signal] = LogicLevel::HIGH;
+    if (circuit.gnd_signal >= 0) sim.signal_levels[circuit.gnd_signal] = LogicLevel::LOW;
+}
+
+void FModel::clearCircuit() {
+    module_name.clear();
+    signals.clear();
+    signal_names.clear();
+    components.clear();
+    instance_names.clear();
+    instance_components.clear();
+    module_instances.clear();
+    modules.clear();
+    hierarchy = HierarchySchedule();
+    arena.reset();
+    circuit = CompiledCircuit();
+    poked_levels.clear();
+    poked_slots.clear();
+    dead_net_poked = false;
+    pending_pokes.clear();
+    interactive_outputs.clear();
+    reported_levels.clear();
+    ThreadPool* pool = state.pool;
+    state = SimulationState();
+    state.pool = pool;
+    compiled = false;
+    simulation_ready = false;
 }
 
 bool FModel::validateCircuit() const {
+    FMODEL_PROFILE_SCOPE(profile.get(), VALIDATE);
     // Basic validation - check that all components have valid part numbers
     for (const auto& component : components) {
         if (component_factories.find(component->part_number) == component_factories.end()) {
@@ -666,6 +1715,17 @@ void FModel::printCircuitInfo() const {
     std::cout << "Module: " << module_name << std::endl;
     std::cout << "Signals: " << signals.size() << std::endl;
     std::cout << "Components: " << components.size() << std::endl;
+    if (compiled) {
+        if (!module_instances.empty()) {
+            std::cout << "Propagation: hierarchical (" << module_instances.size() << " module instances, "
+                      << hierarchy.steps.size() << " steps, " << hierarchy.level_count << " level slots)" << std::endl;
+        } else if (circuit.levelized) {
+            std::cout << "Propagation: levelized (" << circuit.schedule.size() << " gates in "
+                      << (circuit.level_offsets.size() - 1) << " levels)" << std::endl;
+        } else {
+            std::cout << "Propagation: event-driven" << std::endl;
+        }
+    }
     
     std::cout << "\nSignals:" << std::endl;
     for (const auto& signal : signals) {
@@ -677,12 +1737,18 @@ void FModel::printCircuitInfo() const {
     for (const auto& component : components) {
         std::cout << "  " << component->instance_id << " (" << component->part_number << ")" << std::endl;
     }
+    if (!module_instances.empty()) {
+        std::cout << "\nModule instances:" << std::endl;
+        for (const ModuleInstance& instance : module_instances) {
+            std::cout << "  " << instance.name << " (" << instance.module_name << ")" << std::endl;
+        }
+    }
 }
 
 void FModel::printCircuitState() const {
     std::cout << "\n=== Circuit State ===" << std::endl;
     for (const auto& signal : signals) {
-        std::cout << signal->name << " = " << logicLevelToString(signal->getLevel()) << std::endl;
+        std::cout << signal->name << " = " << logicLevelToString(state.signal_levels[signal->index]) << std::endl;
     }
 }
 
@@ -9,7 +9,10 @@
 #ifndef FMODEL_H
 #define FMODEL_H
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <memory>
@@ -17,6 +20,8 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include "arena.h"
+#include "string_table.h"
 
 // Forward declarations for component classes
 class Component;
@@ -28,6 +33,15 @@ class QuadXOR_74HC86;
 
 namespace FModel {
 
+class FModel;
+class JsonReader;
+class ThreadPool;
+class VectorFileReader;
+struct PackedKernel;
+struct TimedEngine;
+class VcdWriter;
+class Profile;
+
 /**
  * @brief Logic level enumeration
  */
@@ -37,50 +51,93 @@ enum class LogicLevel {
     FLOATING = -1
 };
 
+/**
+ * @brief How signals are propagated after a test vector is applied
+ */
+enum class PropagationMode {
+    LEVELIZED,     // single pass in level order when the circuit is acyclic, else event-driven
+    EVENT_DRIVEN   // always use the event-driven worklist
+};
+
+/**
+ * @brief How much simulate() and the loaders print
+ *
+ * Below VERBOSE, per-vector results are only buffered and printTestResults()
+ * emits them once at the end.
+ */
+enum class ReportLevel {
+    VERBOSE,    // every load step and every vector (default)
+    FAILURES,   // failing vectors and a summary
+    SUMMARY,    // pass/fail counts only
+    SILENT      // nothing on stdout; errors still go to stderr
+};
+
+/**
+ * @brief Instruction set used by the packed kernels
+ */
+enum class PackedBackend {
+    AUTO,      // widest backend the CPU supports
+    SCALAR,    // portable, 64 vectors per pass
+    AVX2,      // 256 vectors per pass
+    AVX512     // 512 vectors per pass
+};
+
 /**
  * @brief Signal class representing a wire in the circuit
+ *
+ * The live logic level is not stored here: it lives in FModel's contiguous
+ * level array at position `index`, so simulation never touches Signal objects.
  */
 class Signal {
 public:
-    std::string name;
-    LogicLevel level;
+    std::string_view name;   // interned by the owning FModel, valid while it lives
+    int index;
     bool is_input;
     bool is_output;
     bool is_internal;
     
-    Signal(const std::string& name, bool is_input = false, bool is_output = false) 
-        : name(name), level(LogicLevel::FLOATING), is_input(is_input), 
+    Signal(std::string_view name, int index, bool is_input = false, bool is_output = false) 
+        : name(name), index(index), is_input(is_input), 
           is_output(is_output), is_internal(!is_input && !is_output) {}
     
-    void setLevel(LogicLevel new_level) { level = new_level; }
-    LogicLevel getLevel() const { return level; }
-    std::string getName() const { return name; }
+    std::string getName() const { return std::string(name); }
+};
+
+/**
+ * @brief (pin name, signal index) connection of one component pin
+ */
+struct PinAssignment {
+    std::string_view pin;
+    uint32_t signal;
 };
 
 /**
  * @brief Component instance in the circuit
+ *
+ * Instances, their pin arrays and their part objects live in the owning
+ * FModel's arena and are released with it, never one by one.
  */
 class ComponentInstance {
 public:
-    std::string instance_id;
-    std::string part_number;
-    std::string package;
-    std::map<std::string, std::string> pin_assignments;
-    std::vector<std::map<std::string, std::string>> gates;
-    
-    // Component object (polymorphic)
-    std::shared_ptr<Component> component;
-    
-    ComponentInstance(const std::string& id, const std::string& part, const std::string& pkg)
-        : instance_id(id), part_number(part), package(pkg) {}
-    
-    void addPinAssignment(const std::string& pin, const std::string& signal) {
-        pin_assignments[pin] = signal;
-    }
-    
-    void addGate(const std::map<std::string, std::string>& gate) {
-        gates.push_back(gate);
-    }
+    std::string_view instance_id;   // views into the owning FModel, valid while it lives
+    std::string_view part_number;
+    std::string_view package;
+    // Sorted by pin name: the order compile() drives inputs in
+    PinAssignment* pin_assignments;
+    uint32_t pin_count;
+    uint32_t pin_capacity;
+
+    // Component object (polymorphic), owned by the arena
+    Component* component;
+
+    ComponentInstance(std::string_view id, std::string_view part, std::string_view pkg)
+        : instance_id(id), part_number(part), package(pkg), pin_assignments(nullptr), pin_count(0),
+          pin_capacity(0), component(nullptr) {}
+
+    const PinAssignment* begin() const { return pin_assignments; }
+    const PinAssignment* end() const { return pin_assignments + pin_count; }
+
+    void addPinAssignment(Arena& arena, std::string_view pin, uint32_t signal);
 };
 
 /**
@@ -91,6 +148,9 @@ public:
     std::map<std::string, LogicLevel> inputs;
     std::map<std::string, LogicLevel> expected_outputs;
     std::string description;
+    // Clock cycles to run before the outputs are checked (cycle-based
+    // simulation only, see FModel::addClock())
+    uint64_t cycles = 1;
     
     TestVector(const std::string& desc = "") : description(desc) {}
     
@@ -103,23 +163,417 @@ public:
     }
 };
 
+/**
+ * @brief Outcome of one test vector: the level seen on every checked output
+ */
+struct TestResult {
+    struct Output {
+        std::string signal;
+        LogicLevel expected;
+        LogicLevel actual;
+    };
+    std::vector<Output> outputs;
+    bool passed = true;
+};
+
+/**
+ * @brief Primary output that changed in an FModel::settle()
+ */
+struct OutputChange {
+    std::string signal;
+    LogicLevel previous;
+    LogicLevel level;
+};
+
+/**
+ * @brief Pattern source for FModel::checkStimulus()
+ */
+enum class StimulusMode {
+    EXHAUSTIVE,   // every combination of the primary inputs
+    RANDOM        // StimulusOptions::count seeded pseudo-random vectors
+};
+
+struct StimulusOptions {
+    StimulusMode mode = StimulusMode::EXHAUSTIVE;
+    uint64_t count = 0;               // RANDOM only
+    uint64_t seed = 1;                // RANDOM only
+    size_t max_counterexamples = 10;  // mismatching vectors kept in the report
+};
+
+/**
+ * @brief Outcome of a stimulus check; each counterexample holds the vector
+ *        with the golden outputs as expectations, and what the circuit did
+ */
+struct StimulusReport {
+    uint64_t vectors = 0;
+    uint64_t mismatches = 0;
+    std::vector<std::pair<TestVector, TestResult>> counterexamples;
+};
+
+/**
+ * @brief Outcome of FModel::simulateFaults(): every single stuck-at fault
+ *        and the first test vector that detects it
+ */
+struct FaultReport {
+    struct Fault {
+        std::string net;
+        LogicLevel stuck_at;        // LOW or HIGH
+        uint64_t detected_by = 0;   // 1-based number of the first detecting vector, 0 if undetected
+    };
+    uint64_t vectors = 0;
+    uint64_t detected = 0;
+    std::vector<Fault> faults;
+
+    double coverage() const { return faults.empty() ? 0.0 : 100.0 * static_cast<double>(detected) / faults.size(); }
+};
+
+/**
+ * @brief Reference model: levels of getOutputNames() for levels of
+ *        getInputNames(), both in that order (outputs arrive sized, FLOATING)
+ */
+using GoldenFunction = std::function<void(const std::vector<LogicLevel>& inputs, std::vector<LogicLevel>& outputs)>;
+
+/**
+ * @brief Worst case seen on one net over a timed run (see FModel::setTimed())
+ */
+struct SignalTiming {
+    double arrival_ns = -1;     // latest settling change after a vector was applied; -1 if it never changed
+    uint64_t transitions = 0;
+    uint64_t glitches = 0;      // pulses: pairs of changes undone before the net settled
+};
+
+/**
+ * @brief One net on the critical path of a timed run, in signal flow order
+ */
+struct TimingPathStep {
+    std::string signal;
+    double arrival_ns;
+};
+
+/**
+ * @brief Timing endpoint (primary output or flip-flop D input) of a static
+ *        timing analysis, see FModel::analyzeTiming()
+ */
+struct TimingEndpoint {
+    std::string signal;
+    std::string startpoint;   // input, or clock of the flip-flop, the longest path starts at
+    double delay_ns;          // longest path delay; -1 if no path reaches it
+    bool registered;          // flip-flop D input rather than a primary output
+};
+
+/**
+ * @brief Longest path into one endpoint, startpoint first
+ */
+struct TimingPath {
+    double delay_ns = 0;
+    std::vector<TimingPathStep> steps;
+};
+
+struct StaticTimingReport {
+    std::vector<TimingEndpoint> endpoints;   // slowest first
+    std::vector<TimingPath> paths;           // paths into the slowest endpoints
+    size_t timed_gates = 0;
+    size_t loop_gates = 0;                   // on combinational loops, left untimed
+};
+
+/**
+ * @brief Component pin resolved to a signal index at compile time
+ */
+struct CompiledPin {
+    int pin;
+    int signal;
+};
+
+/**
+ * @brief Component instance resolved to index ranges into the compiled pin tables
+ */
+struct CompiledComponent {
+    Component* component;
+    int instance;        // index into FModel::components
+    int inputs_begin;    // [inputs_begin, inputs_end) in CompiledCircuit::input_pins
+    int inputs_end;
+    int outputs_begin;   // [outputs_begin, outputs_end) in CompiledCircuit::output_pins
+    int outputs_end;
+    int gates_begin;     // [gates_begin, gates_end) in CompiledCircuit::gates
+    int gates_end;
+    bool sequential;     // stateful part: evaluated through the Component interface
+};
+
+/**
+ * @brief Logic function of a gate cell
+ */
+enum class GateOp : uint8_t {
+    AND,
+    OR,
+    NAND,
+    NOR,
+    XOR,
+    NOT,
+    DFF    // 74HC74 flip-flop half (stateful, scalar only)
+};
+
+/**
+ * @brief Single logic cell of a component (one gate, or one flip-flop half)
+ */
+struct CompiledGate {
+    GateOp op;
+    int component;       // index into CompiledCircuit::components
+    int inputs_begin;    // [inputs_begin, inputs_end) in CompiledCircuit::gate_input_pins
+    int inputs_end;
+    int in_a;            // input signals of a combinational gate (in_b == in_a for NOT)
+    int in_b;
+    int output_pin;
+    int output_signal;
+};
+
+/**
+ * @brief Flip-flop half in the cycle-based schedule: its pins resolved to
+ *        signal indices (-1 when unconnected)
+ */
+struct CompiledRegister {
+    int gate;   // index into CompiledCircuit::gates
+    int d;
+    int clk;
+    int pre_n;
+    int clr_n;
+    int q;
+};
+
+/**
+ * @brief Combinational gate in the bit-parallel schedule (in_b == in_a for NOT)
+ */
+struct PackedGate {
+    GateOp op;
+    int in_a;
+    int in_b;
+    int out;
+};
+
+/**
+ * @brief Consecutive schedule entries [begin, end) sharing one GateOp
+ */
+struct GateRun {
+    GateOp op;
+    int begin;
+    int end;
+};
+
+/**
+ * @brief Flat, index-based form of the circuit used by the simulation loop
+ *
+ * Built once by FModel::compile() so that propagation works purely on integer
+ * signal indices instead of walking string-keyed maps.
+ */
+struct CompiledCircuit {
+    std::vector<CompiledComponent> components;
+    std::vector<CompiledPin> input_pins;
+    std::vector<CompiledPin> output_pins;
+    // Fanout table: components reading signal s are
+    // fanout_components[fanout_offsets[s] .. fanout_offsets[s + 1])
+    std::vector<int> fanout_offsets;
+    std::vector<int> fanout_components;
+    // Logic cells of every component: complete combinational gates and all
+    // flip-flop halves, grouped by component in output-pin order
+    std::vector<CompiledGate> gates;
+    std::vector<CompiledPin> gate_input_pins;
+    // Gate-level levelization: schedule holds gate indices in level order,
+    // level L spanning schedule[level_offsets[L] .. level_offsets[L + 1]);
+    // within a level gates are grouped by op into gate_runs
+    std::vector<int> schedule;
+    std::vector<int> level_offsets;
+    std::vector<char> dead_signals;   // nets only driven by gates that can never leave Z
+    bool multi_driven = false;        // some net has more than one live driver
+    bool sequential = false;          // has stateful parts, so vectors depend on their order
+    bool levelized = false;
+    // packed_gates[i] is schedule[i] in packed form (until optimized, see
+    // optimized_for); bit_parallel is set when the schedule is purely
+    // combinational
+    std::vector<PackedGate> packed_gates;
+    std::vector<GateRun> gate_runs;
+    bool bit_parallel = false;
+    // Multi-threaded schedule: the tasks of level L are
+    // parallel_runs[parallel_level_offsets[L] .. parallel_level_offsets[L + 1])
+    std::vector<GateRun> parallel_runs;
+    std::vector<int> parallel_level_offsets;
+    bool parallel = false;
+    // Cycle-based schedule: every flip-flop half as a register, and the
+    // combinational gates alone in topological order with register outputs
+    // as sources, grouped by op within each level into cycle_runs
+    std::vector<CompiledRegister> registers;
+    std::vector<PackedGate> cycle_gates;
+    std::vector<GateRun> cycle_runs;
+    bool cycle_levelized = false;   // no combinational loop between registers
+    // Set by FModel::optimizeCircuit(): the nets the rewritten packed_gates or
+    // cycle_gates still evaluate exactly; empty while both are unoptimized
+    std::vector<char> optimized_for;
+    int vcc_signal = -1;
+    int gnd_signal = -1;
+};
+
+/**
+ * @brief Everything a simulation pass writes
+ *
+ * The compiled circuit is read-only during simulation; all mutable state
+ * lives here, so several states can run vectors through one circuit at once
+ * (stateful parts are the exception, see CompiledCircuit::sequential).
+ */
+struct SimulationState {
+    std::vector<LogicLevel> signal_levels;   // indexed by Signal::index
+    // Event-driven scheduler state (circular worklist of component indices)
+    std::vector<int> event_queue;
+    std::vector<char> event_queued;
+    int queue_head = 0;
+    int queue_size = 0;
+    // Bit-parallel engine state: value and Z-mask planes, W words per signal
+    std::vector<uint64_t> packed_value;
+    std::vector<uint64_t> packed_z;
+    // Cycle-based engine state: the stored level of every register, kept
+    // from one test vector to the next
+    std::vector<LogicLevel> register_state;
+    // Pool for intra-circuit parallelism; null for one thread or inside a shard
+    ThreadPool* pool = nullptr;
+#ifdef FMODEL_PROFILE
+    // Counters of the run (FModel::enableProfile()), and the settled levels
+    // of the last vector on this state, for toggle counts
+    Profile* profile = nullptr;
+    std::vector<LogicLevel> profile_levels;
+#endif
+    // Levels are the settled response to the poked nets (FModel::poke());
+    // cleared by any reset
+    bool settled = false;
+};
+
+/**
+ * @brief Gate-level fanout of the levelized schedule, used by FModel::settle()
+ *        to re-evaluate only the gates downstream of a poked net
+ */
+struct IncrementalSchedule {
+    std::vector<int> gate_levels;              // level of each gate in the schedule, -1 for dead gates
+    // Gates reading signal s: readers[reader_offsets[s] .. reader_offsets[s + 1])
+    std::vector<int> reader_offsets;
+    std::vector<int> readers;
+    // Gates driving signal s: drivers[driver_offsets[s] .. driver_offsets[s + 1])
+    std::vector<int> driver_offsets;
+    std::vector<int> drivers;
+    std::vector<std::vector<int>> due;         // gates to evaluate, per level
+    std::vector<char> marked;
+    std::vector<int> output_slots;             // position of each net in the reported outputs, -1 for others
+    std::vector<int> changed_outputs;          // slots written by the last pass
+};
+
+/**
+ * @brief Instance of a module template in a hierarchical netlist
+ *
+ * The template is compiled once and shared by all of its instances; an
+ * instance only owns a slice of the instantiating model's level array, at
+ * [base, base + template levels). Port nets are copied into the slice before
+ * the template runs and back out after it.
+ */
+struct ModuleInstance {
+    std::string name;
+    std::string module_name;
+    std::vector<std::pair<std::string, int>> connections;   // (port net in the module, net here), as declared
+    const FModel* module = nullptr;                         // shared template, once bound
+    std::vector<std::pair<int, int>> inputs;                // (template net, net here) read by the template
+    std::vector<std::pair<int, int>> outputs;               // (template net, net here) the template drives
+    int base = 0;
+};
+
+/**
+ * @brief Evaluation order of a model with module instances: own gates and
+ *        whole instances in topological order
+ */
+struct HierarchyStep {
+    int instance;   // index into FModel::module_instances, or -1 for gates
+    GateOp op;      // gates[begin, end) of one op; a DFF step is circuit.gates[begin]
+    int begin;
+    int end;
+};
+
+struct HierarchySchedule {
+    std::vector<HierarchyStep> steps;
+    std::vector<PackedGate> gates;   // own combinational gates in step order
+    size_t level_count = 0;          // own nets plus every instance slice
+};
+
 /**
  * @brief Main Functional Model class
  */
 class FModel {
 private:
     std::string module_name;
-    std::vector<std::shared_ptr<Signal>> signals;
-    std::vector<std::shared_ptr<ComponentInstance>> components;
-    std::map<std::string, std::shared_ptr<Signal>> signal_map;
-    std::map<std::string, std::shared_ptr<ComponentInstance>> component_map;
-    
-    // Component factory functions
-    std::map<std::string, std::function<std::shared_ptr<Component>()>> component_factories;
+    // Owns every Signal, ComponentInstance, pin array and part object, so
+    // loading fills a few large blocks and clearCircuit() frees them at once
+    Arena arena;
+    std::vector<Signal*> signals;
+    std::vector<ComponentInstance*> components;
+    StringTable signal_names;     // net name -> ID, which is also the Signal::index
+    StringTable instance_names;   // instance ID -> index into instance_components
+    std::vector<int> instance_components;   // latest component added under each instance ID
+
+    // Component factory functions; the key is the part number instances view
+    std::map<std::string, Component* (*)(Arena&), std::less<>> component_factories;
     
     // Simulation state
     bool simulation_ready;
     std::vector<TestVector> test_vectors;
+    std::vector<TestResult> test_results;   // test_results[i] is the outcome of test_vectors[i]
+    size_t last_vector_count = 0;   // vectors the last simulate() ran, streamed batches included
+    size_t last_failed_count = 0;
+    // Packed vector file simulated in batches through test_vectors; null
+    // when the vectors are held in memory
+    std::unique_ptr<VectorFileReader> vector_stream;
+    size_t vector_batch_size;
+    ReportLevel report_level;
+    
+    // Compiled circuit and the live simulation state
+    bool compiled;
+    PropagationMode propagation_mode;
+    bool use_bit_parallel;
+    PackedBackend packed_backend;
+    bool shard_vectors;
+    bool timed_mode;
+    bool optimize_gates;
+    std::string cache_dir;   // compiled-circuit cache; empty disables it
+    // Named clocks select cycle-based simulation; register_clocks[r] is the
+    // position in clock_signals of the net clocking register r, or -1
+    std::vector<std::string> clock_names;
+    std::vector<int> clock_signals;
+    std::vector<int> register_clocks;
+    // Timed simulation: engine of the current run, and what the last run saw
+    std::unique_ptr<TimedEngine> timed_engine;
+    std::vector<SignalTiming> signal_timing;
+    std::vector<TimingPathStep> critical_path;
+    // Waveform of the next simulate(): nets matching any glob pattern (all
+    // when there are none) go to waveform_path; waveform is the open trace
+    std::string waveform_path;
+    std::vector<std::string> waveform_patterns;
+    std::unique_ptr<VcdWriter> waveform;
+    // Incremental simulation: every net driven through poke() with its
+    // level, pokes not yet settled, and the output levels last reported
+    std::vector<std::pair<int, LogicLevel>> poked_levels;
+    std::vector<int> poked_slots;   // position of each net in poked_levels, -1 if never poked
+    bool dead_net_poked = false;    // a poked net is one the levelized schedule treats as Z
+    std::vector<std::pair<int, LogicLevel>> pending_pokes;
+    std::vector<int> interactive_outputs;
+    std::vector<LogicLevel> reported_levels;
+    std::vector<OutputChange> output_changes;
+    IncrementalSchedule incremental;
+    // Hierarchical netlists: this model's module instances and their order;
+    // the top-level model also owns every module template
+    std::vector<ModuleInstance> module_instances;
+    std::vector<std::unique_ptr<FModel>> modules;
+    HierarchySchedule hierarchy;
+    CompiledCircuit circuit;
+    SimulationState state;
+    std::unique_ptr<ThreadPool> thread_pool;   // null when running on one thread
+    std::unique_ptr<Profile> profile;          // null unless enableProfile() was called
+    
+    static constexpr int MAX_EVALUATIONS_PER_COMPONENT = 64;
+    static constexpr int PARALLEL_CHUNK_GATES = 1024;
+    static constexpr size_t DEFAULT_VECTOR_BATCH = 4096;
+    static constexpr size_t MAX_EXHAUSTIVE_INPUTS = 32;
+    static constexpr size_t MAX_CLOCKS = 64;
     
 public:
     FModel();
@@ -127,45 +581,225 @@ public:
     
     // Circuit construction
     bool loadFromNetlist(const std::string& netlist_file);
+    // A netlist already in memory, e.g. one --emit rendered; the name picks
+    // the loader (.net or JSON) and keys the circuit cache as a path would
+    bool loadFromNetlistData(const std::string& netlist_name, std::string_view content);
     bool addComponent(const std::string& instance_id, const std::string& part_number, 
                      const std::string& package = "DIP-14");
     bool connectSignal(const std::string& instance_id, const std::string& pin, 
                       const std::string& signal_name);
+    bool compile();
     
     // Signal management
-    std::shared_ptr<Signal> getSignal(const std::string& name);
-    std::shared_ptr<Signal> createSignal(const std::string& name, bool is_input = false, 
-                                        bool is_output = false);
+    Signal* getSignal(const std::string& name);
+    Signal* createSignal(std::string_view name, bool is_input = false, bool is_output = false);
     void setSignalLevel(const std::string& signal_name, LogicLevel level);
     LogicLevel getSignalLevel(const std::string& signal_name) const;
     
     // Stimuli management
     bool loadTestVectors(const std::string& test_file);
     void addTestVector(const TestVector& test_vector);
+    void addTestVector(TestVector&& test_vector);
     void clearTestVectors();
+    bool writeVectorFile(const std::string& path) const;
+    void setVectorBatchSize(size_t size) { vector_batch_size = size > 0 ? size : DEFAULT_VECTOR_BATCH; }
     
     // Simulation
+    void setPropagationMode(PropagationMode mode) { propagation_mode = mode; }
+    void setBitParallel(bool enabled, PackedBackend backend = PackedBackend::AUTO) {
+        use_bit_parallel = enabled;
+        packed_backend = backend;
+    }
+    void setThreads(int num_threads);
+    int getThreads() const;
+    void setVectorSharding(bool enabled) { shard_vectors = enabled; }
+    void setReportLevel(ReportLevel level) { report_level = level; }
+    void setCacheDirectory(const std::string& dir) { cache_dir = dir; }
+    // In-memory compiled circuits (circuit_cache.cpp), for loading one netlist
+    // into many models: exportCircuit() fails for a hierarchical netlist,
+    // importCircuit() needs an empty model and leaves it ready to simulate
+    bool exportCircuit(std::string& image) const;
+    bool importCircuit(std::string_view image);
+    // Gate optimization (optimize.cpp): simulate() and the stimulus checks
+    // first remove double inversions, merge duplicate gates and drop gates
+    // no checked net depends on; only the nets they drive or check, and the
+    // primary inputs and outputs, keep their levels
+    void setOptimize(bool enabled) { optimize_gates = enabled; }
+    ReportLevel getReportLevel() const { return report_level; }
+    // Profiling (profile.h): in builds with FMODEL_PROFILE (make PROFILE=1),
+    // enableProfile() times every phase and counts engine passes, gate and
+    // component evaluations and net toggles from then on; writeProfile()
+    // dumps them as JSON ("-" for stdout). Both fail in other builds.
+    bool enableProfile();
+    bool writeProfile(const std::string& path) const;
+    
+    // Cycle-based sequential simulation (sequential.cpp): with at least one
+    // named clock, each test vector pulses every clock it does not drive
+    // TestVector::cycles times, and register state carries across vectors
+    void addClock(const std::string& signal_name);
+    void clearClocks() { clock_names.clear(); }
+    const std::vector<std::string>& getClocks() const { return clock_names; }
+    void resetRegisters();
+    
+    // Timed simulation (timed.cpp): every gate switches getPropagationDelay()
+    // after its inputs change; nets carry over from one vector to the next
+    void setTimed(bool enabled) { timed_mode = enabled; }
+    const std::vector<SignalTiming>& getSignalTiming() const { return signal_timing; }
+    const std::vector<TimingPathStep>& getCriticalPath() const { return critical_path; }
+    
+    // Static timing (sta.cpp): longest-path delay into every primary output
+    // and flip-flop input, and the max_paths slowest paths; no vectors needed
+    static constexpr size_t DEFAULT_TIMING_PATHS = 5;
+    bool analyzeTiming(size_t max_paths, StaticTimingReport& report);
+    void printStaticTimingReport(const StaticTimingReport& report) const;
+    
+    // Waveforms (vcd.cpp): simulate() records every change of the traced
+    // nets as VCD; an empty path turns tracing off
+    void setWaveform(const std::string& path, const std::vector<std::string>& patterns = {}) {
+        waveform_path = path;
+        waveform_patterns = patterns;
+    }
+    
+    // Incremental simulation (interactive.cpp): poke() drives a net of the
+    // live state, settle() propagates only from the nets poked since the last
+    // call and returns the primary outputs that changed
+    bool poke(const std::string& signal_name, LogicLevel level);
+    const std::vector<OutputChange>& settle();
+    
     bool simulate();
     bool simulateTestVector(const TestVector& test_vector);
     void printCircuitState() const;
+    
+    // Built-in stimulus (stimulus.cpp): generated vectors checked against a
+    // golden netlist or function instead of a vector file
+    std::vector<std::string> getInputNames() const;
+    std::vector<std::string> getOutputNames() const;
+    bool checkStimulus(const StimulusOptions& options, const FModel& golden, StimulusReport& report);
+    bool checkStimulus(const StimulusOptions& options, const GoldenFunction& golden, StimulusReport& report);
+    // Equivalence with a reference netlist of the same JIN_/JOUT_ nets: every
+    // input combination up to MAX_EQUIVALENCE_INPUTS inputs, options.count
+    // random vectors (DEFAULT_EQUIVALENCE_VECTORS if 0) above that
+    static constexpr size_t MAX_EQUIVALENCE_INPUTS = 24;
+    static constexpr uint64_t DEFAULT_EQUIVALENCE_VECTORS = uint64_t(1) << 20;
+    bool checkEquivalence(StimulusOptions options, const FModel& reference, StimulusReport& report);
     void printTestResults() const;
+    const std::vector<TestResult>& getTestResults() const { return test_results; }
+    // Totals of the last simulate(), also for a streamed vector file
+    size_t getVectorCount() const { return last_vector_count; }
+    size_t getFailedCount() const { return last_failed_count; }
+    
+    // Fault simulation (fault.cpp): a stuck-at-0 and a stuck-at-1 fault on
+    // every net, simulated 63 faulty machines per 64-bit word against the
+    // loaded test vectors, each fault dropped once a vector detects it;
+    // levelized combinational circuits only
+    bool simulateFaults(FaultReport& report);
     
     // Utility functions
     std::string logicLevelToString(LogicLevel level) const;
     LogicLevel stringToLogicLevel(const std::string& str) const;
     void printCircuitInfo() const;
+    // Size of the compiled circuit; gates counts every logic cell, flip-flop
+    // halves included
+    size_t getComponentCount() const { return components.size(); }
+    size_t getSignalCount() const { return signals.size(); }
+    size_t getGateCount() const { return circuit.gates.size(); }
+    bool isSequential() const { return circuit.sequential; }
     
 private:
     // Internal helper functions
     void initializeComponentFactories();
-    std::shared_ptr<Component> createComponent(const std::string& part_number);
-    bool parseNetlistFile(const std::string& filename);
-    bool parseKiCadNetlist(const std::string& content);
+    ComponentInstance* createInstance(std::string_view instance_id, std::string_view part_number,
+                                      std::string_view package);
+    ComponentInstance* findComponent(std::string_view instance_id) const;
+    bool loadNetlistData(const std::string& netlist_file, std::string_view content);
+    bool parseNetlistFile(const std::string& filename, std::string_view content);
+    bool parseJsonNetlist(std::string_view content);
+    bool parseJsonModule(JsonReader& json, bool top);
+    bool parseKiCadNetlist(std::string_view content);
+    void connectPin(ComponentInstance& instance, std::string_view pin, int signal);
+    int findSignal(std::string_view name) const;
     bool parseTestVectorFile(const std::string& filename);
-    void updateComponentOutputs();
-    void propagateSignals();
+    void buildGates(CompiledCircuit& compiled_circuit) const;
+    void buildFanout(CompiledCircuit& compiled_circuit) const;
+    bool levelize(CompiledCircuit& compiled_circuit) const;
+    void buildPackedSchedule(CompiledCircuit& compiled_circuit) const;
+    SimulationState makeState() const;
+    void resetCircuit(SimulationState& sim) const;
+    bool applyInputs(SimulationState& sim, const TestVector& test_vector) const;
+    TestResult runTestVector(SimulationState& sim, const TestVector& test_vector) const;
+    TestResult checkOutputs(const SimulationState& sim, const TestVector& test_vector) const;
+    void runPackedBatch(SimulationState& sim, const PackedKernel& kernel, size_t first, size_t lanes,
+                        std::vector<TestResult>& results) const;
+    void runTestVectors();
+    size_t reportResults(size_t first) const;
+    void printSummary(size_t count, size_t failed) const;
+    void resetPackedState(SimulationState& sim, size_t words) const;
+    void simulateBitParallel();
+    void simulateSharded();
+    void printInputs(const TestVector& test_vector) const;
+    void printOutputs(const TestResult& result) const;
+    void printTestVector(size_t index, size_t number) const;
+    void evaluateLevelized(SimulationState& sim) const;
+    void evaluateRun(SimulationState& sim, const GateRun& run) const;
+    void evaluatePackedSchedule(SimulationState& sim, const PackedKernel& kernel) const;
+    void evaluateSequentialGate(SimulationState& sim, const CompiledGate& gate) const;
+    LogicLevel evaluateGateOutput(SimulationState& sim, const CompiledGate& gate) const;
+    void driveInputs(const SimulationState& sim, Component* component, const CompiledPin* pins, int count) const;
+    void propagateSignals(SimulationState& sim) const;
+    void drainEvents(SimulationState& sim) const;
+    // Incremental simulation (interactive.cpp)
+    void buildIncrementalSchedule();
+    void settleLevelized();
+    void scheduleComponent(SimulationState& sim, int index) const;
+    void evaluateComponent(SimulationState& sim, int index) const;
+    void updateNet(SimulationState& sim, int signal, LogicLevel level) const;
     bool validateCircuit() const;
-    void resetCircuit();
+    void clearCircuit();
+    // Cycle-based simulation (sequential.cpp)
+    void buildCycleSchedule(CompiledCircuit& compiled_circuit) const;
+    bool bindClocks();
+    void simulateCycles();
+    TestResult runCycleVector(SimulationState& sim, const TestVector& test_vector) const;
+    void evaluateCycle(SimulationState& sim) const;
+    void clockRegisters(SimulationState& sim, uint64_t pulsed) const;
+    void traceClockEdge(SimulationState& sim, uint64_t pulsed) const;
+    // Timed simulation (timed.cpp)
+    void startTimedRun();
+    void simulateTimed();
+    TestResult runTimedVector(const TestVector& test_vector);
+    void printTimingReport() const;
+    // Waveforms (vcd.cpp)
+    bool startWaveform();
+    bool finishWaveform();
+    // Stimulus (stimulus.cpp)
+    // Simulates one block of golden outputs; slot < the golden_slots given to
+    // runStimulus() names the state a concurrent caller works on
+    using GoldenBlock = std::function<void(int slot, const uint64_t* inputs, size_t lanes, uint64_t* value, uint64_t* z)>;
+    std::vector<int> stimulusSignals(bool outputs) const;
+    void simulatePlanes(SimulationState& sim, const PackedKernel& kernel, const std::vector<int>& inputs,
+                        const uint64_t* input_planes, size_t lanes, const std::vector<int>& outputs,
+                        uint64_t* value, uint64_t* z) const;
+    bool runStimulus(const StimulusOptions& options, const std::string& golden_name, const GoldenBlock& golden,
+                     int golden_slots, StimulusReport& report);
+    // Fault simulation (fault.cpp)
+    void printFaultReport(const FaultReport& report) const;
+    // Hierarchical netlists (hierarchy.cpp)
+    bool bindModules(FModel& model, std::vector<char>& progress);
+    bool shareable() const;
+    size_t levelCount() const;
+    bool compileHierarchy();
+    void evaluateHierarchy(SimulationState& sim, LogicLevel* levels) const;
+    void expandInto(FModel& target, const std::string& prefix, const std::vector<int>& bound) const;
+    void flattenHierarchy();
+    bool flattenFor(const char* feature);
+    // Gate optimization (optimize.cpp)
+    void optimizeCircuit(const std::vector<int>& observed_nets, bool cycle_program);
+    bool unoptimize();
+    std::vector<int> vectorNets() const;
+    // Compiled-circuit cache (circuit_cache.cpp)
+    std::string serializeCircuit(uint64_t key) const;
+    bool writeCircuitCache(const std::string& path, uint64_t key) const;
+    bool readCircuitCache(std::string_view data, uint64_t key);
 };
 
 } // namespace FModel
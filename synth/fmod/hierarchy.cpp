@@ -0,0 +1,300 @@
+/**
+ * @file hierarchy.cpp
+ * @brief Hierarchical netlists: module templates shared by their instances
+ *
+ * Every module of a --hierarchical netlist is loaded and compiled once, as
+ * an FModel of its own. A combinational, levelized module is then shared:
+ * each instance is only a slice of the instantiating model's level array,
+ * holding the module's nets for that instance, and the module's gate runs
+ * are evaluated over the slice. The instantiating model orders its own
+ * gates and its instances topologically, copying port nets into a slice
+ * before the instance runs and back out after, so memory and compile time
+ * follow the unique logic rather than the instance count.
+ *
+ * Modules that cannot be shared (flip-flops, whose parts hold state, loops
+ * or nets with several drivers) are expanded where they are instantiated,
+ * with nets and parts named instance_name as the generator's flattener
+ * names them. Engines that need every net of the design (timed, cycle-based,
+ * bit-parallel, waveforms, static timing, poke/settle) expand the whole
+ * hierarchy first.
+ */
+
+#include "fmodel.h"
+#include "part_descriptors.h"
+#include <iostream>
+
+namespace FModel {
+
+namespace {
+
+void evaluateGates(GateOp op, const PackedGate* gates, int count, LogicLevel* levels) {
+    switch (op) {
+        case GateOp::AND:  evaluateGateRun<GateOp::AND>(gates, count, levels); break;
+        case GateOp::OR:   evaluateGateRun<GateOp::OR>(gates, count, levels); break;
+        case GateOp::NAND: evaluateGateRun<GateOp::NAND>(gates, count, levels); break;
+        case GateOp::NOR:  evaluateGateRun<GateOp::NOR>(gates, count, levels); break;
+        case GateOp::XOR:  evaluateGateRun<GateOp::XOR>(gates, count, levels); break;
+        case GateOp::NOT:  evaluateGateRun<GateOp::NOT>(gates, count, levels); break;
+        case GateOp::DFF:  break;
+    }
+}
+
+} // namespace
+
+size_t FModel::levelCount() const {
+    return module_instances.empty() ? signals.size() : hierarchy.level_count;
+}
+
+bool FModel::bindModules(FModel& model, std::vector<char>& progress) {
+    // Depth first, so each template is compiled before its first instance
+    // decides whether it can be shared; progress is 1 while a module is
+    // being bound and 2 once it is compiled
+    std::vector<ModuleInstance> declared;
+    declared.swap(model.module_instances);
+    for (ModuleInstance& instance : declared) {
+        int index = -1;
+        for (size_t m = 0; m < modules.size() && index < 0; ++m) {
+            if (modules[m]->module_name == instance.module_name) index = static_cast<int>(m);
+        }
+        if (index < 0) {
+            std::cerr << "Warning: unknown module " << instance.module_name << " (instance " << instance.name
+                      << ") skipped" << std::endl;
+            continue;
+        }
+        FModel& module = *modules[index];
+        if (progress[index] == 1) {
+            std::cerr << "Module " << module.module_name << " instantiates itself" << std::endl;
+            return false;
+        }
+        if (progress[index] == 0) {
+            progress[index] = 1;
+            if (!bindModules(module, progress)) return false;
+            module.simulation_ready = module.validateCircuit() && module.compile();
+            if (!module.simulation_ready) {
+                std::cerr << "Module " << module.module_name << " failed to compile" << std::endl;
+                return false;
+            }
+            progress[index] = 2;
+        }
+        instance.module = &module;
+
+        if (!module.shareable()) {
+            std::vector<int> bound(module.signals.size(), -1);
+            for (const auto& port : instance.connections) {
+                const int local = module.findSignal(port.first);
+                if (local >= 0) bound[local] = port.second;
+            }
+            module.expandInto(model, instance.name, bound);
+            continue;
+        }
+        // Ports the template drives are copied out, all others in; a port
+        // the module never mentions stays unconnected, as when flattened
+        std::vector<char> driven(module.signals.size(), 0);
+        for (const CompiledGate& gate : module.circuit.gates) driven[gate.output_signal] = 1;
+        for (const ModuleInstance& inner : module.module_instances) {
+            for (const auto& port : inner.outputs) driven[port.second] = 1;
+        }
+        for (const auto& port : instance.connections) {
+            const int local = module.findSignal(port.first);
+            if (local < 0) continue;
+            (driven[local] ? instance.outputs : instance.inputs).emplace_back(local, port.second);
+        }
+        model.module_instances.push_back(std::move(instance));
+    }
+    model.compiled = false;
+    return true;
+}
+
+bool FModel::shareable() const {
+    // Instances share everything but their nets: stateful parts, loops and
+    // nets with several drivers need the logic copied per instance
+    if (!compiled || circuit.sequential) return false;
+    return !module_instances.empty() || (circuit.levelized && !circuit.multi_driven);
+}
+
+bool FModel::compileHierarchy() {
+    // Units are the own gates, then the instances; Kahn's algorithm over
+    // them, with every unit waiting on every driver of the nets it reads
+    const int num_signals = static_cast<int>(signals.size());
+    const int num_gates = static_cast<int>(circuit.gates.size());
+    const int num_units = num_gates + static_cast<int>(module_instances.size());
+
+    HierarchySchedule schedule;
+    schedule.level_count = signals.size();
+    for (ModuleInstance& instance : module_instances) {
+        instance.base = static_cast<int>(schedule.level_count);
+        schedule.level_count += instance.module->levelCount();
+    }
+
+    auto forEachRead = [&](int unit, auto&& visit) {
+        if (unit < num_gates) {
+            const CompiledGate& gate = circuit.gates[unit];
+            for (int i = gate.inputs_begin; i < gate.inputs_end; ++i) visit(circuit.gate_input_pins[i].signal);
+        } else {
+            for (const auto& port : module_instances[unit - num_gates].inputs) visit(port.second);
+        }
+    };
+    auto forEachWrite = [&](int unit, auto&& visit) {
+        if (unit < num_gates) {
+            visit(circuit.gates[unit].output_signal);
+        } else {
+            for (const auto& port : module_instances[unit - num_gates].outputs) visit(port.second);
+        }
+    };
+
+    std::vector<int> drivers(num_signals, 0);
+    for (int u = 0; u < num_units; ++u) forEachWrite(u, [&](int s) { drivers[s]++; });
+    for (int s = 0; s < num_signals; ++s) {
+        if (drivers[s] > 1) {
+            std::cerr << "Net " << signals[s]->name << " of " << module_name
+                      << " has several drivers; expanding its module instances" << std::endl;
+            return false;
+        }
+    }
+    std::vector<int> reader_offsets(num_signals + 1, 0);
+    for (int u = 0; u < num_units; ++u) forEachRead(u, [&](int s) { reader_offsets[s + 1]++; });
+    for (int s = 0; s < num_signals; ++s) reader_offsets[s + 1] += reader_offsets[s];
+    std::vector<int> readers(reader_offsets[num_signals]);
+    std::vector<int> indegree(num_units, 0);
+    {
+        std::vector<int> cursor(reader_offsets.begin(), reader_offsets.end() - 1);
+        for (int u = 0; u < num_units; ++u) {
+            forEachRead(u, [&](int s) {
+                readers[cursor[s]++] = u;
+                indegree[u] += drivers[s];
+            });
+        }
+    }
+
+    std::vector<int> frontier;
+    for (int u = 0; u < num_units; ++u) {
+        if (indegree[u] == 0) frontier.push_back(u);
+    }
+    int scheduled = 0;
+    while (!frontier.empty()) {
+        // Same-op gates of a wave form one run; instances follow
+        auto key = [&](int u) { return u < num_gates ? static_cast<int>(circuit.gates[u].op) : 256; };
+        std::stable_sort(frontier.begin(), frontier.end(), [&](int x, int y) { return key(x) < key(y); });
+        std::vector<int> next;
+        for (int u : frontier) {
+            scheduled++;
+            if (u >= num_gates) {
+                schedule.steps.push_back(HierarchyStep{u - num_gates, GateOp::DFF, 0, 0});
+            } else if (circuit.gates[u].op == GateOp::DFF) {
+                schedule.steps.push_back(HierarchyStep{-1, GateOp::DFF, u, u + 1});
+            } else {
+                const CompiledGate& gate = circuit.gates[u];
+                const int at = static_cast<int>(schedule.gates.size());
+                schedule.gates.push_back(PackedGate{gate.op, gate.in_a, gate.in_b, gate.output_signal});
+                HierarchyStep* last = schedule.steps.empty() ? nullptr : &schedule.steps.back();
+                // Runs evaluate in order, so a run may also span waves
+                if (last && last->instance < 0 && last->op == gate.op && last->end == at) {
+                    last->end = at + 1;
+                } else {
+                    schedule.steps.push_back(HierarchyStep{-1, gate.op, at, at + 1});
+                }
+            }
+            forEachWrite(u, [&](int s) {
+                for (int r = reader_offsets[s]; r < reader_offsets[s + 1]; ++r) {
+                    if (--indegree[readers[r]] == 0) next.push_back(readers[r]);
+                }
+            });
+        }
+        frontier.swap(next);
+    }
+    if (scheduled != num_units) {
+        std::cerr << "Module instances of " << module_name << " form a loop; expanding them" << std::endl;
+        return false;
+    }
+
+    // The packed and multi-threaded schedules only cover the own gates
+    circuit.bit_parallel = false;
+    circuit.parallel = false;
+    hierarchy = std::move(schedule);
+    return true;
+}
+
+void FModel::evaluateHierarchy(SimulationState& sim, LogicLevel* levels) const {
+    // levels is this model's slice: its own nets, then its instances' slices
+    if (module_instances.empty()) {
+        for (const GateRun& run : circuit.gate_runs) {
+            evaluateGates(run.op, circuit.packed_gates.data() + run.begin, run.end - run.begin, levels);
+        }
+        return;
+    }
+    for (const HierarchyStep& step : hierarchy.steps) {
+        if (step.instance >= 0) {
+            const ModuleInstance& instance = module_instances[step.instance];
+            LogicLevel* slice = levels + instance.base;
+            for (const auto& port : instance.inputs) slice[port.first] = levels[port.second];
+            instance.module->evaluateHierarchy(sim, slice);
+            // An output the template leaves at Z does not write, like a gate
+            for (const auto& port : instance.outputs) {
+                if (slice[port.first] != LogicLevel::FLOATING) levels[port.second] = slice[port.first];
+            }
+        } else if (step.op == GateOp::DFF) {
+            // Only the top-level model keeps flip-flops; its slice is the state
+            evaluateSequentialGate(sim, circuit.gates[step.begin]);
+        } else {
+            evaluateGates(step.op, hierarchy.gates.data() + step.begin, step.end - step.begin, levels);
+        }
+    }
+}
+
+void FModel::expandInto(FModel& target, const std::string& prefix, const std::vector<int>& bound) const {
+    // bound[s] is the target net a port net connects to, or -1. Other nets
+    // become prefix_name, as the generator names inlined nets; the power
+    // rails stay global.
+    std::vector<int> nets(signals.size());
+    for (size_t s = 0; s < signals.size(); ++s) {
+        const std::string_view name = signals[s]->name;
+        if (bound[s] >= 0) {
+            nets[s] = bound[s];
+        } else if (name == "VCC" || name == "GND") {
+            nets[s] = target.createSignal(name)->index;
+        } else {
+            nets[s] = target.createSignal(prefix + "_" + std::string(name))->index;
+        }
+    }
+    for (const ComponentInstance* component : components) {
+        ComponentInstance* copy = target.createInstance(prefix + "_" + std::string(component->instance_id),
+                                                        component->part_number, component->package);
+        if (!copy) continue;
+        for (const PinAssignment& pa : *component) {
+            copy->addPinAssignment(target.arena, pa.pin, static_cast<uint32_t>(nets[pa.signal]));
+        }
+    }
+    for (const ModuleInstance& instance : module_instances) {
+        std::vector<int> inner(instance.module->signals.size(), -1);
+        for (const auto& port : instance.inputs) inner[port.first] = nets[port.second];
+        for (const auto& port : instance.outputs) inner[port.first] = nets[port.second];
+        instance.module->expandInto(target, prefix + "_" + instance.name, inner);
+    }
+    target.compiled = false;
+}
+
+void FModel::flattenHierarchy() {
+    std::vector<ModuleInstance> instances;
+    instances.swap(module_instances);
+    for (const ModuleInstance& instance : instances) {
+        std::vector<int> bound(instance.module->signals.size(), -1);
+        for (const auto& port : instance.inputs) bound[port.first] = port.second;
+        for (const auto& port : instance.outputs) bound[port.first] = port.second;
+        instance.module->expandInto(*this, instance.name, bound);
+    }
+    hierarchy = HierarchySchedule();
+    modules.clear();
+    compiled = false;
+}
+
+bool FModel::flattenFor(const char* feature) {
+    if (module_instances.empty()) return true;
+    if (report_level != ReportLevel::SILENT) {
+        std::cout << feature << " needs the flat netlist; expanding " << module_instances.size()
+                  << " module instances" << std::endl;
+    }
+    flattenHierarchy();
+    return compile();
+}
+
+} // namespace FModel
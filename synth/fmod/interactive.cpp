@@ -0,0 +1,194 @@
+/**
+ * @file interactive.cpp
+ * @brief Incremental simulation of the live state: poke() and settle()
+ *
+ * The first settle() starts from a reset board, drives every poked net and
+ * propagates through the whole circuit. After that the state is kept and
+ * each settle() only writes the nets poked since the last one:
+ *   - levelized circuits without shared nets re-evaluate the gates reading
+ *     a changed net in level order, so each gate of the fanout runs at most
+ *     once and only while levels keep changing,
+ *   - other circuits run the event-driven worklist from the poked nets.
+ * A poked net that a gate drives also re-runs that gate, so the driver
+ * wins as it does when settling from a reset. A net poked to Z, or a state
+ * another simulation has overwritten, is settled from a reset again, since
+ * a net that loses its driver keeps its last level in both engines.
+ */
+
+#include "fmodel.h"
+#include <iostream>
+
+namespace FModel {
+
+bool FModel::poke(const std::string& signal_name, LogicLevel level) {
+    if (!simulation_ready || (!compiled && !compile()) || !flattenFor("Incremental simulation") || !unoptimize()) {
+        std::cerr << "Circuit not ready for simulation!" << std::endl;
+        return false;
+    }
+    const int signal = findSignal(signal_name);
+    if (signal < 0) {
+        std::cerr << "Unknown signal: " << signal_name << std::endl;
+        return false;
+    }
+
+    if (poked_slots.size() != signals.size()) poked_slots.resize(signals.size(), -1);
+    if (poked_slots[signal] < 0) {
+        poked_slots[signal] = static_cast<int>(poked_levels.size());
+        poked_levels.emplace_back(signal, level);
+    } else {
+        poked_levels[poked_slots[signal]].second = level;
+    }
+    pending_pokes.emplace_back(signal, level);
+    dead_net_poked = dead_net_poked || circuit.dead_signals[signal];
+    return true;
+}
+
+const std::vector<OutputChange>& FModel::settle() {
+    output_changes.clear();
+    if (!simulation_ready || (!compiled && !compile()) || !flattenFor("Incremental simulation") || !unoptimize()) {
+        std::cerr << "Circuit not ready for simulation!" << std::endl;
+        return output_changes;
+    }
+
+    bool from_reset = !state.settled;
+    for (const auto& pending : pending_pokes) from_reset = from_reset || pending.second == LogicLevel::FLOATING;
+    if (from_reset) {
+        // The circuit may have been recompiled since the nets were poked
+        dead_net_poked = false;
+        for (const auto& poked : poked_levels) dead_net_poked = dead_net_poked || circuit.dead_signals[poked.first];
+    }
+    // The levelized pass is valid as long as no poked net is one the
+    // schedule treats as permanently Z
+    const bool single_pass = circuit.levelized && !circuit.multi_driven &&
+                             propagation_mode == PropagationMode::LEVELIZED && !dead_net_poked;
+
+    if (from_reset) {
+        resetCircuit(state);
+        for (const auto& poked : poked_levels) state.signal_levels[poked.first] = poked.second;
+        if (single_pass) {
+            evaluateLevelized(state);
+        } else {
+            propagateSignals(state);
+        }
+        interactive_outputs = stimulusSignals(true);
+        if (reported_levels.size() != interactive_outputs.size()) {
+            reported_levels.assign(interactive_outputs.size(), LogicLevel::FLOATING);
+        }
+        buildIncrementalSchedule();
+    }
+
+    std::vector<int>& changed = incremental.changed_outputs;
+    changed.clear();
+    if (!from_reset && single_pass) {
+        // The pass lists the outputs it wrote
+        settleLevelized();
+    } else {
+        if (!from_reset) {
+            for (const auto& pending : pending_pokes) {
+                updateNet(state, pending.first, pending.second);
+                for (int d = incremental.driver_offsets[pending.first]; d < incremental.driver_offsets[pending.first + 1]; ++d) {
+                    scheduleComponent(state, circuit.gates[incremental.drivers[d]].component);
+                }
+            }
+            drainEvents(state);
+        }
+        for (size_t i = 0; i < interactive_outputs.size(); ++i) changed.push_back(static_cast<int>(i));
+    }
+    pending_pokes.clear();
+    state.settled = true;
+
+    std::sort(changed.begin(), changed.end());
+    for (int i : changed) {
+        const LogicLevel level = state.signal_levels[interactive_outputs[i]];
+        if (level == reported_levels[i]) continue;
+        output_changes.push_back(OutputChange{signals[interactive_outputs[i]]->getName(), reported_levels[i], level});
+        reported_levels[i] = level;
+    }
+    return output_changes;
+}
+
+void FModel::buildIncrementalSchedule() {
+    // Rebuilt with every settle from a reset, so it always matches the circuit
+    IncrementalSchedule& inc = incremental;
+    const int num_signals = static_cast<int>(signals.size());
+    const int num_gates = static_cast<int>(circuit.gates.size());
+    const int num_levels = circuit.level_offsets.empty() ? 0 : static_cast<int>(circuit.level_offsets.size()) - 1;
+
+    inc.gate_levels.assign(num_gates, -1);
+    for (int l = 0; l < num_levels; ++l) {
+        for (int i = circuit.level_offsets[l]; i < circuit.level_offsets[l + 1]; ++i) {
+            inc.gate_levels[circuit.schedule[i]] = l;
+        }
+    }
+    inc.reader_offsets.assign(num_signals + 1, 0);
+    inc.driver_offsets.assign(num_signals + 1, 0);
+    for (int g = 0; g < num_gates; ++g) {
+        // Drivers include dead gates: the event-driven engine still runs them
+        inc.driver_offsets[circuit.gates[g].output_signal + 1]++;
+        if (inc.gate_levels[g] < 0) continue;
+        for (int i = circuit.gates[g].inputs_begin; i < circuit.gates[g].inputs_end; ++i) {
+            inc.reader_offsets[circuit.gate_input_pins[i].signal + 1]++;
+        }
+    }
+    for (int s = 0; s < num_signals; ++s) {
+        inc.reader_offsets[s + 1] += inc.reader_offsets[s];
+        inc.driver_offsets[s + 1] += inc.driver_offsets[s];
+    }
+    inc.drivers.resize(inc.driver_offsets[num_signals]);
+    std::vector<int> driver_cursor(inc.driver_offsets.begin(), inc.driver_offsets.end() - 1);
+    for (int g = 0; g < num_gates; ++g) inc.drivers[driver_cursor[circuit.gates[g].output_signal]++] = g;
+    inc.readers.resize(inc.reader_offsets[num_signals]);
+    std::vector<int> cursor(inc.reader_offsets.begin(), inc.reader_offsets.end() - 1);
+    for (int g = 0; g < num_gates; ++g) {
+        if (inc.gate_levels[g] < 0) continue;
+        for (int i = circuit.gates[g].inputs_begin; i < circuit.gates[g].inputs_end; ++i) {
+            inc.readers[cursor[circuit.gate_input_pins[i].signal]++] = g;
+        }
+    }
+    inc.due.assign(num_levels, std::vector<int>());
+    inc.marked.assign(num_gates, 0);
+    inc.output_slots.assign(num_signals, -1);
+    for (size_t i = 0; i < interactive_outputs.size(); ++i) inc.output_slots[interactive_outputs[i]] = static_cast<int>(i);
+}
+
+void FModel::settleLevelized() {
+    IncrementalSchedule& inc = incremental;
+    LogicLevel* levels = state.signal_levels.data();
+    int lowest = static_cast<int>(inc.due.size());
+    auto queue = [&](int g) {
+        if (inc.gate_levels[g] < 0 || inc.marked[g]) return;
+        inc.marked[g] = 1;
+        inc.due[inc.gate_levels[g]].push_back(g);
+        lowest = std::min(lowest, inc.gate_levels[g]);
+    };
+    auto wake = [&](int signal) {
+        if (inc.output_slots[signal] >= 0) inc.changed_outputs.push_back(inc.output_slots[signal]);
+        for (int r = inc.reader_offsets[signal]; r < inc.reader_offsets[signal + 1]; ++r) queue(inc.readers[r]);
+    };
+
+    for (const auto& pending : pending_pokes) {
+        if (levels[pending.first] == pending.second) continue;
+        levels[pending.first] = pending.second;
+        wake(pending.first);
+        // The driver sits on a lower level than the readers, so it overwrites
+        // the poke before any reader runs
+        for (int d = inc.driver_offsets[pending.first]; d < inc.driver_offsets[pending.first + 1]; ++d) queue(inc.drivers[d]);
+    }
+    // A gate only wakes readers on later levels, so one sweep upwards
+    // evaluates every affected gate after all of its inputs
+    for (int l = lowest; l < static_cast<int>(inc.due.size()); ++l) {
+        std::vector<int>& due = inc.due[l];
+        for (size_t i = 0; i < due.size(); ++i) {
+            const int g = due[i];
+            inc.marked[g] = 0;
+            const CompiledGate& gate = circuit.gates[g];
+            const LogicLevel out = evaluateGateOutput(state, gate);
+            if (out == LogicLevel::FLOATING || levels[gate.output_signal] == out) continue;
+            levels[gate.output_signal] = out;
+            wake(gate.output_signal);
+        }
+        due.clear();
+    }
+}
+
+} // namespace FModel
@@ -0,0 +1,247 @@
+/**
+ * @file json_reader.cpp
+ * @brief Streaming pull reader for JSON files
+ */
+
+#include "json_reader.h"
+#include <charconv>
+
+namespace FModel {
+
+namespace {
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void appendUtf8(std::string& out, unsigned long cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+char JsonReader::peek() {
+    const size_t size = input.size();
+    while (pos < size) {
+        const char c = input[pos];
+        if (c == '\n') {
+            line_number++;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            return c;
+        }
+        pos++;
+    }
+    return '\0';
+}
+
+JsonReader::Token JsonReader::next() {
+    const char c = peek();
+    const size_t size = input.size();
+    if (pos >= size) return Token{TokenType::END, std::string_view()};
+
+    switch (c) {
+        case '{': return Token{TokenType::BEGIN_OBJECT, input.substr(pos++, 1)};
+        case '}': return Token{TokenType::END_OBJECT, input.substr(pos++, 1)};
+        case '[': return Token{TokenType::BEGIN_ARRAY, input.substr(pos++, 1)};
+        case ']': return Token{TokenType::END_ARRAY, input.substr(pos++, 1)};
+        case ':': return Token{TokenType::COLON, input.substr(pos++, 1)};
+        case ',': return Token{TokenType::COMMA, input.substr(pos++, 1)};
+        default: break;
+    }
+
+    if (c == '"') {
+        const size_t start = ++pos;
+        bool escaped = false;
+        while (pos < size && input[pos] != '"') {
+            const char s = input[pos];
+            if (s == '\n') return fail("newline in string");
+            if (s == '\\') {
+                escaped = true;
+                pos++;
+            }
+            pos++;
+        }
+        if (pos >= size) return fail("unterminated string");
+        const size_t end = pos++;
+        if (!escaped) return Token{TokenType::STRING, input.substr(start, end - start)};
+        if (!decodeString(start, end)) return fail("invalid escape in string");
+        return Token{TokenType::STRING, std::string_view(scratch)};
+    }
+
+    const size_t start = pos;
+    while (pos < size) {
+        const char a = input[pos];
+        if (!((a >= '0' && a <= '9') || (a >= 'a' && a <= 'z') || a == '-' || a == '+' || a == '.' || a == 'E')) break;
+        pos++;
+    }
+    const std::string_view text = input.substr(start, pos - start);
+    if (text.empty()) return fail("unexpected character");
+    if (text == "true" || text == "false" || text == "null") return Token{TokenType::LITERAL, text};
+    if (text[0] == '-' || (text[0] >= '0' && text[0] <= '9')) return Token{TokenType::NUMBER, text};
+    return fail("unexpected word");
+}
+
+bool JsonReader::decodeString(size_t start, size_t end) {
+    scratch.clear();
+    for (size_t i = start; i < end; i++) {
+        const char c = input[i];
+        if (c != '\\') {
+            scratch += c;
+            continue;
+        }
+        if (++i >= end) return false;
+        switch (input[i]) {
+            case '"':  scratch += '"'; break;
+            case '\\': scratch += '\\'; break;
+            case '/':  scratch += '/'; break;
+            case 'b':  scratch += '\b'; break;
+            case 'f':  scratch += '\f'; break;
+            case 'n':  scratch += '\n'; break;
+            case 'r':  scratch += '\r'; break;
+            case 't':  scratch += '\t'; break;
+            case 'u': {
+                unsigned long cp = 0;
+                for (int d = 0; d < 4; d++) {
+                    const int h = ++i < end ? hexDigit(input[i]) : -1;
+                    if (h < 0) return false;
+                    cp = (cp << 4) | static_cast<unsigned long>(h);
+                }
+                // A high surrogate followed by \uDC00-\uDFFF is one code point
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 6 < end && input[i + 1] == '\\' && input[i + 2] == 'u') {
+                    unsigned long low = 0;
+                    for (int d = 0; d < 4; d++) {
+                        const int h = hexDigit(input[i + 3 + d]);
+                        if (h < 0) return false;
+                        low = (low << 4) | static_cast<unsigned long>(h);
+                    }
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                appendUtf8(scratch, cp);
+                break;
+            }
+            default: return false;
+        }
+    }
+    return true;
+}
+
+bool JsonReader::expect(TokenType type, const char* message) {
+    const Token token = next();
+    if (token.type == type) return true;
+    if (token.type == TokenType::END) fail("unexpected end of file");
+    else if (token.type != TokenType::ERROR) fail(message);
+    return false;
+}
+
+bool JsonReader::forEachMember(const std::function<bool(std::string_view key)>& member) {
+    if (!expect(TokenType::BEGIN_OBJECT, "expected an object")) return false;
+    if (peek() == '}') {
+        pos++;
+        return true;
+    }
+    while (true) {
+        std::string_view key;
+        if (!readString(key)) return false;
+        if (!expect(TokenType::COLON, "expected ':' after key")) return false;
+        if (!member(key)) return false;
+
+        const Token token = next();
+        if (token.type == TokenType::END_OBJECT) return true;
+        if (token.type != TokenType::COMMA) {
+            if (token.type == TokenType::END) fail("unexpected end of file");
+            else if (token.type != TokenType::ERROR) fail("expected ',' or '}'");
+            return false;
+        }
+    }
+}
+
+bool JsonReader::forEachElement(const std::function<bool()>& element) {
+    if (!expect(TokenType::BEGIN_ARRAY, "expected an array")) return false;
+    if (peek() == ']') {
+        pos++;
+        return true;
+    }
+    while (true) {
+        if (!element()) return false;
+
+        const Token token = next();
+        if (token.type == TokenType::END_ARRAY) return true;
+        if (token.type != TokenType::COMMA) {
+            if (token.type == TokenType::END) fail("unexpected end of file");
+            else if (token.type != TokenType::ERROR) fail("expected ',' or ']'");
+            return false;
+        }
+    }
+}
+
+bool JsonReader::skipValue() {
+    const char c = peek();
+    if (c == '{') return forEachMember([this](std::string_view) { return skipValue(); });
+    if (c == '[') return forEachElement([this]() { return skipValue(); });
+
+    const Token token = next();
+    switch (token.type) {
+        case TokenType::STRING:
+        case TokenType::NUMBER:
+        case TokenType::LITERAL: return true;
+        case TokenType::END:     fail("unexpected end of file"); return false;
+        case TokenType::ERROR:   return false;
+        default:                 fail("expected a value"); return false;
+    }
+}
+
+bool JsonReader::readString(std::string_view& value) {
+    const Token token = next();
+    if (token.type != TokenType::STRING) {
+        if (token.type == TokenType::END) fail("unexpected end of file");
+        else if (token.type != TokenType::ERROR) fail("expected a string");
+        return false;
+    }
+    value = token.text;
+    return true;
+}
+
+bool JsonReader::readInteger(long& value) {
+    const Token token = next();
+    if (token.type != TokenType::NUMBER) {
+        if (token.type == TokenType::END) fail("unexpected end of file");
+        else if (token.type != TokenType::ERROR) fail("expected a number");
+        return false;
+    }
+    const char* first = token.text.data();
+    const char* last = first + token.text.size();
+    const auto result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last) {
+        fail("expected an integer");
+        return false;
+    }
+    return true;
+}
+
+JsonReader::Token JsonReader::fail(const char* message) {
+    if (!error_message) error_message = message;
+    pos = input.size();
+    return Token{TokenType::ERROR, std::string_view()};
+}
+
+} // namespace FModel
@@ -0,0 +1,85 @@
+/**
+ * @file json_reader.h
+ * @brief Streaming pull reader for JSON files (legacy JSON netlists)
+ *
+ * The document is never built in memory: callers walk it token by token and
+ * skip what they do not need. Tokens are views into the input buffer, which
+ * must outlive the reader; only strings containing escapes are decoded, into
+ * a scratch buffer that is reused by the next string.
+ */
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace FModel {
+
+class JsonReader {
+public:
+    enum class TokenType {
+        BEGIN_OBJECT,   // {
+        END_OBJECT,     // }
+        BEGIN_ARRAY,    // [
+        END_ARRAY,      // ]
+        COLON,
+        COMMA,
+        STRING,         // text excludes the quotes, escapes decoded
+        NUMBER,
+        LITERAL,        // true, false, null
+        END,
+        ERROR
+    };
+
+    struct Token {
+        TokenType type;
+        std::string_view text;
+    };
+
+    explicit JsonReader(std::string_view input) : input(input), pos(0), line_number(1), error_message(nullptr) {}
+
+    Token next();
+
+    /**
+     * @brief Consume an object and call member(key) for each member, with
+     *        the reader positioned on its value; member must consume it
+     *
+     * key is only valid until the next string is read.
+     */
+    bool forEachMember(const std::function<bool(std::string_view key)>& member);
+
+    /**
+     * @brief Consume an array and call element() for each element, which
+     *        must consume it
+     */
+    bool forEachElement(const std::function<bool()>& element);
+
+    /**
+     * @brief Consume one value of any type, including nested containers
+     */
+    bool skipValue();
+
+    bool readString(std::string_view& value);
+    bool readInteger(long& value);
+
+    int line() const { return line_number; }
+    const char* error() const { return error_message; }
+
+private:
+    Token fail(const char* message);
+    char peek();
+    bool expect(TokenType type, const char* message);
+    bool decodeString(size_t start, size_t end);
+
+    std::string_view input;
+    size_t pos;
+    int line_number;
+    const char* error_message;
+    std::string scratch;
+};
+
+} // namespace FModel
+
+#endif // JSON_READER_H
@@ -0,0 +1,542 @@
+/**
+ * @file kicad_emit.cpp
+ * @brief KiCad netlist, schematic and BOM writers for a mapped design
+ *
+ * Each writer follows its Python counterpart statement by statement, down
+ * to its quirks: e.g. the schematic places and draws the ALIAS instance like
+ * an IC, maps bus ports by their unflattened names, and the BOM counts the
+ * ALIAS instance as a part. Sorted sets of (ref, pin) nodes compare as
+ * Python strings do, i.e. bytewise.
+ */
+
+#include "kicad_emit.h"
+#include "json_reader.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+
+namespace FModel {
+
+namespace {
+
+using Node = std::pair<std::string, std::string>;   // (ref, pin)
+
+bool isPower(const std::string& net) { return net == "VCC" || net == "GND"; }
+
+// KiCadNetlistExporter._merge_signals_by_name(): first-seen order, widest
+// declaration of each name
+std::vector<MappedDesign::Port> mergePorts(const std::vector<MappedDesign::Port>& ports) {
+    std::vector<MappedDesign::Port> merged;
+    std::unordered_map<std::string, size_t> position;
+    for (const MappedDesign::Port& port : ports) {
+        auto it = position.find(port.name);
+        if (it == position.end()) {
+            position.emplace(port.name, merged.size());
+            merged.push_back(port);
+        } else if ((port.width ? port.width : 1) > (merged[it->second].width ? merged[it->second].width : 1)) {
+            merged[it->second] = port;
+        }
+    }
+    return merged;
+}
+
+const char* footprint(const std::string& package) {
+    if (package == "DIP-16") return "Package_DIP:DIP-16_W7.62mm";
+    if (package == "DIP-8") return "Package_DIP:DIP-8_W7.62mm";
+    return "Package_DIP:DIP-14_W7.62mm";
+}
+
+// Parts whose pins 1-14 are known, so the unused ones can be tied to GND
+bool hasDip14Pinout(const std::string& part_number) {
+    return part_number == "74HC08" || part_number == "74HC32" || part_number == "74HC86" ||
+           part_number == "74HC04" || part_number == "74HC74";
+}
+
+// Nets in first-use order, as the Python defaultdict keeps them
+class NetTable {
+public:
+    int get(const std::string& name) {
+        auto it = index.find(name);
+        if (it != index.end()) return it->second;
+        const int net = static_cast<int>(names.size());
+        index.emplace(name, net);
+        names.push_back(name);
+        nodes.emplace_back();
+        live.push_back(1);
+        return net;
+    }
+    int find(const std::string& name) const {
+        auto it = index.find(name);
+        return it == index.end() ? -1 : it->second;
+    }
+    void erase(int net) {
+        index.erase(names[net]);
+        live[net] = 0;
+    }
+
+    std::vector<std::string> names;
+    std::vector<std::vector<Node>> nodes;
+    std::vector<char> live;
+
+private:
+    std::unordered_map<std::string, int> index;
+};
+
+class Emitter {
+public:
+    explicit Emitter(std::string& out) : out(out) {}
+
+    Emitter& operator<<(std::string_view text) {
+        out.append(text.data(), text.size());
+        return *this;
+    }
+    Emitter& operator<<(long value) {
+        out += std::to_string(value);
+        return *this;
+    }
+
+    // Signal nets leave out the ALIAS pseudo-component; power nets do not
+    void net(int code, const std::string& name, std::vector<Node>& nodes, bool sorted, bool signal) {
+        if (sorted) {
+            std::sort(nodes.begin(), nodes.end());
+            nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+        }
+        *this << "    (net (code " << code << ") (name \"" << name << "\")\n";
+        for (const Node& node : nodes) {
+            if (signal && node.first == "ALIAS") continue;
+            *this << "      (node (ref " << node.first << ") (pin " << node.second << "))\n";
+        }
+        *this << "    )\n";
+    }
+
+private:
+    std::string& out;
+};
+
+} // namespace
+
+NetlistStamps currentStamps() {
+    NetlistStamps stamps;
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    std::tm local;
+    localtime_r(&seconds, &local);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local);
+    stamps.date = date;
+    stamps.first_tstamp = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count());
+    return stamps;
+}
+
+bool parseMappedDesign(std::string_view content, MappedDesign& design, std::string& error) {
+    design = MappedDesign();
+    JsonReader json(content);
+    bool hierarchical = false;
+
+    auto readString = [&](std::string& field) {
+        std::string_view value;
+        if (!json.readString(value)) return false;
+        field = std::string(value);
+        return true;
+    };
+    auto parsePorts = [&](std::vector<MappedDesign::Port>& ports) {
+        return json.forEachElement([&]() {
+            MappedDesign::Port port{std::string(), 1};
+            if (!json.forEachMember([&](std::string_view key) {
+                    if (key == "name") return readString(port.name);
+                    if (key == "width") return json.readInteger(port.width);
+                    return json.skipValue();
+                })) return false;
+            ports.push_back(std::move(port));
+            return true;
+        });
+    };
+    auto parseInstance = [&]() {
+        MappedDesign::IC ic;
+        if (!json.forEachMember([&](std::string_view key) {
+                if (key == "instance_id") return readString(ic.instance_id);
+                if (key == "part_number") return readString(ic.part_number);
+                if (key == "package") return readString(ic.package);
+                if (key != "pin_assignments") return json.skipValue();
+                return json.forEachMember([&](std::string_view pin) {
+                    std::string pin_name(pin);
+                    std::string net;
+                    if (!readString(net)) return false;
+                    ic.pin_assignments.emplace_back(std::move(pin_name), std::move(net));
+                    return true;
+                });
+            })) return false;
+        design.ics.push_back(std::move(ic));
+        return true;
+    };
+
+    const bool parsed = json.forEachMember([&](std::string_view key) {
+        if (key == "module_name") return readString(design.module_name);
+        if (key == "inputs") return parsePorts(design.inputs);
+        if (key == "outputs") return parsePorts(design.outputs);
+        if (key == "ic_instances") return json.forEachElement(parseInstance);
+        if (key == "module_instances" || key == "modules") hierarchical = true;
+        return json.skipValue();
+    });
+    if (!parsed) {
+        error = "netlist parse error at line " + std::to_string(json.line()) + ": " +
+                (json.error() ? json.error() : "malformed JSON");
+        return false;
+    }
+    if (hierarchical) {
+        error = "hierarchical netlist; emit from the flat --json netlist";
+        return false;
+    }
+    return true;
+}
+
+void emitKiCadNetlist(const MappedDesign& design, const NetlistStamps& stamps, std::string& out) {
+    Emitter e(out);
+    uint64_t tstamp = stamps.first_tstamp;
+    auto stampLine = [&]() {
+        char hex[24];
+        std::snprintf(hex, sizeof(hex), "%016llX", static_cast<unsigned long long>(tstamp++));
+        e << "      (sheetpath (names \"/\") (tstamps \"/\"))\n"
+          << "      (tstamp " << hex << ")\n"
+          << "    )\n";
+    };
+    auto connector = [&](const std::string& ref) {
+        e << "    (comp (ref " << ref << ")\n"
+          << "      (value Conn_01x01)\n"
+          << "      (footprint Connector_PinHeader_2.54mm:PinHeader_1x01_P2.54mm_Vertical)\n"
+          << "      (datasheet \"\")\n"
+          << "      (fields\n"
+          << "        (field (name F0) \"" << ref << "\")\n"
+          << "        (field (name F1) \"Conn_01x01\")\n"
+          << "        (field (name F2) \"DIP-1\")\n"
+          << "      )\n"
+          << "      (libsource (lib \"Connector_Generic\") (part \"Conn_01x01\"))\n";
+        stampLine();
+    };
+
+    e << "(export (version D)\n"
+      << "  (design\n"
+      << "    (source \"" << design.module_name << "\")\n"
+      << "    (date \"" << stamps.date << "\")\n"
+      << "    (tool \"Verilog to PCB Converter\")\n"
+      << "  )\n"
+      << "  (components\n";
+
+    // One-pin I/O connectors, bus bits flattened, each ref once
+    const std::vector<MappedDesign::Port> inputs = mergePorts(design.inputs);
+    const std::vector<MappedDesign::Port> outputs = mergePorts(design.outputs);
+    std::unordered_map<std::string, char> seen_refs;
+    auto connectors = [&](const std::vector<MappedDesign::Port>& ports, const char* prefix) {
+        for (const MappedDesign::Port& port : ports) {
+            for (long bit = 0; bit < (port.width > 1 ? port.width : 1); ++bit) {
+                const std::string ref = prefix + port.name + (port.width > 1 ? "_" + std::to_string(bit) : "");
+                if (seen_refs.emplace(ref, 1).second) connector(ref);
+            }
+        }
+    };
+    connectors(inputs, "JIN_");
+    connectors(outputs, "JOUT_");
+
+    size_t real_ics = 0;
+    for (const MappedDesign::IC& ic : design.ics) {
+        if (ic.part_number.rfind("74", 0) == 0) real_ics++;
+        if (ic.part_number == "ALIAS") continue;   // a net tie, not a component
+        e << "    (comp (ref " << ic.instance_id << ")\n"
+          << "      (value " << ic.part_number << ")\n"
+          << "      (footprint " << footprint(ic.package) << ")\n"
+          << "      (datasheet \"\")\n"
+          << "      (fields\n"
+          << "        (field (name F0) \"" << ic.instance_id << "\")\n"
+          << "        (field (name F1) \"" << ic.part_number << "\")\n"
+          << "        (field (name F2) \"" << ic.package << "\")\n"
+          << "      )\n"
+          << "      (libsource (lib \"74xx\") (part \"" << ic.part_number << "\"))\n";
+        stampLine();
+    }
+
+    // One 0.1uF decoupling capacitor per 74xx IC
+    for (size_t c = 1; c <= real_ics; ++c) {
+        const std::string ref = "C" + std::to_string(c);
+        e << "    (comp (ref " << ref << ")\n"
+          << "      (value 0.1uF)\n"
+          << "      (footprint Capacitor_THT:C_Disc_D5.0mm_W2.5mm_P5.00mm)\n"
+          << "      (datasheet \"\")\n"
+          << "      (fields\n"
+          << "        (field (name F0) \"" << ref << "\")\n"
+          << "        (field (name F1) \"C\")\n"
+          << "        (field (name F2) \"C_Disc_D5.0mm_W2.5mm_P5.00mm\")\n"
+          << "      )\n"
+          << "      (libsource (lib \"Device\") (part \"C\"))\n";
+        stampLine();
+    }
+    e << "  )\n"
+      << "  (nets\n";
+
+    // Signal nets: connector pins first, then IC pins in mapper order
+    NetTable nets;
+    auto connectorNets = [&](const std::vector<MappedDesign::Port>& ports, const char* prefix) {
+        for (const MappedDesign::Port& port : ports) {
+            for (long bit = 0; bit < (port.width > 1 ? port.width : 1); ++bit) {
+                const std::string net = port.width > 1 ? port.name + "_" + std::to_string(bit) : port.name;
+                nets.nodes[nets.get(net)].emplace_back(prefix + net, "1");
+            }
+        }
+    };
+    connectorNets(inputs, "JIN_");
+    connectorNets(outputs, "JOUT_");
+
+    std::vector<Node> vcc, gnd;
+    std::vector<std::pair<std::string, std::string>> alias_links;   // (destination, source)
+    for (const MappedDesign::IC& ic : design.ics) {
+        const bool alias = ic.part_number == "ALIAS";
+        for (const auto& pin : ic.pin_assignments) {
+            if (pin.second == "VCC") {
+                vcc.emplace_back(ic.instance_id, pin.first);
+            } else if (pin.second == "GND") {
+                gnd.emplace_back(ic.instance_id, pin.first);
+            } else if (!alias) {
+                nets.nodes[nets.get(pin.second)].emplace_back(ic.instance_id, pin.first);
+            }
+        }
+        if (alias) alias_links.insert(alias_links.end(), ic.pin_assignments.begin(), ic.pin_assignments.end());
+    }
+    for (size_t c = 1; c <= real_ics; ++c) {
+        // Capacitor pin 1 on VCC, pin 2 on GND
+        vcc.emplace_back("C" + std::to_string(c), "1");
+        gnd.emplace_back("C" + std::to_string(c), "2");
+    }
+
+    int code = 0;
+    if (!vcc.empty()) e.net(++code, "VCC", vcc, true, false);
+    if (!gnd.empty()) e.net(++code, "GND", gnd, true, false);
+
+    // An alias moves the source net's nodes into the destination net
+    for (const auto& link : alias_links) {
+        const int source = nets.find(link.second);
+        if (source < 0) continue;
+        const int target = nets.get(link.first);
+        if (target == source) continue;
+        const std::vector<Node>& moved = nets.nodes[source];
+        nets.nodes[target].insert(nets.nodes[target].end(), moved.begin(), moved.end());
+        nets.erase(source);
+    }
+    for (size_t n = 0; n < nets.names.size(); ++n) {
+        if (nets.live[n]) e.net(++code, nets.names[n], nets.nodes[n], true, true);
+    }
+
+    // Unused inputs of the known parts tie to ground
+    std::vector<Node> unused;
+    for (const MappedDesign::IC& ic : design.ics) {
+        if (!hasDip14Pinout(ic.part_number)) continue;
+        for (int pin = 1; pin <= 14; ++pin) {
+            if (pin == 7 || pin == 14) continue;
+            const std::string name = std::to_string(pin);
+            const bool used = std::any_of(ic.pin_assignments.begin(), ic.pin_assignments.end(),
+                                          [&](const std::pair<std::string, std::string>& p) { return p.first == name; });
+            if (!used) unused.emplace_back(ic.instance_id, name);
+        }
+    }
+    if (!unused.empty()) e.net(++code, "GND_UNUSED", unused, false, false);
+
+    e << "  )\n"
+      << ")\n";
+}
+
+void emitSchematic(const MappedDesign& design, std::string& out) {
+    Emitter e(out);
+    e << "EESchema Schematic File Version 4\n"
+         "EELAYER 30 0\n"
+         "EELAYER END\n"
+         "$Descr A4 11693 8268\n"
+         "encoding utf-8\n"
+         "Sheet 1 1\n"
+         "Title \"\"\n"
+         "Date \"\"\n"
+         "Rev \"\"\n"
+         "Comp \"\"\n"
+         "Comment1 \"\"\n"
+         "Comment2 \"\"\n"
+         "Comment3 \"\"\n"
+         "Comment4 \"\"\n"
+         "$EndDescr\n";
+
+    // Grid placement, ceil(sqrt(n)) columns
+    const size_t count = design.ics.size();
+    const long cols = static_cast<long>(std::ceil(std::sqrt(static_cast<double>(count))));
+    std::vector<std::pair<long, long>> positions(count);
+    for (size_t i = 0; i < count; ++i) {
+        positions[i] = {1000 + static_cast<long>(i) % cols * 2000, 1000 + static_cast<long>(i) / cols * 1500};
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const MappedDesign::IC& ic = design.ics[i];
+        const long x = positions[i].first, y = positions[i].second;
+        e << "$Comp\n"
+          << "L " << ic.part_number << " " << ic.instance_id << "\n"
+          << "U 1 1 5F1F1234\n"
+          << "P " << x << " " << y << "\n"
+          << "F 0 \"" << ic.instance_id << "\" H " << x << " " << y - 50 << " 50  0000 C CNN\n"
+          << "F 1 \"" << ic.part_number << "\" H " << x << " " << y + 50 << " 50  0000 C CNN\n"
+          << "F 2 \"" << ic.package << "\" H " << x << " " << y + 100 << " 50  0000 C CNN\n"
+          << "F 3 \"\" H " << x << " " << y + 150 << " 50  0000 C CNN\n"
+          << "    1    " << x << " " << y << "\n"
+          << "    1    0    0    -1\n"
+          << "$EndComp\n";
+    }
+
+    // DIP-14 pins 1-7 down the left side, 8-14 up the right
+    auto pinPosition = [&](size_t i, const std::string& pin) {
+        const long pin_num = std::strtol(pin.c_str(), nullptr, 10);
+        const long x = positions[i].first, y = positions[i].second;
+        if (pin_num <= 7) return std::make_pair(x - 100, y - 200 + (pin_num - 1) * 50);
+        return std::make_pair(x + 100, y - 200 + (14 - pin_num) * 50);
+    };
+
+    // Ports are placed by declared name, later declarations winning; an IC
+    // net sits at the first pin it is seen on
+    std::unordered_map<std::string, std::pair<long, long>> signal_positions;
+    for (size_t i = 0; i < design.inputs.size(); ++i) {
+        signal_positions[design.inputs[i].name] = {500, 1000 + static_cast<long>(i) * 200};
+    }
+    for (size_t i = 0; i < design.outputs.size(); ++i) {
+        signal_positions[design.outputs[i].name] = {5000, 1000 + static_cast<long>(i) * 200};
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const MappedDesign::IC& ic = design.ics[i];
+        for (const auto& pin : ic.pin_assignments) {
+            if (ic.part_number == "ALIAS") {
+                signal_positions.emplace(pin.first, std::make_pair(2750L, 1000L));
+                signal_positions.emplace(pin.second, std::make_pair(2800L, 1000L));
+            } else if (!isPower(pin.second)) {
+                signal_positions.emplace(pin.second, pinPosition(i, pin.first));
+            }
+        }
+    }
+
+    auto wire = [&](std::pair<long, long> from, std::pair<long, long> to) {
+        e << "Wire Wire Line\n"
+          << "    " << from.first << " " << from.second << " " << to.first << " " << to.second << "\n";
+    };
+    for (size_t i = 0; i < count; ++i) {
+        const MappedDesign::IC& ic = design.ics[i];
+        for (const auto& pin : ic.pin_assignments) {
+            if (ic.part_number == "ALIAS") {
+                wire(signal_positions[pin.first], signal_positions[pin.second]);
+                continue;
+            }
+            auto it = signal_positions.find(pin.second);
+            if (it != signal_positions.end()) wire(pinPosition(i, pin.first), it->second);
+        }
+    }
+    e << "$EndSCHEMATC\n";
+}
+
+void emitBom(const MappedDesign& design, const std::string& source, std::string& out) {
+    Emitter e(out);
+    e << "# Bill of Materials (BOM)\n"
+      << "# Generated from: " << source << "\n"
+      << "# Module: " << design.module_name << "\n\n";
+
+    // Ports by name, widest declaration, sorted
+    auto ports = [&](const std::vector<MappedDesign::Port>& declared, const char* title) {
+        std::map<std::string, long> by_name;
+        for (const MappedDesign::Port& port : declared) {
+            if (port.name.empty()) continue;
+            const long width = port.width ? port.width : 1;
+            auto it = by_name.find(port.name);
+            if (it == by_name.end() || width > it->second) by_name[port.name] = width;
+        }
+        long pins = 0;
+        for (const auto& port : by_name) pins += port.second;
+        e << "- **" << title << " (" << pins << " pins, " << static_cast<long>(by_name.size()) << " ports)**:\n";
+        for (const auto& port : by_name) {
+            if (port.second > 1) {
+                e << "  - " << port.first << "[" << port.second - 1 << ":0] (" << port.second << " pins)\n";
+            } else {
+                e << "  - " << port.first << "\n";
+            }
+        }
+    };
+    e << "## I/O Ports\n";
+    ports(design.inputs, "Inputs");
+    ports(design.outputs, "Outputs");
+    e << "\n"
+      << "## Components\n"
+      << "| Qty | Part Number | Package | Description |\n"
+      << "|-----|-------------|---------|-------------|\n";
+
+    // Every instance counts, ALIAS included; a part shows its last package
+    std::map<std::string, std::pair<long, std::string>> parts;
+    for (const MappedDesign::IC& ic : design.ics) {
+        auto& part = parts[ic.part_number];
+        part.first++;
+        part.second = ic.package;
+    }
+    double total_cost = 0.0;
+    for (const auto& part : parts) {
+        const std::string& number = part.first;
+        const char* description = number == "74HC08" ? "Quad 2-input AND gate"
+                                : number == "74HC32" ? "Quad 2-input OR gate"
+                                : number == "74HC86" ? "Quad 2-input XOR gate"
+                                : number == "74HC04" ? "Hex inverter (NOT gate)" : "Logic gate IC";
+        const double cost = number == "74HC86" ? 0.55 : number == "74HC04" ? 0.45 : 0.50;
+        total_cost += cost * static_cast<double>(part.second.first);
+        e << "| " << part.second.first << " | " << number << " | " << part.second.second << " | " << description << " |\n";
+    }
+    char cost[64];
+    std::snprintf(cost, sizeof(cost), "%.2f", total_cost);
+    const long total = static_cast<long>(design.ics.size());
+    e << "\n**Total Components:** " << total << "\n"
+      << "**Estimated Cost:** $" << cost << " USD\n"
+      << "\n## Power Supply Requirements\n"
+      << "- **Voltage:** 5V DC\n"
+      << "- **Current:** ~20mA per IC (typical)\n"
+      << "- **Total Current:** ~" << total * 20 << "mA\n"
+      << "\n## Additional Components Needed\n"
+      << "| Qty | Part | Description |\n"
+      << "|-----|------|-------------|\n"
+      << "| 1 | Power connector | 5V DC input |\n"
+      << "| 1 | PCB | Custom PCB or breadboard |\n"
+      << "| N | Headers/Connectors | For input/output connections |\n"
+      << "| N | Decoupling capacitors | 0.1µF ceramic (one per IC) |";
+}
+
+void emitDesign(const MappedDesign& design, const NetlistStamps& stamps, const std::string& source,
+                EmittedDesign& files, int threads) {
+    // The writers share nothing but the read-only design
+    auto render = [&](int file) {
+        if (file == 0) emitKiCadNetlist(design, stamps, files.netlist);
+        else if (file == 1) emitSchematic(design, files.schematic);
+        else emitBom(design, source, files.bom);
+    };
+    if (threads == 0) threads = ThreadPool::hardwareThreads();
+    if (threads == 1) {
+        for (int file = 0; file < 3; ++file) render(file);
+        return;
+    }
+    ThreadPool pool(std::min(threads, 3));
+    pool.parallelFor(3, render);
+}
+
+bool writeEmittedFile(const std::string& path, const std::string& content) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    const bool written = std::fwrite(content.data(), 1, content.size(), file) == content.size();
+    if (std::fclose(file) != 0 || !written) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace FModel
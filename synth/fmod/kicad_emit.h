@@ -0,0 +1,102 @@
+/**
+ * @file kicad_emit.h
+ * @brief Native emit stage: KiCad netlist, schematic and BOM of a mapped design
+ *
+ * Takes the IC instances GateToICMapper produced, as verilog_to_pcb_final.py
+ * --json writes them, and renders the files its Python exporters write:
+ * <module>.net (KiCadNetlistExporter), <module>_output.sch (KiCadExporter)
+ * and the BOM of generate_bom.py. Each file is rendered into one string in
+ * a single pass; nets are collected and ordered once.
+ *
+ * The schematic and the BOM match the Python output byte for byte. So does
+ * the netlist, except for what the Python exporter makes up per run: the
+ * date, the component tstamps (the clock in microseconds), the net codes
+ * (random) and the order of the GND_UNUSED nodes (a set of strings). Here
+ * they come from NetlistStamps, tstamps count up from the first one, net
+ * codes number the nets from 1, and unused pins are listed in pin order.
+ */
+
+#ifndef KICAD_EMIT_H
+#define KICAD_EMIT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace FModel {
+
+/**
+ * @brief A mapped design: ports as declared and IC instances in mapper order
+ *
+ * The ALIAS instance, if any, maps each destination net to its source net
+ * in pin_assignments, as GateToICMapper records passthrough assigns.
+ */
+struct MappedDesign {
+    struct Port {
+        std::string name;
+        long width;
+    };
+    struct IC {
+        std::string instance_id;
+        std::string part_number;
+        std::string package;
+        std::vector<std::pair<std::string, std::string>> pin_assignments;   // pin -> net, in mapper order
+    };
+
+    std::string module_name;
+    std::vector<Port> inputs;
+    std::vector<Port> outputs;
+    std::vector<IC> ics;
+};
+
+/**
+ * @brief What the Python netlist exporter takes from the clock and random
+ */
+struct NetlistStamps {
+    std::string date;          // "%Y-%m-%d %H:%M:%S"
+    uint64_t first_tstamp;     // tstamp of the first component
+};
+
+/**
+ * @brief The three rendered files of a design
+ */
+struct EmittedDesign {
+    std::string netlist;      // <module>.net
+    std::string schematic;    // <module>_output.sch
+    std::string bom;          // <module>_bom.md
+};
+
+/**
+ * @brief Stamps of now, as the Python exporter would take them
+ */
+NetlistStamps currentStamps();
+
+/**
+ * @brief Read a flat --json netlist; hierarchical netlists are refused
+ */
+bool parseMappedDesign(std::string_view json, MappedDesign& design, std::string& error);
+
+void emitKiCadNetlist(const MappedDesign& design, const NetlistStamps& stamps, std::string& out);
+void emitSchematic(const MappedDesign& design, std::string& out);
+
+/**
+ * @brief The BOM generate_bom.py writes; source is the netlist path it names
+ */
+void emitBom(const MappedDesign& design, const std::string& source, std::string& out);
+
+/**
+ * @brief Render all three files, one per thread when threads != 1 (0 = one per core)
+ */
+void emitDesign(const MappedDesign& design, const NetlistStamps& stamps, const std::string& source,
+                EmittedDesign& files, int threads = 0);
+
+/**
+ * @brief Write one rendered file with a single write
+ */
+bool writeEmittedFile(const std::string& path, const std::string& content);
+
+} // namespace FModel
+
+#endif // KICAD_EMIT_H
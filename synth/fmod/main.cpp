@@ -4,57 +4,338 @@
  */
 
 #include "fmodel.h"
+#include "kicad_emit.h"
+#include "mapped_file.h"
+#include "server.h"
 #include <iostream>
 #include <string>
 
-int main(int argc, char* argv[]) {
+static void printBanner() {
     std::cout << "=== Functional Model Framework Demo ===" << std::endl;
     std::cout << "Digital Circuit Simulation using 74xx Series Components" << std::endl;
     std::cout << "========================================================" << std::endl;
-    
+}
+
+static int runServer(int argc, char* argv[]) {
+    // --server[=SOCKET] [--workers=N]: commands on stdin, or on a Unix socket
+    std::string socket_path;
+    int workers = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--server") {
+            socket_path.clear();
+        } else if (option.rfind("--server=", 0) == 0 && option.size() > 9) {
+            socket_path = option.substr(9);
+        } else if (option.rfind("--workers=", 0) == 0) {
+            const std::string count = option.substr(10);
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Invalid worker count: " << count << std::endl;
+                return 1;
+            }
+            workers = std::stoi(count);
+        } else {
+            std::cerr << "Unknown server option: " << option << std::endl;
+            return 1;
+        }
+    }
+
+    ::FModel::SimulationServer server(workers);
+    if (socket_path.empty()) {
+        server.serve(0, 1);
+        return 0;
+    }
+    return server.listen(socket_path) ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]).rfind("--server", 0) == 0) return runServer(argc, argv);
     if (argc < 3) {
-        std::cout << "Usage: " << argv[0] << " <netlist_file(.net)> <test_vectors_file>" << std::endl;
+        printBanner();
+        std::cout << "Usage: " << argv[0] << " <netlist_file(.net)> [test_vectors_file] [options]" << std::endl;
+        std::cout << "       " << argv[0] << " --server[=SOCKET] [--workers=N]" << std::endl;
+        std::cout << "                   Serve load/run/stimulus/stats commands on stdin or a Unix socket," << std::endl;
+        std::cout << "                   running jobs on N workers (0 = one per core, default)" << std::endl;
+        std::cout << "Options:" << std::endl;
+        std::cout << "  --event-driven   Always use event-driven propagation (no levelized single pass)" << std::endl;
+        std::cout << "  --bit-parallel[=auto|scalar|avx2|avx512]" << std::endl;
+        std::cout << "                   Simulate 64/256/512 vectors per pass (combinational circuits only)" << std::endl;
+        std::cout << "  --threads=N      Evaluate each level on N threads (0 = one per core, default 1)" << std::endl;
+        std::cout << "  --shard-vectors  Split the test vectors across the threads instead (circuits without flip-flops)" << std::endl;
+        std::cout << "  --optimize       Remove double inversions, merge duplicate gates and drop unobserved ones first" << std::endl;
+        std::cout << "  --report=verbose|failures|summary|silent" << std::endl;
+        std::cout << "                   Print every vector (default), only failing vectors, only the totals, or nothing" << std::endl;
+        std::cout << "  --vector-batch=N Vectors per batch when streaming a packed (.fmv) vector file (default 4096)" << std::endl;
+        std::cout << "  --write-vectors=FILE" << std::endl;
+        std::cout << "                   Also save the loaded test vectors as a packed vector file" << std::endl;
+        std::cout << "  --cache-dir=DIR  Reuse the compiled circuit from DIR when the netlist is unchanged (written on a miss)" << std::endl;
+        std::cout << "  --vcd=FILE       Write a VCD waveform of the simulation to FILE" << std::endl;
+        std::cout << "  --vcd-signals=PATTERN[,PATTERN...]" << std::endl;
+        std::cout << "                   Only trace nets matching a glob pattern (* and ?; default all)" << std::endl;
+        std::cout << "  --faults         Report the stuck-at fault coverage of the test vectors instead of checking them" << std::endl;
+        std::cout << "  --timed          Simulate with each part's propagation delay and report arrival times and glitches" << std::endl;
+        std::cout << "  --sta[=K]        Report the longest input-to-output delays and the K slowest paths (default 5)" << std::endl;
+        std::cout << "  --clock=NAME     Simulate cycle by cycle, pulsing net NAME once per cycle (repeatable)" << std::endl;
+        std::cout << "  --exhaustive     Check every input combination against the golden netlist" << std::endl;
+        std::cout << "  --random=N       Check N seeded random vectors against the golden netlist" << std::endl;
+        std::cout << "  --seed=S         Seed for --random (default 1)" << std::endl;
+        std::cout << "  --golden=NETLIST Reference netlist for --exhaustive/--random (test vectors file then optional)" << std::endl;
+        std::cout << "  --equivalence=NETLIST" << std::endl;
+        std::cout << "                   Check equivalence with NETLIST on every core: exhaustive up to 24 inputs," << std::endl;
+        std::cout << "                   else --random=N vectors (default 1048576)" << std::endl;
+        std::cout << "  --emit=DIR       Render <module>.net, _output.sch and _bom.md from a --json netlist into DIR," << std::endl;
+        std::cout << "                   then simulate the rendered .net if vectors or checks are given" << std::endl;
+        std::cout << "  --profile=FILE   Write per-phase times and engine counters as JSON to FILE (- for stdout;" << std::endl;
+        std::cout << "                   needs a build with make PROFILE=1)" << std::endl;
         std::cout << "Example: " << argv[0] << " ../netlist/full_adder.net test_vectors/full_adder_tests.txt" << std::endl;
         return 1;
     }
     
     std::string netlist_file = argv[1];
-    std::string test_vectors_file = argv[2];
+    std::string packed_vectors_file;
+    std::string test_vectors_file;
+    std::string golden_file;
+    std::string cache_dir;
+    std::string vcd_file;
+    std::string profile_file;
+    std::string emit_dir;
+    std::vector<std::string> vcd_patterns;
+    bool use_stimulus = false;
+    bool use_sta = false;
+    bool use_faults = false;
+    bool use_equivalence = false;
+    bool threads_set = false;
+    size_t sta_paths = ::FModel::FModel::DEFAULT_TIMING_PATHS;
+    ::FModel::StimulusOptions stimulus;
     
     // Create functional model
     ::FModel::FModel model;
     
+    for (int i = 2; i < argc; ++i) {
+        std::string option = argv[i];
+        if (i == 2 && option.rfind("--", 0) != 0) {
+            test_vectors_file = option;
+        } else if (option == "--event-driven") {
+            model.setPropagationMode(::FModel::PropagationMode::EVENT_DRIVEN);
+        } else if (option == "--bit-parallel" || option == "--bit-parallel=auto") {
+            model.setBitParallel(true);
+        } else if (option == "--bit-parallel=scalar") {
+            model.setBitParallel(true, ::FModel::PackedBackend::SCALAR);
+        } else if (option == "--bit-parallel=avx2") {
+            model.setBitParallel(true, ::FModel::PackedBackend::AVX2);
+        } else if (option == "--bit-parallel=avx512") {
+            model.setBitParallel(true, ::FModel::PackedBackend::AVX512);
+        } else if (option == "--optimize") {
+            model.setOptimize(true);
+        } else if (option == "--report=verbose") {
+            model.setReportLevel(::FModel::ReportLevel::VERBOSE);
+        } else if (option == "--report=failures") {
+            model.setReportLevel(::FModel::ReportLevel::FAILURES);
+        } else if (option == "--report=summary") {
+            model.setReportLevel(::FModel::ReportLevel::SUMMARY);
+        } else if (option == "--report=silent") {
+            model.setReportLevel(::FModel::ReportLevel::SILENT);
+        } else if (option == "--shard-vectors") {
+            model.setVectorSharding(true);
+        } else if (option.rfind("--cache-dir=", 0) == 0 && option.size() > 12) {
+            cache_dir = option.substr(12);
+            model.setCacheDirectory(cache_dir);
+        } else if (option.rfind("--write-vectors=", 0) == 0 && option.size() > 16) {
+            packed_vectors_file = option.substr(16);
+        } else if (option.rfind("--vector-batch=", 0) == 0) {
+            const std::string count = option.substr(15);
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Invalid vector batch size: " << count << std::endl;
+                return 1;
+            }
+            model.setVectorBatchSize(std::stoul(count));
+        } else if (option.rfind("--threads=", 0) == 0) {
+            const std::string count = option.substr(10);
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Invalid thread count: " << count << std::endl;
+                return 1;
+            }
+            model.setThreads(std::stoi(count));
+            threads_set = true;
+        } else if (option.rfind("--vcd=", 0) == 0 && option.size() > 6) {
+            vcd_file = option.substr(6);
+        } else if (option.rfind("--vcd-signals=", 0) == 0 && option.size() > 14) {
+            std::stringstream patterns(option.substr(14));
+            std::string pattern;
+            while (std::getline(patterns, pattern, ',')) {
+                if (!pattern.empty()) vcd_patterns.push_back(pattern);
+            }
+        } else if (option == "--faults") {
+            use_faults = true;
+        } else if (option == "--timed") {
+            model.setTimed(true);
+        } else if (option == "--sta") {
+            use_sta = true;
+        } else if (option.rfind("--sta=", 0) == 0) {
+            const std::string count = option.substr(6);
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Invalid path count: " << count << std::endl;
+                return 1;
+            }
+            use_sta = true;
+            sta_paths = std::stoul(count);
+        } else if (option.rfind("--clock=", 0) == 0 && option.size() > 8) {
+            model.addClock(option.substr(8));
+        } else if (option == "--exhaustive") {
+            use_stimulus = true;
+            stimulus.mode = ::FModel::StimulusMode::EXHAUSTIVE;
+        } else if (option.rfind("--random=", 0) == 0) {
+            const std::string count = option.substr(9);
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Invalid random vector count: " << count << std::endl;
+                return 1;
+            }
+            use_stimulus = true;
+            stimulus.mode = ::FModel::StimulusMode::RANDOM;
+            stimulus.count = std::stoull(count);
+        } else if (option.rfind("--seed=", 0) == 0) {
+            const std::string seed = option.substr(7);
+            if (seed.empty() || seed.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Invalid seed: " << seed << std::endl;
+                return 1;
+            }
+            stimulus.seed = std::stoull(seed);
+        } else if (option.rfind("--golden=", 0) == 0 && option.size() > 9) {
+            golden_file = option.substr(9);
+        } else if (option.rfind("--equivalence=", 0) == 0 && option.size() > 14) {
+            golden_file = option.substr(14);
+            use_stimulus = true;
+            use_equivalence = true;
+        } else if (option.rfind("--emit=", 0) == 0 && option.size() > 7) {
+            emit_dir = option.substr(7);
+        } else if (option.rfind("--profile=", 0) == 0 && option.size() > 10) {
+            profile_file = option.substr(10);
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+    
+    if (use_equivalence && !threads_set) model.setThreads(0);
+    if (!vcd_patterns.empty() && vcd_file.empty()) {
+        std::cerr << "--vcd-signals needs --vcd=FILE" << std::endl;
+        return 1;
+    }
+    model.setWaveform(vcd_file, vcd_patterns);
+    if (!profile_file.empty() && !model.enableProfile()) return 1;
+    
+    if (use_stimulus && golden_file.empty()) {
+        std::cerr << "--exhaustive and --random need a --golden=NETLIST to check against" << std::endl;
+        return 1;
+    }
+    // --emit renders the KiCad files of a mapped design; with nothing to
+    // simulate that is all, else the rendered netlist is loaded from memory
+    std::string emitted_netlist;
+    if (!emit_dir.empty()) {
+        ::FModel::MappedFile file;
+        ::FModel::MappedDesign design;
+        std::string error;
+        if (!file.open(netlist_file)) {
+            std::cerr << "Cannot open netlist file: " << netlist_file << std::endl;
+            return 1;
+        }
+        if (!::FModel::parseMappedDesign(file.data(), design, error)) {
+            std::cerr << netlist_file << ": " << error << std::endl;
+            return 1;
+        }
+        ::FModel::EmittedDesign files;
+        ::FModel::emitDesign(design, ::FModel::currentStamps(), netlist_file, files);
+        const std::string base = emit_dir + "/" + design.module_name;
+        if (!::FModel::writeEmittedFile(base + ".net", files.netlist) ||
+            !::FModel::writeEmittedFile(base + "_output.sch", files.schematic) ||
+            !::FModel::writeEmittedFile(base + "_bom.md", files.bom)) {
+            return 1;
+        }
+        if (!use_stimulus && !use_sta && test_vectors_file.empty()) return 0;
+        netlist_file = base + ".net";
+        emitted_netlist = std::move(files.netlist);
+    }
+    if (!use_stimulus && !use_sta && test_vectors_file.empty()) {
+        std::cerr << "No test vectors file given" << std::endl;
+        return 1;
+    }
+    
+    // Below verbose only the simulator's own report (and errors) is printed
+    const bool verbose = model.getReportLevel() == ::FModel::ReportLevel::VERBOSE;
+    if (verbose) printBanner();
+    
     // Load netlist
-    std::cout << "\n1. Loading Circuit Netlist..." << std::endl;
-    if (!model.loadFromNetlist(netlist_file)) {
+    if (verbose) std::cout << "\n1. Loading Circuit Netlist..." << std::endl;
+    const bool loaded = emit_dir.empty() ? model.loadFromNetlist(netlist_file)
+                                         : model.loadFromNetlistData(netlist_file, emitted_netlist);
+    if (!loaded) {
         std::cerr << "Failed to load netlist: " << netlist_file << std::endl;
         return 1;
     }
     
     // Load test vectors
-    std::cout << "\n2. Loading Test Vectors..." << std::endl;
-    if (!model.loadTestVectors(test_vectors_file)) {
-        std::cerr << "Failed to load test vectors: " << test_vectors_file << std::endl;
-        return 1;
+    if (!test_vectors_file.empty()) {
+        if (verbose) std::cout << "\n2. Loading Test Vectors..." << std::endl;
+        if (!model.loadTestVectors(test_vectors_file)) {
+            std::cerr << "Failed to load test vectors: " << test_vectors_file << std::endl;
+            return 1;
+        }
+        if (!packed_vectors_file.empty() && !model.writeVectorFile(packed_vectors_file)) {
+            return 1;
+        }
+    }
+    
+    // Static timing needs no vectors
+    bool simulation_success = true;
+    if (use_sta) {
+        ::FModel::StaticTimingReport timing;
+        if (!model.analyzeTiming(sta_paths, timing)) {
+            simulation_success = false;
+        }
     }
     
     // Print initial circuit state
-    std::cout << "\n3. Initial Circuit State..." << std::endl;
-    model.printCircuitState();
+    if (verbose) {
+        std::cout << "\n3. Initial Circuit State..." << std::endl;
+        model.printCircuitState();
+    }
     
     // Run simulation
-    std::cout << "\n4. Running Simulation..." << std::endl;
-    bool simulation_success = model.simulate();
+    if (verbose) std::cout << "\n4. Running Simulation..." << std::endl;
+    if (!test_vectors_file.empty() && use_faults) {
+        ::FModel::FaultReport faults;
+        simulation_success = model.simulateFaults(faults) && simulation_success;
+    } else if (!test_vectors_file.empty()) {
+        simulation_success = model.simulate() && simulation_success;
+    }
     
-    // Print final results
-    std::cout << "\n5. Simulation Results..." << std::endl;
-    if (simulation_success) {
-        std::cout << "✓ All tests PASSED!" << std::endl;
-    } else {
-        std::cout << "✗ Some tests FAILED!" << std::endl;
+    // Check generated stimulus against the golden (or reference) netlist
+    if (use_stimulus) {
+        ::FModel::FModel golden;
+        golden.setReportLevel(::FModel::ReportLevel::SILENT);
+        golden.setCacheDirectory(cache_dir);
+        if (!golden.loadFromNetlist(golden_file)) {
+            std::cerr << "Failed to load golden netlist: " << golden_file << std::endl;
+            return 1;
+        }
+        ::FModel::StimulusReport report;
+        const bool passed = use_equivalence ? model.checkEquivalence(stimulus, golden, report)
+                                            : model.checkStimulus(stimulus, golden, report);
+        if (!passed) simulation_success = false;
     }
     
-    std::cout << "\n=== Demo Complete ===" << std::endl;
+    if (!profile_file.empty() && !model.writeProfile(profile_file)) simulation_success = false;
+    
+    // Print final results
+    if (verbose) {
+        std::cout << "\n5. Simulation Results..." << std::endl;
+        if (simulation_success) {
+            std::cout << "✓ All tests PASSED!" << std::endl;
+        } else {
+            std::cout << "✗ Some tests FAILED!" << std::endl;
+        }
+        
+        std::cout << "\n=== Demo Complete ===" << std::endl;
+    }
     
     return simulation_success ? 0 : 1;
 }
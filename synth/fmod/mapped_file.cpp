@@ -0,0 +1,49 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Read-only memory-mapped view of a file
+ */
+
+#include "mapped_file.h"
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FModel {
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            // Parsers read front to back
+            ::madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            mapped = addr;
+            mapped_size = static_cast<size_t>(st.st_size);
+            ::close(fd);
+            return true;
+        }
+    }
+    ::close(fd);
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped) ::munmap(mapped, mapped_size);
+    mapped = nullptr;
+    mapped_size = 0;
+    buffer.clear();
+}
+
+} // namespace FModel
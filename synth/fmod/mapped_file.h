@@ -0,0 +1,42 @@
+/**
+ * @file mapped_file.h
+ * @brief Read-only memory-mapped view of a file
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+
+namespace FModel {
+
+/**
+ * Maps the whole file with mmap(); if mapping fails (e.g. a pipe or an
+ * unsupported filesystem) the file is read into an owned buffer instead,
+ * so callers always get one contiguous view.
+ */
+class MappedFile {
+public:
+    MappedFile() : mapped(nullptr), mapped_size(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    std::string_view data() const {
+        return mapped ? std::string_view(static_cast<const char*>(mapped), mapped_size) : std::string_view(buffer);
+    }
+
+private:
+    void* mapped;
+    size_t mapped_size;
+    std::string buffer;
+};
+
+} // namespace FModel
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,251 @@
+/**
+ * @file optimize.cpp
+ * @brief Gate-level optimization of the compiled evaluation programs
+ *
+ * The levelized program (packed_gates, run by the scalar, bit-parallel and
+ * multi-threaded engines) and the cycle-based program (cycle_gates) are
+ * rewritten in one forward pass over their topological order:
+ *   - identities: AND/OR of a net with itself reads that net, NAND/NOR of a
+ *     net with itself becomes an inverter,
+ *   - double inversion: an inverter of an inverter reads the original net,
+ *   - structural hashing: a gate with the same function of the same nets as
+ *     an earlier one reads that gate's output instead,
+ * and a backward pass then drops every gate no observed net depends on.
+ * Any Z input makes a gate's output Z, so only rewrites that keep Z are
+ * made (XOR of a net with itself is not LOW while the net floats).
+ *
+ * Constants are already propagated when the circuit is levelized: pins on
+ * VCC/GND are power pins and are not compiled, so an input tied to a rail,
+ * like one tied to GND_UNUSED, is permanently Z, and every gate it reaches
+ * is dropped from the schedule as dead.
+ *
+ * Observed nets (the checked and driven nets, primary inputs and outputs,
+ * register pins) keep a gate of their own and are never merged, so they
+ * still carry exactly the levels the netlist gives them; other nets may no
+ * longer be written at all. The netlist, its gates and the schedule are not
+ * touched: the event-driven, timed and incremental engines still see every
+ * gate, and recompiling restores the original programs.
+ */
+
+#include "fmodel.h"
+#include "vector_file.h"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <unordered_map>
+
+namespace FModel {
+
+namespace {
+
+constexpr int NUM_GATE_OPS = static_cast<int>(GateOp::DFF) + 1;
+
+struct GateCounts {
+    size_t identity = 0;
+    size_t inverter_pairs = 0;
+    size_t duplicates = 0;
+    size_t unobserved = 0;
+};
+
+// Rewrites a topologically ordered program in place; gives up, leaving it
+// untouched, if some net has several drivers (the last write wins there)
+bool simplifyGates(std::vector<PackedGate>& gates, const std::vector<char>& observed, GateCounts& counts) {
+    const int num_signals = static_cast<int>(observed.size());
+    std::vector<char> driven(num_signals, 0);
+    for (const PackedGate& g : gates) {
+        if (driven[g.out]) return false;
+        driven[g.out] = 1;
+    }
+
+    // Each net reads as rep[net]
+    std::vector<int> rep(num_signals);
+    std::iota(rep.begin(), rep.end(), 0);
+    std::vector<int> inverse(num_signals, -1);   // x for a net computed as NOT x
+    std::unordered_map<uint64_t, int> seen[NUM_GATE_OPS];
+
+    std::vector<PackedGate> kept;
+    kept.reserve(gates.size());
+    for (const PackedGate& gate : gates) {
+        GateOp op = gate.op;
+        int a = rep[gate.in_a];
+        int b = op == GateOp::NOT ? a : rep[gate.in_b];
+
+        // same: the net this gate's output always equals, -1 if none
+        int same = -1;
+        size_t* reason = nullptr;
+        if (op != GateOp::NOT && a == b) {
+            if (op == GateOp::AND || op == GateOp::OR) {
+                same = a;
+                reason = &counts.identity;
+            } else if (op == GateOp::NAND || op == GateOp::NOR) {
+                op = GateOp::NOT;
+            }
+        }
+        if (same < 0 && op == GateOp::NOT && inverse[a] >= 0) {
+            same = inverse[a];
+            reason = &counts.inverter_pairs;
+        }
+        if (same < 0 && op != GateOp::NOT && a > b) std::swap(a, b);
+        const uint64_t key = (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+        auto& table = seen[static_cast<int>(op)];
+        if (same < 0) {
+            auto it = table.find(key);
+            if (it != table.end()) {
+                same = it->second;
+                reason = &counts.duplicates;
+            }
+        }
+
+        if (observed[gate.out]) {
+            // Still written, now as a copy of the equal net when there is one
+            kept.push_back(same >= 0 ? PackedGate{GateOp::AND, same, same, gate.out} : PackedGate{op, a, b, gate.out});
+            continue;
+        }
+        if (same >= 0) {
+            rep[gate.out] = same;
+            ++*reason;
+            continue;
+        }
+        kept.push_back(PackedGate{op, a, b, gate.out});
+        table.emplace(key, gate.out);
+        if (op == GateOp::NOT) inverse[gate.out] = a;
+    }
+
+    // Backward from the observed nets
+    std::vector<char> needed(observed);
+    gates.clear();
+    for (auto it = kept.rbegin(); it != kept.rend(); ++it) {
+        if (!needed[it->out]) {
+            counts.unobserved++;
+            continue;
+        }
+        needed[it->in_a] = needed[it->in_b] = 1;
+        gates.push_back(*it);
+    }
+    std::reverse(gates.begin(), gates.end());
+    return true;
+}
+
+// Levels the rewritten program again and groups each level by op into runs
+// (and into chunks of at most chunk_gates for the multi-threaded engine)
+void groupRuns(std::vector<PackedGate>& gates, size_t num_signals, std::vector<GateRun>& runs,
+               std::vector<GateRun>* parallel_runs, std::vector<int>* parallel_level_offsets, int chunk_gates) {
+    std::vector<int> net_level(num_signals, 0);
+    std::vector<int> gate_level(gates.size());
+    for (size_t i = 0; i < gates.size(); ++i) {
+        gate_level[i] = 1 + std::max(net_level[gates[i].in_a], net_level[gates[i].in_b]);
+        net_level[gates[i].out] = gate_level[i];
+    }
+    std::vector<int> order(gates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int x, int y) {
+        return gate_level[x] != gate_level[y] ? gate_level[x] < gate_level[y] : gates[x].op < gates[y].op;
+    });
+    std::vector<PackedGate> sorted;
+    sorted.reserve(gates.size());
+    for (int g : order) sorted.push_back(gates[g]);
+    gates.swap(sorted);
+
+    runs.clear();
+    if (parallel_runs) {
+        parallel_runs->clear();
+        parallel_level_offsets->clear();
+    }
+    for (size_t i = 0; i < gates.size(); ++i) {
+        const int pos = static_cast<int>(i);
+        const GateOp op = gates[i].op;
+        if (runs.empty() || runs.back().op != op) {
+            runs.push_back(GateRun{op, pos, pos + 1});
+        } else {
+            runs.back().end = pos + 1;
+        }
+        if (!parallel_runs) continue;
+        const bool new_level = i == 0 || gate_level[order[i]] != gate_level[order[i - 1]];
+        if (new_level) parallel_level_offsets->push_back(static_cast<int>(parallel_runs->size()));
+        if (!new_level && parallel_runs->back().op == op && parallel_runs->back().end - parallel_runs->back().begin < chunk_gates) {
+            parallel_runs->back().end = pos + 1;
+        } else {
+            parallel_runs->push_back(GateRun{op, pos, pos + 1});
+        }
+    }
+    if (parallel_runs) parallel_level_offsets->push_back(static_cast<int>(parallel_runs->size()));
+}
+
+} // namespace
+
+void FModel::optimizeCircuit(const std::vector<int>& observed_nets, bool cycle_program) {
+    std::vector<char> observed(signals.size(), 0);
+    for (int signal : observed_nets) {
+        if (signal >= 0) observed[signal] = 1;
+    }
+    for (const auto& signal : signals) {
+        if (signal->is_input || signal->is_output) observed[signal->index] = 1;
+    }
+    if (!circuit.optimized_for.empty()) {
+        bool covered = true;
+        for (size_t s = 0; s < observed.size() && covered; ++s) covered = !observed[s] || circuit.optimized_for[s];
+        if (covered) return;
+        if (!compile()) return;
+    }
+    for (const CompiledRegister& reg : circuit.registers) {
+        for (int pin : {reg.d, reg.clk, reg.pre_n, reg.clr_n, reg.q}) {
+            if (pin >= 0) observed[pin] = 1;
+        }
+    }
+    for (const std::string& name : clock_names) {
+        const int clock = findSignal(name);
+        if (clock >= 0) observed[clock] = 1;
+    }
+
+    const bool report = report_level != ReportLevel::SILENT;
+    std::vector<PackedGate>& program = cycle_program ? circuit.cycle_gates : circuit.packed_gates;
+    const bool optimizable = cycle_program ? circuit.cycle_levelized : circuit.bit_parallel && !circuit.multi_driven;
+    GateCounts counts;
+    const size_t before = program.size();
+    if (!optimizable || !simplifyGates(program, observed, counts)) {
+        if (report) {
+            std::cout << "Gate optimization needs a levelized " << (cycle_program ? "" : "combinational ")
+                      << "circuit with single-driver nets; simulating the netlist as is" << std::endl;
+        }
+        return;
+    }
+    if (cycle_program) {
+        groupRuns(program, signals.size(), circuit.cycle_runs, nullptr, nullptr, 0);
+    } else {
+        groupRuns(program, signals.size(), circuit.gate_runs, &circuit.parallel_runs, &circuit.parallel_level_offsets,
+                  PARALLEL_CHUNK_GATES);
+    }
+    circuit.optimized_for = std::move(observed);
+
+    if (report) {
+        std::cout << "Gate optimization: " << before << " -> " << program.size() << " gates (" << counts.identity
+                  << " identities, " << counts.inverter_pairs << " inverter pairs, " << counts.duplicates
+                  << " duplicates, " << counts.unobserved << " unobserved)" << std::endl;
+    }
+}
+
+bool FModel::unoptimize() {
+    // Recompiling rebuilds the programs from the netlist
+    return circuit.optimized_for.empty() || compile();
+}
+
+std::vector<int> FModel::vectorNets() const {
+    // Every net the test vectors drive or check
+    std::vector<int> nets;
+    auto add = [&](const std::string& name) {
+        const int signal = findSignal(name);
+        if (signal >= 0) nets.push_back(signal);
+    };
+    if (vector_stream) {
+        for (const std::string& name : vector_stream->inputColumns()) add(name);
+        for (const std::string& name : vector_stream->outputColumns()) add(name);
+        return nets;
+    }
+    for (const TestVector& test_vector : test_vectors) {
+        for (const auto& input : test_vector.inputs) add(input.first);
+        for (const auto& output : test_vector.expected_outputs) add(output.first);
+    }
+    return nets;
+}
+
+} // namespace FModel
@@ -0,0 +1,264 @@
+/**
+ * @file optimize_test.cpp
+ * @brief Regression check of the --optimize rewrites on random netlists
+ *
+ * Each seed writes a KiCad netlist full of inverter chains, gates of a net
+ * with itself, duplicated gates and gates nothing reads, then checks the
+ * optimized circuit against the same netlist unoptimized:
+ *   - every 0/1 input combination through checkStimulus(),
+ *   - random 0/1/Z vectors, expecting the unoptimized levels (Z included)
+ *     on every output, scalar and bit-parallel.
+ * Every rewrite rule must have fired over the run. Exits non-zero on the
+ * first mismatch.
+ */
+
+#include "fmodel.h"
+#include "part_descriptors.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace FModel;
+
+namespace {
+
+const int SEEDS = 20;
+const int INPUTS = 6;
+const int OUTPUTS = 6;
+const int CONSTRUCTS = 40;
+const int Z_VECTORS = 256;
+
+// Gate parts by index into PART_DESCRIPTORS; no flip-flops
+const int NAND = 0, NOR = 1, NOT = 2, AND = 3, OR = 4, XOR = 6;
+const int TWO_INPUT_PARTS[] = {NAND, NOR, AND, OR, XOR};
+
+/**
+ * @brief KiCad netlist of 74xx gates, filling each IC's cells in order
+ */
+class RandomNetlist {
+public:
+    void input(const std::string& net) { node(net, "JIN_" + net, 1); }
+    void output(const std::string& net) { node(net, "JOUT_" + net, 1); }
+
+    void gate(int part, const std::vector<std::string>& inputs, const std::string& out) {
+        const PartDescriptor& descriptor = PART_DESCRIPTORS[part];
+        if (used[part] == 0 || used[part] == descriptor.num_cells) {
+            ic[part] = "U" + std::to_string(components.size() + 1);
+            components.emplace_back(ic[part], descriptor.part_number);
+            node("VCC", ic[part], 14);
+            node("GND", ic[part], 7);
+            used[part] = 0;
+        }
+        const CellDescriptor& cell = descriptor.cells[used[part]++];
+        for (int i = 0; i < cell.num_inputs; ++i) node(inputs[i], ic[part], cell.inputs[i]);
+        node(out, ic[part], cell.output);
+    }
+
+    bool write(const std::string& path) const {
+        std::ofstream file(path);
+        file << "(export (version D)\n  (design (source \"optimize_test\"))\n  (components\n";
+        for (const auto& comp : components) {
+            file << "    (comp (ref " << comp.first << ") (value " << comp.second << "))\n";
+        }
+        file << "  )\n  (nets\n";
+        for (size_t n = 0; n < nets.size(); ++n) {
+            file << "    (net (code " << n + 1 << ") (name \"" << nets[n].first << "\")\n";
+            for (const auto& pin : nets[n].second) {
+                file << "      (node (ref " << pin.first << ") (pin " << pin.second << "))\n";
+            }
+            file << "    )\n";
+        }
+        file << "  )\n)\n";
+        return static_cast<bool>(file);
+    }
+
+private:
+    void node(const std::string& net, const std::string& ref, int pin) {
+        auto it = net_index.find(net);
+        if (it == net_index.end()) {
+            it = net_index.emplace(net, nets.size()).first;
+            nets.emplace_back(net, std::vector<std::pair<std::string, int>>());
+        }
+        nets[it->second].second.emplace_back(ref, pin);
+    }
+
+    std::vector<std::pair<std::string, std::string>> components;
+    std::vector<std::pair<std::string, std::vector<std::pair<std::string, int>>>> nets;
+    std::map<std::string, size_t> net_index;
+    std::map<int, std::string> ic;
+    std::map<int, int> used;
+};
+
+void buildNetlist(RandomNetlist& netlist, std::mt19937& random) {
+    std::vector<std::string> pool;
+    for (int i = 0; i < INPUTS; ++i) {
+        pool.push_back("in" + std::to_string(i));
+        netlist.input(pool.back());
+    }
+    int next_net = 0;
+    auto pick = [&]() { return pool[random() % pool.size()]; };
+    auto fresh = [&]() { return "n" + std::to_string(next_net++); };
+    auto part = [&]() { return TWO_INPUT_PARTS[random() % 5]; };
+
+    for (int c = 0; c < CONSTRUCTS; ++c) {
+        switch (random() % 4) {
+        case 0: {
+            // Inverter chain of two to five
+            std::string from = pick();
+            for (int k = 2 + static_cast<int>(random() % 4); k > 0; --k) {
+                const std::string to = fresh();
+                netlist.gate(NOT, {from}, to);
+                from = to;
+            }
+            pool.push_back(from);
+            break;
+        }
+        case 1: {
+            // The same gate two or three times, inputs sometimes swapped
+            const int op = part();
+            const std::string a = pick(), b = pick();
+            for (int k = 2 + static_cast<int>(random() % 2); k > 0; --k) {
+                const std::string out = fresh();
+                if (random() % 2) {
+                    netlist.gate(op, {a, b}, out);
+                } else {
+                    netlist.gate(op, {b, a}, out);
+                }
+                pool.push_back(out);
+            }
+            break;
+        }
+        case 2: {
+            // A gate of a net with itself
+            const std::string a = pick();
+            const std::string out = fresh();
+            netlist.gate(part(), {a, a}, out);
+            pool.push_back(out);
+            break;
+        }
+        default: {
+            const std::string out = fresh();
+            netlist.gate(part(), {pick(), pick()}, out);
+            pool.push_back(out);
+            break;
+        }
+        }
+    }
+    // Outputs come from the later half, so earlier gates are often unread
+    for (int o = 0; o < OUTPUTS; ++o) {
+        netlist.output(pool[pool.size() / 2 + random() % (pool.size() - pool.size() / 2)]);
+    }
+}
+
+struct RuleCounts {
+    long identities = 0, inverter_pairs = 0, duplicates = 0, unobserved = 0;
+};
+
+// Adds the counts of the "Gate optimization:" line in report
+void countRewrites(const std::string& report, RuleCounts& counts) {
+    const size_t at = report.find("Gate optimization: ");
+    long before = 0, after = 0, identities = 0, pairs = 0, duplicates = 0, unobserved = 0;
+    if (at == std::string::npos ||
+        std::sscanf(report.c_str() + at, "Gate optimization: %ld -> %ld gates (%ld identities, %ld inverter pairs, %ld duplicates, %ld unobserved)",
+                    &before, &after, &identities, &pairs, &duplicates, &unobserved) != 6) {
+        return;
+    }
+    counts.identities += identities;
+    counts.inverter_pairs += pairs;
+    counts.duplicates += duplicates;
+    counts.unobserved += unobserved;
+}
+
+bool checkSeed(int seed, const std::string& path, RuleCounts& counts) {
+    std::mt19937 random(seed);
+    RandomNetlist netlist;
+    buildNetlist(netlist, random);
+    if (!netlist.write(path)) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+
+    ::FModel::FModel golden, optimized;
+    for (::FModel::FModel* model : {&golden, &optimized}) {
+        model->setReportLevel(ReportLevel::SILENT);
+        if (!model->loadFromNetlist(path)) {
+            std::cerr << "seed " << seed << ": failed to load " << path << std::endl;
+            return false;
+        }
+    }
+    optimized.setOptimize(true);
+
+    // Every 0/1 combination; the optimizer reports its rewrites on this run
+    StimulusOptions exhaustive;
+    StimulusReport report;
+    std::ostringstream captured;
+    std::streambuf* const stdout_buffer = std::cout.rdbuf(captured.rdbuf());
+    optimized.setReportLevel(ReportLevel::SUMMARY);
+    const bool exhaustive_passed = optimized.checkStimulus(exhaustive, golden, report);
+    optimized.setReportLevel(ReportLevel::SILENT);
+    std::cout.rdbuf(stdout_buffer);
+    if (!exhaustive_passed) {
+        std::cerr << "seed " << seed << ": " << report.mismatches << " of " << report.vectors
+                  << " input combinations differ from the unoptimized netlist" << std::endl;
+        return false;
+    }
+    countRewrites(captured.str(), counts);
+
+    // 0/1/Z vectors expecting the unoptimized levels
+    const std::vector<std::string> inputs = golden.getInputNames();
+    const std::vector<std::string> outputs = golden.getOutputNames();
+    static const LogicLevel LEVELS[] = {LogicLevel::LOW, LogicLevel::HIGH, LogicLevel::FLOATING};
+    for (int v = 0; v < Z_VECTORS; ++v) {
+        TestVector vector;
+        for (const std::string& input : inputs) vector.addInput(input, LEVELS[random() % 3]);
+        golden.simulateTestVector(vector);
+        for (const std::string& output : outputs) vector.addExpectedOutput(output, golden.getSignalLevel(output));
+        optimized.addTestVector(std::move(vector));
+    }
+    for (const bool bit_parallel : {false, true}) {
+        optimized.setBitParallel(bit_parallel);
+        if (!optimized.simulate()) {
+            std::cerr << "seed " << seed << ": 0/1/Z vectors differ from the unoptimized netlist ("
+                      << (bit_parallel ? "bit-parallel" : "scalar") << ")" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    char path_template[] = "/tmp/optimize_test.XXXXXX";
+    const int fd = mkstemp(path_template);
+    if (fd < 0) {
+        std::cerr << "Cannot create a scratch file in /tmp" << std::endl;
+        return 1;
+    }
+    close(fd);
+    const std::string path = std::string(path_template) + ".net";
+
+    int failed = 0;
+    RuleCounts counts;
+    for (int seed = 1; seed <= SEEDS; ++seed) {
+        if (!checkSeed(seed, path, counts)) failed++;
+    }
+    std::remove(path.c_str());
+    std::remove(path_template);
+
+    std::cout << SEEDS << " random netlists: " << counts.identities << " identities, " << counts.inverter_pairs
+              << " inverter pairs, " << counts.duplicates << " duplicates, " << counts.unobserved
+              << " unobserved gates removed" << std::endl;
+    if (counts.identities == 0 || counts.inverter_pairs == 0 || counts.duplicates == 0 || counts.unobserved == 0) {
+        std::cerr << "A rewrite rule never fired" << std::endl;
+        failed++;
+    }
+    std::cout << (failed ? "✗ optimized netlists differ" : "✓ optimized netlists match the unoptimized ones") << std::endl;
+    return failed ? 1 : 0;
+}
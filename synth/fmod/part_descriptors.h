@@ -0,0 +1,201 @@
+/**
+ * @file part_descriptors.h
+ * @brief Compile-time descriptors of the supported 74xx parts
+ *
+ * Each part is described by its pin roles, its logic cells (input pins
+ * feeding one output pin) and its gate function. The simulator resolves
+ * these once per instance at compile time and evaluates combinational cells
+ * straight from the 3-valued truth tables below, without going through the
+ * virtual Component interface.
+ */
+
+#ifndef PART_DESCRIPTORS_H
+#define PART_DESCRIPTORS_H
+
+#include "fmodel.h"
+#include <cstdint>
+#include <string_view>
+
+namespace FModel {
+
+/**
+ * @brief Role of a package pin
+ */
+enum class PinRole : uint8_t {
+    NONE,     // not modeled by the simulator (e.g. 74HC74 Q_N)
+    INPUT,
+    OUTPUT,
+    POWER
+};
+
+/**
+ * @brief Logic cell: the input pins that feed one output pin
+ */
+struct CellDescriptor {
+    uint8_t inputs[4];
+    uint8_t num_inputs;
+    uint8_t output;
+};
+
+constexpr int PART_PINS = 14;
+constexpr int PART_MAX_CELLS = 6;
+
+/**
+ * @brief Static description of one part number
+ */
+struct PartDescriptor {
+    const char* part_number;
+    GateOp op;
+    uint8_t num_cells;
+    CellDescriptor cells[PART_MAX_CELLS];
+    PinRole pins[PART_PINS + 1];   // indexed by pin number, [0] unused
+};
+
+/**
+ * @brief Build a descriptor, deriving pin roles from the cells
+ */
+constexpr PartDescriptor makePartDescriptor(const char* part_number, GateOp op, uint8_t num_cells,
+                                            const CellDescriptor (&cells)[PART_MAX_CELLS]) {
+    PartDescriptor part{part_number, op, num_cells, {}, {}};
+    for (int c = 0; c < num_cells; ++c) {
+        part.cells[c] = cells[c];
+        for (int i = 0; i < cells[c].num_inputs; ++i) part.pins[cells[c].inputs[i]] = PinRole::INPUT;
+        part.pins[cells[c].output] = PinRole::OUTPUT;
+    }
+    part.pins[7] = PinRole::POWER;
+    part.pins[14] = PinRole::POWER;
+    return part;
+}
+
+constexpr CellDescriptor QUAD_GATE_CELLS[PART_MAX_CELLS] = {
+    {{1, 2}, 2, 3}, {{4, 5}, 2, 6}, {{9, 10}, 2, 8}, {{12, 13}, 2, 11}
+};
+constexpr CellDescriptor QUAD_NOR_CELLS[PART_MAX_CELLS] = {
+    {{2, 3}, 2, 1}, {{5, 6}, 2, 4}, {{8, 9}, 2, 10}, {{11, 12}, 2, 13}
+};
+constexpr CellDescriptor HEX_INVERTER_CELLS[PART_MAX_CELLS] = {
+    {{1}, 1, 2}, {{3}, 1, 4}, {{5}, 1, 6}, {{9}, 1, 8}, {{11}, 1, 10}, {{13}, 1, 12}
+};
+// Flip-flop halves: CLR, D, CLK, PRE -> Q (Q_N is not driven onto nets)
+constexpr CellDescriptor DUAL_DFF_CELLS[PART_MAX_CELLS] = {
+    {{1, 2, 3, 4}, 4, 5}, {{10, 11, 12, 13}, 4, 9}
+};
+
+/**
+ * @brief Pin functions of one flip-flop half, for the cycle-based engine
+ */
+struct RegisterPins {
+    uint8_t d;
+    uint8_t clk;
+    uint8_t pre_n;
+    uint8_t clr_n;
+    uint8_t q;
+};
+
+constexpr RegisterPins DUAL_DFF_REGISTERS[2] = {
+    {2, 3, 4, 1, 5}, {12, 11, 10, 13, 9}
+};
+
+static_assert(DUAL_DFF_REGISTERS[0].q == DUAL_DFF_CELLS[0].output && DUAL_DFF_REGISTERS[1].q == DUAL_DFF_CELLS[1].output,
+              "register pins follow the flip-flop cells");
+
+constexpr PartDescriptor PART_DESCRIPTORS[] = {
+    makePartDescriptor("74HC00", GateOp::NAND, 4, QUAD_GATE_CELLS),
+    makePartDescriptor("74HC02", GateOp::NOR, 4, QUAD_NOR_CELLS),
+    makePartDescriptor("74HC04", GateOp::NOT, 6, HEX_INVERTER_CELLS),
+    makePartDescriptor("74HC08", GateOp::AND, 4, QUAD_GATE_CELLS),
+    makePartDescriptor("74HC32", GateOp::OR, 4, QUAD_GATE_CELLS),
+    makePartDescriptor("74HC74", GateOp::DFF, 2, DUAL_DFF_CELLS),
+    makePartDescriptor("74HC86", GateOp::XOR, 4, QUAD_GATE_CELLS),
+};
+
+static_assert(PART_DESCRIPTORS[1].pins[1] == PinRole::OUTPUT, "74HC02 outputs are on pins 1/4/10/13");
+static_assert(PART_DESCRIPTORS[2].pins[8] == PinRole::OUTPUT, "74HC04 gate 4 drives pin 8");
+static_assert(PART_DESCRIPTORS[5].pins[6] == PinRole::NONE, "74HC74 Q_N is not modeled");
+
+/**
+ * @brief Descriptor for a part number, or nullptr if unsupported
+ */
+inline const PartDescriptor* findPartDescriptor(std::string_view part_number) {
+    for (const PartDescriptor& part : PART_DESCRIPTORS) {
+        if (part_number == part.part_number) return &part;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Reference gate function; any FLOATING input yields FLOATING,
+ *        matching the component models
+ */
+constexpr LogicLevel gateFunction(GateOp op, LogicLevel a, LogicLevel b) {
+    if (a == LogicLevel::FLOATING || b == LogicLevel::FLOATING) return LogicLevel::FLOATING;
+    const bool x = a == LogicLevel::HIGH;
+    const bool y = b == LogicLevel::HIGH;
+    bool r = false;
+    switch (op) {
+        case GateOp::AND:  r = x && y; break;
+        case GateOp::OR:   r = x || y; break;
+        case GateOp::NAND: r = !(x && y); break;
+        case GateOp::NOR:  r = !(x || y); break;
+        case GateOp::XOR:  r = x != y; break;
+        case GateOp::NOT:  r = !x; break;
+        case GateOp::DFF:  return LogicLevel::FLOATING;
+    }
+    return r ? LogicLevel::HIGH : LogicLevel::LOW;
+}
+
+/**
+ * @brief 3x3 truth table indexed by truthTableIndex(a, b)
+ */
+struct TruthTable {
+    LogicLevel out[9];
+};
+
+constexpr int truthTableIndex(LogicLevel a, LogicLevel b) {
+    return (static_cast<int>(a) + 1) * 3 + (static_cast<int>(b) + 1);
+}
+
+constexpr TruthTable makeTruthTable(GateOp op) {
+    TruthTable table{};
+    const LogicLevel levels[3] = {LogicLevel::FLOATING, LogicLevel::LOW, LogicLevel::HIGH};
+    for (LogicLevel a : levels) {
+        for (LogicLevel b : levels) table.out[truthTableIndex(a, b)] = gateFunction(op, a, b);
+    }
+    return table;
+}
+
+// Indexed by GateOp (NOT is evaluated with b == a)
+constexpr TruthTable TRUTH_TABLES[] = {
+    makeTruthTable(GateOp::AND), makeTruthTable(GateOp::OR), makeTruthTable(GateOp::NAND),
+    makeTruthTable(GateOp::NOR), makeTruthTable(GateOp::XOR), makeTruthTable(GateOp::NOT),
+    makeTruthTable(GateOp::DFF)
+};
+
+static_assert(TRUTH_TABLES[static_cast<int>(GateOp::NAND)].out[truthTableIndex(LogicLevel::HIGH, LogicLevel::HIGH)] == LogicLevel::LOW,
+              "NAND(1, 1) == 0");
+static_assert(TRUTH_TABLES[static_cast<int>(GateOp::XOR)].out[truthTableIndex(LogicLevel::LOW, LogicLevel::FLOATING)] == LogicLevel::FLOATING,
+              "Z dominates");
+
+inline LogicLevel evaluateGate(GateOp op, LogicLevel a, LogicLevel b) {
+    return TRUTH_TABLES[static_cast<int>(op)].out[truthTableIndex(a, b)];
+}
+
+/**
+ * @brief Evaluate a run of same-typed combinational gates over a level array
+ *
+ * Instantiated once per GateOp so the truth table is a compile-time constant
+ * and the loop body is a load, a table lookup and a conditional store.
+ */
+template <GateOp Op>
+inline void evaluateGateRun(const PackedGate* gates, int count, LogicLevel* levels) {
+    constexpr TruthTable table = makeTruthTable(Op);
+    for (int i = 0; i < count; ++i) {
+        const PackedGate& g = gates[i];
+        const LogicLevel out = table.out[truthTableIndex(levels[g.in_a], levels[g.in_b])];
+        if (out != LogicLevel::FLOATING) levels[g.out] = out;
+    }
+}
+
+} // namespace FModel
+
+#endif // PART_DESCRIPTORS_H
@@ -0,0 +1,166 @@
+/**
+ * @file profile.cpp
+ * @brief Profile counters and their JSON dump
+ */
+
+#include "profile.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace FModel {
+
+void Profile::addTime(Phase phase, double ms) {
+    phase_ns[phase].fetch_add(static_cast<uint64_t>(ms * 1e6), std::memory_order_relaxed);
+    phase_calls[phase].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Profile::resize(size_t num_signals, size_t num_components) {
+    if (net_toggles.size() != num_signals) {
+        net_toggles = std::vector<Counter>(num_signals);
+        net_events = std::vector<Counter>(num_signals);
+    }
+    if (component_evaluations.size() != num_components) {
+        component_evaluations = std::vector<Counter>(num_components);
+    }
+}
+
+void Profile::countPropagation(uint64_t evaluations, bool settled) {
+    propagations.fetch_add(1, std::memory_order_relaxed);
+    propagation_evaluations.fetch_add(evaluations, std::memory_order_relaxed);
+    if (!settled) unsettled_propagations.fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = max_propagation_evaluations.load(std::memory_order_relaxed);
+    while (evaluations > max && !max_propagation_evaluations.compare_exchange_weak(max, evaluations, std::memory_order_relaxed)) {
+    }
+}
+
+void Profile::countToggles(std::vector<LogicLevel>& previous, const std::vector<LogicLevel>& levels) {
+    // The first vector on a state has nothing to compare with
+    const size_t count = std::min(levels.size(), net_toggles.size());
+    if (previous.size() == levels.size()) {
+        for (size_t s = 0; s < count; ++s) {
+            if (previous[s] != levels[s]) net_toggles[s].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    previous = levels;
+}
+
+void Profile::writeJson(std::ostream& out, const std::vector<std::string>& net_names,
+                        const std::vector<std::string>& component_names, size_t max_entries) const {
+    static const char* const PHASE_NAMES[NUM_PHASES] = {"parse", "validate", "compile", "cache", "vectors", "simulate", "report"};
+    auto value = [](const Counter& counter) { return counter.load(std::memory_order_relaxed); };
+    auto string = [&](const std::string& text) {
+        out << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    };
+    // Indices of the max_entries largest non-zero counts, largest first
+    auto busiest = [&](const std::vector<Counter>& counts) {
+        std::vector<int> order;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            if (value(counts[i]) > 0) order.push_back(static_cast<int>(i));
+        }
+        const size_t kept = std::min(order.size(), max_entries);
+        std::partial_sort(order.begin(), order.begin() + kept, order.end(), [&](int a, int b) {
+            return value(counts[a]) != value(counts[b]) ? value(counts[a]) > value(counts[b]) : a < b;
+        });
+        order.resize(kept);
+        return order;
+    };
+    auto total = [&](const std::vector<Counter>& counts) {
+        uint64_t sum = 0;
+        for (const Counter& count : counts) sum += value(count);
+        return sum;
+    };
+
+    out << "{\n  \"phases\": {";
+    for (int p = 0; p < NUM_PHASES; ++p) {
+        out << (p ? ",\n" : "\n") << "    \"" << PHASE_NAMES[p] << "\": {\"ms\": " << value(phase_ns[p]) / 1e6
+            << ", \"calls\": " << value(phase_calls[p]) << "}";
+    }
+    const uint64_t drains = value(propagations);
+    out << "\n  },\n"
+        << "  \"compiles\": " << value(compiles) << ",\n"
+        << "  \"vectors\": " << value(vectors) << ",\n"
+        << "  \"levelized_passes\": " << value(levelized_passes) << ",\n"
+        << "  \"gate_evaluations\": " << value(gate_evaluations) << ",\n"
+        << "  \"cycle_passes\": " << value(cycle_passes) << ",\n"
+        << "  \"packed_passes\": " << value(packed_passes) << ",\n"
+        << "  \"packed_gate_evaluations\": " << value(packed_gate_evaluations) << ",\n"
+        << "  \"propagations\": {\"count\": " << drains << ", \"component_evaluations\": " << value(propagation_evaluations)
+        << ", \"mean_evaluations\": " << (drains ? static_cast<double>(value(propagation_evaluations)) / drains : 0.0)
+        << ", \"max_evaluations\": " << value(max_propagation_evaluations)
+        << ", \"unsettled\": " << value(unsettled_propagations) << "},\n"
+        << "  \"component_evaluations\": " << total(component_evaluations) << ",\n"
+        << "  \"net_toggles\": " << total(net_toggles) << ",\n"
+        << "  \"net_events\": " << total(net_events) << ",\n";
+
+    out << "  \"busiest_nets_by_toggles\": [";
+    bool first = true;
+    for (int s : busiest(net_toggles)) {
+        out << (first ? "\n" : ",\n") << "    {\"net\": ";
+        string(net_names[s]);
+        out << ", \"toggles\": " << value(net_toggles[s]) << ", \"events\": " << value(net_events[s]) << "}";
+        first = false;
+    }
+    out << (first ? "],\n" : "\n  ],\n") << "  \"busiest_nets_by_events\": [";
+    first = true;
+    for (int s : busiest(net_events)) {
+        out << (first ? "\n" : ",\n") << "    {\"net\": ";
+        string(net_names[s]);
+        out << ", \"events\": " << value(net_events[s]) << ", \"toggles\": " << value(net_toggles[s]) << "}";
+        first = false;
+    }
+    out << (first ? "],\n" : "\n  ],\n") << "  \"busiest_components\": [";
+    first = true;
+    for (int c : busiest(component_evaluations)) {
+        out << (first ? "\n" : ",\n") << "    {\"component\": ";
+        string(component_names[c]);
+        out << ", \"evaluations\": " << value(component_evaluations[c]) << "}";
+        first = false;
+    }
+    out << (first ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+bool FModel::enableProfile() {
+#ifdef FMODEL_PROFILE
+    if (!profile) profile = std::make_unique<Profile>();
+    profile->resize(signals.size(), circuit.components.size());
+    state.profile = profile.get();
+    return true;
+#else
+    std::cerr << "Profiling needs a build with FMODEL_PROFILE (make PROFILE=1)" << std::endl;
+    return false;
+#endif
+}
+
+bool FModel::writeProfile(const std::string& path) const {
+    if (!profile) {
+        std::cerr << "Profiling is not enabled" << std::endl;
+        return false;
+    }
+    constexpr size_t BUSIEST_ENTRIES = 10;
+    std::vector<std::string> net_names;
+    for (const Signal* signal : signals) net_names.push_back(signal->getName());
+    std::vector<std::string> component_names;
+    for (const CompiledComponent& cc : circuit.components) {
+        const ComponentInstance* instance = components[cc.instance];
+        component_names.push_back(std::string(instance->instance_id) + " (" + std::string(instance->part_number) + ")");
+    }
+    if (path == "-") {
+        profile->writeJson(std::cout, net_names, component_names, BUSIEST_ENTRIES);
+        return static_cast<bool>(std::cout);
+    }
+    std::ofstream file(path);
+    profile->writeJson(file, net_names, component_names, BUSIEST_ENTRIES);
+    if (!file) {
+        std::cerr << "Cannot write profile to " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace FModel
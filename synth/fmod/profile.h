@@ -0,0 +1,123 @@
+/**
+ * @file profile.h
+ * @brief Optional per-phase timers and hot-path counters of a simulation run
+ *
+ * The hooks below compile to nothing unless FMODEL_PROFILE is defined
+ * (make PROFILE=1), so default builds carry no instrumentation at all. With
+ * it, FModel::enableProfile() starts counting and FModel::writeProfile()
+ * dumps the totals as JSON. Counters are relaxed atomics, since the sharded
+ * and multi-threaded engines count from several threads at once.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "fmodel.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace FModel {
+
+class Profile {
+public:
+    enum Phase {
+        PARSE,      // netlist parse
+        VALIDATE,
+        COMPILE,    // every compile(), including recompiles
+        CACHE,      // circuit cache reads and writes
+        VECTORS,    // test vector file parse and packed batch decode
+        SIMULATE,   // the engines, from applying inputs to checking outputs
+        REPORT,     // printing the results
+        NUM_PHASES
+    };
+
+    using Counter = std::atomic<uint64_t>;
+
+    void addTime(Phase phase, double ms);
+    /**
+     * @brief Size the per-net and per-component tables; they start from zero
+     *        again only when the circuit they describe changed size
+     */
+    void resize(size_t num_signals, size_t num_components);
+    void countPropagation(uint64_t evaluations, bool settled);
+    /**
+     * @brief Count the nets whose settled level differs from the previous
+     *        vector run on the same state (previous holds that vector)
+     */
+    void countToggles(std::vector<LogicLevel>& previous, const std::vector<LogicLevel>& levels);
+    void countNetEvent(int signal) { net_events[signal].fetch_add(1, std::memory_order_relaxed); }
+    void countComponent(int component) { component_evaluations[component].fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief JSON object of every counter, listing the max_entries busiest
+     *        nets and components by name
+     */
+    void writeJson(std::ostream& out, const std::vector<std::string>& net_names,
+                   const std::vector<std::string>& component_names, size_t max_entries) const;
+
+    Counter compiles{0};
+    Counter vectors{0};
+    Counter levelized_passes{0};      // one per vector through the levelized schedule
+    Counter gate_evaluations{0};      // gates run by levelized and cycle-based passes
+    Counter cycle_passes{0};          // one per clock cycle of the cycle-based engine
+    Counter packed_passes{0};         // one per batch of 64 x W vectors
+    Counter packed_gate_evaluations{0};
+    Counter propagations{0};          // event-driven worklist drains
+    Counter propagation_evaluations{0};
+    Counter max_propagation_evaluations{0};
+    Counter unsettled_propagations{0};   // stopped at the evaluation limit
+
+private:
+    Counter phase_ns[NUM_PHASES] = {};
+    Counter phase_calls[NUM_PHASES] = {};
+    std::vector<Counter> net_toggles;
+    std::vector<Counter> net_events;
+    std::vector<Counter> component_evaluations;
+};
+
+/**
+ * @brief Adds the lifetime of the scope to a phase; a null profile is a no-op
+ */
+class ProfileTimer {
+public:
+    ProfileTimer(Profile* profile, Profile::Phase phase)
+        : profile(profile), phase(phase), start(profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+    ~ProfileTimer() {
+        if (profile) {
+            profile->addTime(phase, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+    ProfileTimer(const ProfileTimer&) = delete;
+    ProfileTimer& operator=(const ProfileTimer&) = delete;
+
+private:
+    Profile* profile;
+    Profile::Phase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#ifdef FMODEL_PROFILE
+#define FMODEL_PROFILE_CONCAT_(a, b) a##b
+#define FMODEL_PROFILE_CONCAT(a, b) FMODEL_PROFILE_CONCAT_(a, b)
+// Times the rest of the enclosing scope into phase of profile (a Profile*)
+#define FMODEL_PROFILE_SCOPE(profile, phase) \
+    ::FModel::ProfileTimer FMODEL_PROFILE_CONCAT(profile_timer_, __LINE__)((profile), ::FModel::Profile::phase)
+// Adds n to a counter of profile, if there is one
+#define FMODEL_PROFILE_ADD(profile, counter, n) \
+    do { if (::FModel::Profile* p_ = (profile)) p_->counter.fetch_add((n), std::memory_order_relaxed); } while (0)
+// Calls a counting method of profile, if there is one
+#define FMODEL_PROFILE_CALL(profile, call) \
+    do { if (::FModel::Profile* p_ = (profile)) p_->call; } while (0)
+#else
+#define FMODEL_PROFILE_SCOPE(profile, phase) ((void)0)
+#define FMODEL_PROFILE_ADD(profile, counter, n) ((void)0)
+#define FMODEL_PROFILE_CALL(profile, call) ((void)0)
+#endif
+
+} // namespace FModel
+
+#endif // PROFILE_H
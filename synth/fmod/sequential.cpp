@@ -0,0 +1,281 @@
+/**
+ * @file sequential.cpp
+ * @brief Cycle-based simulation of clocked designs
+ *
+ * Flip-flops are cut out of the netlist as registers. What remains between
+ * them is combinational and evaluated once per clock cycle in a precomputed
+ * topological order, with the register outputs and primary inputs as its
+ * sources. A vector first drives every register's Q net from its stored
+ * state and evaluates the combinational gates (pulsed clock nets read LOW),
+ * then each cycle is:
+ *   1. rising edge: every register clocked by a pulsed clock samples its D
+ *      net at once; active-low PRE/CLR override it, as in the 74HC74 model,
+ *   2. the Q nets take the new state and the gates are evaluated again,
+ * so the outputs show the state after the final edge.
+ */
+
+#include "fmodel.h"
+#include "part_descriptors.h"
+#include "profile.h"
+#include "vcd.h"
+#include <iostream>
+
+namespace FModel {
+
+namespace {
+
+void evaluateCycleRun(const PackedGate* gates, const GateRun& run, LogicLevel* levels) {
+    const PackedGate* first = gates + run.begin;
+    const int count = run.end - run.begin;
+    switch (run.op) {
+        case GateOp::AND:  evaluateGateRun<GateOp::AND>(first, count, levels); break;
+        case GateOp::OR:   evaluateGateRun<GateOp::OR>(first, count, levels); break;
+        case GateOp::NAND: evaluateGateRun<GateOp::NAND>(first, count, levels); break;
+        case GateOp::NOR:  evaluateGateRun<GateOp::NOR>(first, count, levels); break;
+        case GateOp::XOR:  evaluateGateRun<GateOp::XOR>(first, count, levels); break;
+        case GateOp::NOT:  evaluateGateRun<GateOp::NOT>(first, count, levels); break;
+        case GateOp::DFF:  break;   // registers are never scheduled
+    }
+}
+
+} // namespace
+
+void FModel::buildCycleSchedule(CompiledCircuit& compiled_circuit) const {
+    CompiledCircuit& cc = compiled_circuit;
+    cc.registers.clear();
+    cc.cycle_gates.clear();
+    cc.cycle_runs.clear();
+    cc.cycle_levelized = false;
+
+    // Registers: resolve each flip-flop half's pins by function
+    std::vector<int> combinational;
+    for (int g = 0; g < static_cast<int>(cc.gates.size()); ++g) {
+        const CompiledGate& gate = cc.gates[g];
+        if (gate.op != GateOp::DFF) {
+            combinational.push_back(g);
+            continue;
+        }
+        const RegisterPins& pins = DUAL_DFF_REGISTERS[gate.output_pin == DUAL_DFF_REGISTERS[0].q ? 0 : 1];
+        CompiledRegister reg{g, -1, -1, -1, -1, gate.output_signal};
+        for (int i = gate.inputs_begin; i < gate.inputs_end; ++i) {
+            const CompiledPin& cp = cc.gate_input_pins[i];
+            if (cp.pin == pins.d) reg.d = cp.signal;
+            if (cp.pin == pins.clk) reg.clk = cp.signal;
+            if (cp.pin == pins.pre_n) reg.pre_n = cp.signal;
+            if (cp.pin == pins.clr_n) reg.clr_n = cp.signal;
+        }
+        cc.registers.push_back(reg);
+    }
+
+    // Kahn's algorithm over the combinational gates only: register outputs
+    // have no combinational driver, so every loop through a register is cut
+    const int num_signals = static_cast<int>(signals.size());
+    std::vector<int> drivers(num_signals, 0);
+    std::vector<int> reader_offsets(num_signals + 1, 0);
+    for (int g : combinational) {
+        const CompiledGate& gate = cc.gates[g];
+        drivers[gate.output_signal]++;
+        reader_offsets[gate.in_a + 1]++;
+        if (gate.in_b != gate.in_a) reader_offsets[gate.in_b + 1]++;
+    }
+    for (int s = 0; s < num_signals; ++s) reader_offsets[s + 1] += reader_offsets[s];
+    std::vector<int> readers(reader_offsets[num_signals]);
+    std::vector<int> indegree(cc.gates.size(), 0);
+    {
+        std::vector<int> cursor(reader_offsets.begin(), reader_offsets.end() - 1);
+        for (int g : combinational) {
+            const CompiledGate& gate = cc.gates[g];
+            readers[cursor[gate.in_a]++] = g;
+            indegree[g] += drivers[gate.in_a];
+            if (gate.in_b != gate.in_a) {
+                readers[cursor[gate.in_b]++] = g;
+                indegree[g] += drivers[gate.in_b];
+            }
+        }
+    }
+
+    bool multi_driven = false;
+    for (int s = 0; s < num_signals; ++s) multi_driven = multi_driven || drivers[s] > 1;
+
+    std::vector<int> frontier;
+    for (int g : combinational) {
+        if (indegree[g] == 0) frontier.push_back(g);
+    }
+    size_t scheduled = 0;
+    while (!frontier.empty()) {
+        // Same-op runs within a level, unless a net's drivers must keep
+        // their netlist order (the last write wins)
+        if (!multi_driven) {
+            std::stable_sort(frontier.begin(), frontier.end(),
+                             [&](int x, int y) { return cc.gates[x].op < cc.gates[y].op; });
+        }
+        std::vector<int> next;
+        for (int g : frontier) {
+            const CompiledGate& gate = cc.gates[g];
+            const int pos = static_cast<int>(cc.cycle_gates.size());
+            cc.cycle_gates.push_back(PackedGate{gate.op, gate.in_a, gate.in_b, gate.output_signal});
+            if (cc.cycle_runs.empty() || cc.cycle_runs.back().op != gate.op) {
+                cc.cycle_runs.push_back(GateRun{gate.op, pos, pos + 1});
+            } else {
+                cc.cycle_runs.back().end = pos + 1;
+            }
+            const int s = gate.output_signal;
+            for (int r = reader_offsets[s]; r < reader_offsets[s + 1]; ++r) {
+                if (--indegree[readers[r]] == 0) next.push_back(readers[r]);
+            }
+        }
+        scheduled += frontier.size();
+        std::sort(next.begin(), next.end());
+        frontier.swap(next);
+    }
+
+    if (scheduled != combinational.size()) {
+        cc.cycle_gates.clear();
+        cc.cycle_runs.clear();
+        return;
+    }
+    cc.cycle_levelized = true;
+}
+
+void FModel::addClock(const std::string& signal_name) {
+    if (std::find(clock_names.begin(), clock_names.end(), signal_name) == clock_names.end()) {
+        clock_names.push_back(signal_name);
+    }
+}
+
+void FModel::resetRegisters() {
+    std::fill(state.register_state.begin(), state.register_state.end(), LogicLevel::LOW);
+}
+
+bool FModel::bindClocks() {
+    // Resolve the clock names, and require every register to be clocked
+    // straight from one of them (or not at all)
+    if (!circuit.cycle_levelized) {
+        std::cerr << "Cycle-based simulation needs acyclic logic between registers" << std::endl;
+        return false;
+    }
+    if (clock_names.size() > MAX_CLOCKS) {
+        std::cerr << "Too many clocks (" << clock_names.size() << ", limit " << MAX_CLOCKS << ")" << std::endl;
+        return false;
+    }
+    clock_signals.clear();
+    for (const std::string& name : clock_names) {
+        const int signal = findSignal(name);
+        if (signal < 0) {
+            std::cerr << "Unknown clock net: " << name << std::endl;
+            return false;
+        }
+        clock_signals.push_back(signal);
+    }
+
+    register_clocks.assign(circuit.registers.size(), -1);
+    for (size_t r = 0; r < circuit.registers.size(); ++r) {
+        const CompiledRegister& reg = circuit.registers[r];
+        if (reg.clk < 0) continue;
+        auto it = std::find(clock_signals.begin(), clock_signals.end(), reg.clk);
+        if (it == clock_signals.end()) {
+            const CompiledGate& gate = circuit.gates[reg.gate];
+            std::cerr << "Flip-flop " << components[circuit.components[gate.component].instance]->instance_id
+                      << " (Q on pin " << gate.output_pin << ") is clocked by net " << signals[reg.clk]->name
+                      << ", which is not a named clock" << std::endl;
+            return false;
+        }
+        register_clocks[r] = static_cast<int>(it - clock_signals.begin());
+    }
+    return true;
+}
+
+void FModel::simulateCycles() {
+    // Vectors run in order on the live state: registers carry across them
+    for (size_t i = 0; i < test_vectors.size(); ++i) {
+        test_results[i] = runCycleVector(state, test_vectors[i]);
+    }
+}
+
+TestResult FModel::runCycleVector(SimulationState& sim, const TestVector& test_vector) const {
+    resetCircuit(sim);
+
+    // A clock the vector drives is held at that level instead of pulsed
+    const size_t num_clocks = clock_signals.size();
+    uint64_t pulsed = num_clocks == 64 ? ~uint64_t(0) : (uint64_t(1) << num_clocks) - 1;
+    for (const auto& input : test_vector.inputs) {
+        const int signal = findSignal(input.first);
+        if (signal < 0) continue;
+        sim.signal_levels[signal] = input.second;
+        for (size_t k = 0; k < num_clocks; ++k) {
+            if (clock_signals[k] == signal) pulsed &= ~(uint64_t(1) << k);
+        }
+    }
+    for (size_t k = 0; k < num_clocks; ++k) {
+        if ((pulsed >> k) & 1) sim.signal_levels[clock_signals[k]] = LogicLevel::LOW;
+    }
+
+    evaluateCycle(sim);
+    if (waveform) waveform->sample(sim.signal_levels.data());
+    if (test_vector.cycles == 0) {
+        // No edge: only the asynchronous controls act
+        clockRegisters(sim, 0);
+        evaluateCycle(sim);
+        if (waveform) {
+            waveform->sample(sim.signal_levels.data());
+            waveform->advance(1);
+        }
+    }
+    for (uint64_t cycle = 0; cycle < test_vector.cycles; ++cycle) {
+        clockRegisters(sim, pulsed);
+        evaluateCycle(sim);
+        if (waveform) traceClockEdge(sim, pulsed);
+    }
+    FMODEL_PROFILE_CALL(sim.profile, countToggles(sim.profile_levels, sim.signal_levels));
+
+    return checkOutputs(sim, test_vector);
+}
+
+void FModel::traceClockEdge(SimulationState& sim, uint64_t pulsed) const {
+    // Two time units per cycle: the pulsed clocks rise with the new register
+    // state at the first, and fall at the second
+    LogicLevel* levels = sim.signal_levels.data();
+    waveform->advance(1);
+    for (size_t k = 0; k < clock_signals.size(); ++k) {
+        if ((pulsed >> k) & 1) levels[clock_signals[k]] = LogicLevel::HIGH;
+    }
+    waveform->sample(levels);
+    for (size_t k = 0; k < clock_signals.size(); ++k) {
+        if ((pulsed >> k) & 1) levels[clock_signals[k]] = LogicLevel::LOW;
+    }
+    waveform->advance(1);
+    waveform->sample(levels);
+}
+
+void FModel::evaluateCycle(SimulationState& sim) const {
+    FMODEL_PROFILE_ADD(sim.profile, cycle_passes, 1);
+    FMODEL_PROFILE_ADD(sim.profile, gate_evaluations, circuit.cycle_gates.size());
+    LogicLevel* levels = sim.signal_levels.data();
+    for (size_t r = 0; r < circuit.registers.size(); ++r) {
+        if (circuit.registers[r].q >= 0) levels[circuit.registers[r].q] = sim.register_state[r];
+    }
+    for (const GateRun& run : circuit.cycle_runs) evaluateCycleRun(circuit.cycle_gates.data(), run, levels);
+}
+
+void FModel::clockRegisters(SimulationState& sim, uint64_t pulsed) const {
+    // Registers read only nets, and nets are not written until the next
+    // evaluateCycle(), so all of them sample the same edge
+    const LogicLevel* levels = sim.signal_levels.data();
+    auto level = [&](int signal, LogicLevel unconnected) { return signal >= 0 ? levels[signal] : unconnected; };
+    for (size_t r = 0; r < circuit.registers.size(); ++r) {
+        const CompiledRegister& reg = circuit.registers[r];
+        // Unconnected PRE/CLR float inactive, as in the part model
+        const LogicLevel pre_n = level(reg.pre_n, LogicLevel::HIGH);
+        const LogicLevel clr_n = level(reg.clr_n, LogicLevel::HIGH);
+        if (pre_n == LogicLevel::LOW && clr_n == LogicLevel::HIGH) {
+            sim.register_state[r] = LogicLevel::HIGH;
+        } else if (clr_n == LogicLevel::LOW && pre_n == LogicLevel::HIGH) {
+            sim.register_state[r] = LogicLevel::LOW;
+        } else if (register_clocks[r] >= 0 && ((pulsed >> register_clocks[r]) & 1)) {
+            const LogicLevel d = level(reg.d, LogicLevel::FLOATING);
+            if (d != LogicLevel::FLOATING) sim.register_state[r] = d;
+        }
+    }
+}
+
+} // namespace FModel
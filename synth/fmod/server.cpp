@@ -0,0 +1,441 @@
+/**
+ * @file server.cpp
+ * @brief Line-based simulation server over stdin or a Unix socket
+ *
+ * Protocol: one command per line, words separated by blanks (so paths
+ * cannot contain spaces), blank lines and lines starting with # ignored.
+ *
+ *   load NETLIST                     ok load NETLIST cache=hit|miss components=C nets=N gates=G
+ *   run NETLIST VECTORS [OPTION...]  queued J, later done J PASS|FAIL vectors=V failed=F cache=... ms=T
+ *   stimulus NETLIST GOLDEN exhaustive|random=N|equivalence [seed=S] [OPTION...]
+ *                                    queued J, later done J PASS|FAIL vectors=V mismatches=M cache=... ms=T
+ *   stats                            stats {JSON}
+ *   wait                             ok wait, once every job of the session has replied
+ *   quit                             ok quit, then the session ends
+ *   shutdown                         ok shutdown, then the server stops accepting sessions
+ *
+ * OPTION is event-driven, bit-parallel, optimize or clock=NAME, as the
+ * fmodel_sim options of the same names. A command that cannot run replies
+ * error [J] MESSAGE; the simulator's own diagnostics go to stderr. Jobs
+ * reply in the order they finish, not the order they were queued.
+ *
+ * Every job simulates on a model of its own, built from the in-memory image
+ * of the compiled circuit (FModel::importCircuit()), so jobs share nothing
+ * but that read-only image. A netlist whose modification time or size
+ * changed is compiled again; hierarchical netlists cannot be imaged and
+ * are loaded from the file by every job.
+ */
+
+#include "server.h"
+#include "thread_pool.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace FModel {
+
+namespace {
+
+bool parseCount(const std::string& text, uint64_t& value) {
+    if (text.empty() || text.size() > 19 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    value = std::stoull(text);
+    return true;
+}
+
+void writeAll(int fd, const std::string& data) {
+    // A client that went away only loses its replies
+    size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        done += static_cast<size_t>(n);
+    }
+}
+
+void writeJsonString(std::ostream& out, const std::string& str) {
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+// Applies the job options in words[first, end); stimulus takes seed=S too
+bool applyOptions(FModel& model, const std::vector<std::string>& words, size_t first, StimulusOptions* stimulus,
+                  std::string& error) {
+    for (size_t i = first; i < words.size(); ++i) {
+        const std::string& option = words[i];
+        uint64_t seed = 0;
+        if (option == "event-driven") {
+            model.setPropagationMode(PropagationMode::EVENT_DRIVEN);
+        } else if (option == "bit-parallel") {
+            model.setBitParallel(true);
+        } else if (option == "optimize") {
+            model.setOptimize(true);
+        } else if (option.rfind("clock=", 0) == 0 && option.size() > 6) {
+            model.addClock(option.substr(6));
+        } else if (stimulus && option.rfind("seed=", 0) == 0 && parseCount(option.substr(5), seed)) {
+            stimulus->seed = seed;
+        } else {
+            error = "unknown option: " + option;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+struct SimulationServer::Session {
+    explicit Session(int out_fd) : out_fd(out_fd) {}
+
+    void reply(const std::string& line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        writeAll(out_fd, line + "\n");
+    }
+
+    int out_fd;
+    std::mutex mutex;   // serializes replies and guards pending
+    std::condition_variable idle;
+    size_t pending = 0;   // jobs queued or running
+};
+
+SimulationServer::SimulationServer(int num_workers)
+    : started(std::chrono::steady_clock::now()), stopping(false), listen_fd(-1), shutting_down(false),
+      next_job(1), jobs_running(0), jobs_done(0), jobs_failed(0), job_errors(0), cache_hits(0), cache_misses(0) {
+    if (num_workers <= 0) num_workers = ThreadPool::hardwareThreads();
+    for (int i = 0; i < num_workers; ++i) workers.emplace_back(&SimulationServer::workerLoop, this);
+}
+
+SimulationServer::~SimulationServer() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_ready.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void SimulationServer::workerLoop() {
+    // Drains the queue before stopping
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_ready.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        job();
+    }
+}
+
+void SimulationServer::serve(int in_fd, int out_fd) {
+    Session session(out_fd);
+    std::string buffer;
+    char chunk[4096];
+    bool open = true;
+    bool at_end = false;
+    while (open) {
+        const size_t newline = buffer.find('\n');
+        if (newline == std::string::npos && !at_end) {
+            const ssize_t n = ::read(in_fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                at_end = true;
+            } else {
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            continue;
+        }
+        if (newline == std::string::npos && buffer.empty()) break;
+
+        // The last line may lack its newline
+        const std::string line = buffer.substr(0, newline);
+        buffer.erase(0, newline == std::string::npos ? buffer.size() : newline + 1);
+        std::istringstream tokens(line);
+        std::vector<std::string> words;
+        for (std::string word; tokens >> word;) words.push_back(word);
+        if (words.empty() || words[0][0] == '#') continue;
+        open = dispatch(session, words);
+    }
+
+    std::unique_lock<std::mutex> lock(session.mutex);
+    session.idle.wait(lock, [&session]() { return session.pending == 0; });
+}
+
+bool SimulationServer::dispatch(Session& session, const std::vector<std::string>& words) {
+    // Returns whether the session stays open
+    const std::string& command = words[0];
+    if (command == "load" && words.size() == 2) {
+        bool hit = false;
+        std::string error;
+        std::unique_ptr<FModel> model = loadModel(words[1], hit, error);
+        if (!model) {
+            session.reply("error " + error);
+        } else {
+            session.reply("ok load " + words[1] + " cache=" + (hit ? "hit" : "miss") + " components=" +
+                          std::to_string(model->getComponentCount()) + " nets=" + std::to_string(model->getSignalCount()) +
+                          " gates=" + std::to_string(model->getGateCount()));
+        }
+    } else if (command == "run") {
+        submit(session, [this, words](std::string& result) { return runVectors(words, result); });
+    } else if (command == "stimulus") {
+        submit(session, [this, words](std::string& result) { return runStimulus(words, result); });
+    } else if (command == "stats" && words.size() == 1) {
+        session.reply("stats " + stats());
+    } else if (command == "wait" && words.size() == 1) {
+        {
+            std::unique_lock<std::mutex> lock(session.mutex);
+            session.idle.wait(lock, [&session]() { return session.pending == 0; });
+        }
+        session.reply("ok wait");
+    } else if (command == "quit" && words.size() == 1) {
+        session.reply("ok quit");
+        return false;
+    } else if (command == "shutdown" && words.size() == 1) {
+        session.reply("ok shutdown");
+        stop();
+        return false;
+    } else {
+        session.reply("error unknown command: " + command + (words.size() > 1 ? " ..." : ""));
+    }
+    return true;
+}
+
+void SimulationServer::submit(Session& session, std::function<bool(std::string&)> job) {
+    const uint64_t id = next_job++;
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        session.pending++;
+    }
+    // Replied before the job is visible to a worker, so it precedes the result
+    session.reply("queued " + std::to_string(id));
+
+    auto run = [this, &session, id, job = std::move(job)]() {
+        jobs_running++;
+        const auto start = std::chrono::steady_clock::now();
+        std::string result;
+        const bool ran = job(result);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        jobs_running--;
+        if (!ran) {
+            job_errors++;
+            session.reply("error " + std::to_string(id) + " " + result);
+        } else {
+            jobs_done++;
+            if (result.rfind("FAIL", 0) == 0) jobs_failed++;
+            std::ostringstream line;
+            line << "done " << id << " " << result << " ms=" << ms;
+            session.reply(line.str());
+        }
+        std::lock_guard<std::mutex> lock(session.mutex);
+        if (--session.pending == 0) session.idle.notify_all();
+    };
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue.push_back(std::move(run));
+    }
+    queue_ready.notify_one();
+}
+
+std::unique_ptr<FModel> SimulationServer::loadModel(const std::string& path, bool& hit, std::string& error) {
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0) {
+        error = "cannot open netlist " + path;
+        return nullptr;
+    }
+    const int64_t mtime_ns = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    const int64_t size = static_cast<int64_t>(info.st_size);
+
+    std::shared_ptr<const CachedCircuit> cached;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = circuits.find(path);
+        if (it != circuits.end() && it->second->mtime_ns == mtime_ns && it->second->size == size) cached = it->second;
+    }
+
+    auto model = std::make_unique<FModel>();
+    model->setReportLevel(ReportLevel::SILENT);
+    hit = cached && !cached->image.empty() && model->importCircuit(cached->image);
+    if (hit) {
+        cache_hits++;
+        return model;
+    }
+    cache_misses++;
+    if (!model->loadFromNetlist(path)) {
+        error = "cannot load netlist " + path;
+        return nullptr;
+    }
+
+    // Concurrent misses on one netlist each compile it; the last one wins
+    auto entry = std::make_shared<CachedCircuit>();
+    entry->mtime_ns = mtime_ns;
+    entry->size = size;
+    if (!model->exportCircuit(entry->image)) entry->image.clear();
+    entry->components = model->getComponentCount();
+    entry->nets = model->getSignalCount();
+    entry->gates = model->getGateCount();
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    circuits[path] = std::move(entry);
+    return model;
+}
+
+bool SimulationServer::runVectors(const std::vector<std::string>& words, std::string& result) {
+    // run NETLIST VECTORS [OPTION...]
+    if (words.size() < 3) {
+        result = "usage: run NETLIST VECTORS [OPTION...]";
+        return false;
+    }
+    bool hit = false;
+    std::unique_ptr<FModel> model = loadModel(words[1], hit, result);
+    if (!model || !applyOptions(*model, words, 3, nullptr, result)) return false;
+    if (!model->loadTestVectors(words[2])) {
+        result = "cannot load test vectors " + words[2];
+        return false;
+    }
+    const bool passed = model->simulate();
+    result = std::string(passed ? "PASS" : "FAIL") + " vectors=" + std::to_string(model->getVectorCount()) +
+             " failed=" + std::to_string(model->getFailedCount()) + " cache=" + (hit ? "hit" : "miss");
+    return true;
+}
+
+bool SimulationServer::runStimulus(const std::vector<std::string>& words, std::string& result) {
+    // stimulus NETLIST GOLDEN exhaustive|random=N|equivalence [seed=S] [OPTION...]
+    if (words.size() < 4) {
+        result = "usage: stimulus NETLIST GOLDEN exhaustive|random=N|equivalence [seed=S] [OPTION...]";
+        return false;
+    }
+    StimulusOptions options;
+    const std::string& mode = words[3];
+    const bool equivalence = mode == "equivalence";
+    if (mode == "exhaustive" || equivalence) {
+        options.mode = StimulusMode::EXHAUSTIVE;
+    } else if (mode.rfind("random=", 0) == 0 && parseCount(mode.substr(7), options.count)) {
+        options.mode = StimulusMode::RANDOM;
+    } else {
+        result = "unknown stimulus: " + mode;
+        return false;
+    }
+
+    bool hit = false, golden_hit = false;
+    std::unique_ptr<FModel> model = loadModel(words[1], hit, result);
+    if (!model || !applyOptions(*model, words, 4, &options, result)) return false;
+    std::unique_ptr<FModel> golden = loadModel(words[2], golden_hit, result);
+    if (!golden) return false;
+
+    StimulusReport report;
+    const bool passed = equivalence ? model->checkEquivalence(options, *golden, report)
+                                    : model->checkStimulus(options, *golden, report);
+    if (!passed && report.vectors == 0) {
+        result = "stimulus check of " + words[1] + " against " + words[2] + " did not run";
+        return false;
+    }
+    result = std::string(passed ? "PASS" : "FAIL") + " vectors=" + std::to_string(report.vectors) +
+             " mismatches=" + std::to_string(report.mismatches) + " cache=" + (hit && golden_hit ? "hit" : "miss");
+    return true;
+}
+
+std::string SimulationServer::stats() {
+    std::ostringstream out;
+    size_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queued = queue.size();
+    }
+    out << "{\"uptime_s\": " << std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count()
+        << ", \"workers\": " << workers.size()
+        << ", \"jobs\": {\"queued\": " << queued << ", \"running\": " << jobs_running.load()
+        << ", \"done\": " << jobs_done.load() << ", \"failed\": " << jobs_failed.load()
+        << ", \"errors\": " << job_errors.load() << "}"
+        << ", \"cache\": {\"hits\": " << cache_hits.load() << ", \"misses\": " << cache_misses.load() << ", \"circuits\": [";
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    bool first = true;
+    for (const auto& entry : circuits) {
+        out << (first ? "" : ", ") << "{\"path\": ";
+        writeJsonString(out, entry.first);
+        out << ", \"components\": " << entry.second->components << ", \"nets\": " << entry.second->nets
+            << ", \"gates\": " << entry.second->gates << ", \"image_bytes\": " << entry.second->image.size() << "}";
+        first = false;
+    }
+    out << "]}}";
+    return out.str();
+}
+
+bool SimulationServer::listen(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid socket path: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Cannot create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 16) != 0) {
+        std::cerr << "Cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    // A client closing early must not kill the server mid-reply
+    std::signal(SIGPIPE, SIG_IGN);
+    {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        listen_fd = fd;
+    }
+
+    std::vector<std::thread> sessions;
+    while (!shutting_down) {
+        const int connection = ::accept(fd, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(session_mutex);
+        if (shutting_down) {
+            ::close(connection);
+            break;
+        }
+        session_fds.insert(connection);
+        sessions.emplace_back([this, connection]() {
+            serve(connection, connection);
+            std::lock_guard<std::mutex> lock(session_mutex);
+            session_fds.erase(connection);
+            ::close(connection);
+        });
+    }
+    for (auto& session : sessions) session.join();
+    {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        listen_fd = -1;
+    }
+    ::close(fd);
+    ::unlink(path.c_str());
+    return true;
+}
+
+void SimulationServer::stop() {
+    // Wakes accept() and ends the input of every open session; their
+    // queued jobs still finish and reply
+    std::lock_guard<std::mutex> lock(session_mutex);
+    shutting_down = true;
+    if (listen_fd >= 0) ::shutdown(listen_fd, SHUT_RDWR);
+    for (int fd : session_fds) ::shutdown(fd, SHUT_RD);
+}
+
+} // namespace FModel
@@ -0,0 +1,109 @@
+/**
+ * @file server.h
+ * @brief Long-running simulation server: load netlists once, run many jobs
+ *
+ * Commands arrive one per line, on stdin or on connections to a Unix
+ * socket, and every reply is one line. Compiled circuits are kept in memory
+ * keyed by netlist path and modification time, so a netlist is parsed and
+ * compiled once however many jobs use it. Jobs (`run` and `stimulus`) are
+ * queued to a pool of worker threads and reply when they finish, tagged
+ * with the number they were given; jobs of any session run concurrently.
+ * See the protocol in server.cpp.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "fmodel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace FModel {
+
+class SimulationServer {
+public:
+    /**
+     * @brief Server with num_workers job threads; 0 means one per hardware
+     *        thread
+     */
+    explicit SimulationServer(int num_workers);
+    ~SimulationServer();
+
+    SimulationServer(const SimulationServer&) = delete;
+    SimulationServer& operator=(const SimulationServer&) = delete;
+
+    /**
+     * @brief Serve one session: read commands from in_fd and reply on
+     *        out_fd until quit, shutdown or end of input, then wait for the
+     *        session's jobs
+     */
+    void serve(int in_fd, int out_fd);
+
+    /**
+     * @brief Accept sessions on a Unix socket at path, each served on a
+     *        thread of its own, until a session sends shutdown
+     */
+    bool listen(const std::string& path);
+
+private:
+    struct CachedCircuit {
+        int64_t mtime_ns;
+        int64_t size;
+        std::string image;   // FModel::exportCircuit(); empty for a hierarchy
+        size_t components;
+        size_t nets;
+        size_t gates;
+    };
+    struct Session;
+
+    bool dispatch(Session& session, const std::vector<std::string>& words);
+    // Queues job; it returns false with an error message, else its result
+    void submit(Session& session, std::function<bool(std::string&)> job);
+    void workerLoop();
+    std::unique_ptr<FModel> loadModel(const std::string& path, bool& hit, std::string& error);
+    bool runVectors(const std::vector<std::string>& words, std::string& result);
+    bool runStimulus(const std::vector<std::string>& words, std::string& result);
+    std::string stats();
+    void stop();
+
+    const std::chrono::steady_clock::time_point started;
+
+    // Compiled circuits by netlist path
+    std::mutex cache_mutex;
+    std::map<std::string, std::shared_ptr<const CachedCircuit>> circuits;
+
+    // Job queue and its workers
+    std::mutex queue_mutex;
+    std::condition_variable queue_ready;
+    std::deque<std::function<void()>> queue;
+    std::vector<std::thread> workers;
+    bool stopping;
+
+    // Socket sessions, woken by a shutdown
+    std::mutex session_mutex;
+    std::set<int> session_fds;
+    int listen_fd;
+    std::atomic<bool> shutting_down;
+
+    std::atomic<uint64_t> next_job;
+    std::atomic<uint64_t> jobs_running;
+    std::atomic<uint64_t> jobs_done;
+    std::atomic<uint64_t> jobs_failed;   // done, with a FAIL result
+    std::atomic<uint64_t> job_errors;    // could not run
+    std::atomic<uint64_t> cache_hits;
+    std::atomic<uint64_t> cache_misses;
+};
+
+} // namespace FModel
+
+#endif // SERVER_H
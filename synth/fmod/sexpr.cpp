@@ -0,0 +1,82 @@
+/**
+ * @file sexpr.cpp
+ * @brief Single-pass S-expression tokenizer
+ */
+
+#include "sexpr.h"
+
+namespace FModel {
+
+SExprTokenizer::Token SExprTokenizer::next() {
+    const size_t size = input.size();
+    while (pos < size) {
+        const char c = input[pos];
+        if (c == '\n') {
+            line_number++;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            break;
+        }
+        pos++;
+    }
+    if (pos >= size) return Token{TokenType::END, std::string_view()};
+
+    const char c = input[pos];
+    if (c == '(') return Token{TokenType::OPEN, input.substr(pos++, 1)};
+    if (c == ')') return Token{TokenType::CLOSE, input.substr(pos++, 1)};
+
+    if (c == '"') {
+        const size_t start = ++pos;
+        while (pos < size && input[pos] != '"') {
+            if (input[pos] == '\\' && pos + 1 < size) pos++;
+            if (input[pos] == '\n') line_number++;
+            pos++;
+        }
+        if (pos >= size) return fail("unterminated string");
+        return Token{TokenType::STRING, input.substr(start, pos++ - start)};
+    }
+
+    const size_t start = pos;
+    while (pos < size) {
+        const char a = input[pos];
+        if (a == '(' || a == ')' || a == '"' || a == ' ' || a == '\t' || a == '\r' || a == '\n') break;
+        pos++;
+    }
+    return Token{TokenType::ATOM, input.substr(start, pos - start)};
+}
+
+bool SExprTokenizer::skipList() {
+    int depth = 1;
+    while (depth > 0) {
+        const Token token = next();
+        switch (token.type) {
+            case TokenType::OPEN:  depth++; break;
+            case TokenType::CLOSE: depth--; break;
+            case TokenType::END:   fail("unexpected end of file"); return false;
+            case TokenType::ERROR: return false;
+            default: break;
+        }
+    }
+    return true;
+}
+
+bool SExprTokenizer::readValue(std::string_view& value) {
+    const Token token = next();
+    if (token.type == TokenType::CLOSE) {
+        value = std::string_view();
+        return true;
+    }
+    if (token.type != TokenType::ATOM && token.type != TokenType::STRING) {
+        if (token.type != TokenType::ERROR) fail("expected a value");
+        return false;
+    }
+    value = token.text;
+    return skipList();
+}
+
+SExprTokenizer::Token SExprTokenizer::fail(const char* message) {
+    if (!error_message) error_message = message;
+    pos = input.size();
+    return Token{TokenType::ERROR, std::string_view()};
+}
+
+} // namespace FModel
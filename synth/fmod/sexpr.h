@@ -0,0 +1,62 @@
+/**
+ * @file sexpr.h
+ * @brief Single-pass tokenizer for S-expression files (KiCad netlists)
+ *
+ * Tokens are views into the input buffer, which must outlive the tokenizer;
+ * nothing is copied or allocated while scanning.
+ */
+
+#ifndef SEXPR_H
+#define SEXPR_H
+
+#include <string_view>
+
+namespace FModel {
+
+class SExprTokenizer {
+public:
+    enum class TokenType {
+        OPEN,      // (
+        CLOSE,     // )
+        ATOM,      // bare word, e.g. comp, 74HC08, 14
+        STRING,    // "quoted" (text excludes the quotes, escapes left as-is)
+        END,
+        ERROR
+    };
+
+    struct Token {
+        TokenType type;
+        std::string_view text;
+    };
+
+    explicit SExprTokenizer(std::string_view input) : input(input), pos(0), line_number(1), error_message(nullptr) {}
+
+    Token next();
+
+    /**
+     * @brief Skip the rest of the current list, up to and including the
+     *        CLOSE that matches an already consumed OPEN
+     */
+    bool skipList();
+
+    /**
+     * @brief Read the single value of a `(key value)` field whose key has
+     *        been consumed, then skip anything else up to its CLOSE
+     */
+    bool readValue(std::string_view& value);
+
+    int line() const { return line_number; }
+    const char* error() const { return error_message; }
+
+private:
+    Token fail(const char* message);
+
+    std::string_view input;
+    size_t pos;
+    int line_number;
+    const char* error_message;
+};
+
+} // namespace FModel
+
+#endif // SEXPR_H
@@ -16,11 +16,11 @@ int main() {
     FModel::FModel model;
     
     // Create signals
-    auto a_signal = model.createSignal("a", true, false);
-    auto b_signal = model.createSignal("b", true, false);
-    auto cin_signal = model.createSignal("cin", true, false);
-    auto sum_signal = model.createSignal("sum", false, true);
-    auto cout_signal = model.createSignal("cout", false, true);
+    model.createSignal("a", true, false);
+    model.createSignal("b", true, false);
+    model.createSignal("cin", true, false);
+    model.createSignal("sum", false, true);
+    model.createSignal("cout", false, true);
     
     // Create components
     model.addComponent("U1", "74HC86", "DIP-14");  // XOR gate for sum
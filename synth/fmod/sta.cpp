@@ -0,0 +1,188 @@
+/**
+ * @file sta.cpp
+ * @brief Static longest-path timing over the compiled gate graph
+ *
+ * No vectors are simulated. Every net gets the latest time a change can
+ * reach it: primary inputs switch at 0, flip-flop outputs one clock-to-Q
+ * delay after their clock, and a gate output one part delay after the
+ * latest of its inputs. Gates are visited once in topological order
+ * (Kahn's algorithm, flip-flops cut as in the cycle-based schedule), so the
+ * pass is linear in the size of the netlist. Timing endpoints are the
+ * primary outputs and the flip-flop D inputs; each keeps the input net its
+ * latest arrival came through, which is all a path walk needs.
+ */
+
+#include "fmodel.h"
+#include "component_base.h"
+#include <cstdio>
+
+namespace FModel {
+
+namespace {
+
+std::string formatDelay(double ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f", ns);
+    return text;
+}
+
+} // namespace
+
+bool FModel::analyzeTiming(size_t max_paths, StaticTimingReport& report) {
+    report = StaticTimingReport();
+    if (!simulation_ready || (!compiled && !compile()) || !flattenFor("Static timing analysis")) {
+        std::cerr << "Circuit not ready for timing analysis!" << std::endl;
+        return false;
+    }
+
+    const int num_signals = static_cast<int>(signals.size());
+    const int num_gates = static_cast<int>(circuit.gates.size());
+    auto gateDelay = [&](const CompiledGate& gate) {
+        return circuit.components[gate.component].component->getPropagationDelay();
+    };
+
+    // Arrival of every net, -1 when no input or register can change it; from[s]
+    // is the net the latest arrival came through and start[s] where it began
+    std::vector<double> arrival(num_signals, -1);
+    std::vector<int> from(num_signals, -1);
+    std::vector<int> start(num_signals, -1);
+    for (int s = 0; s < num_signals; ++s) {
+        if (signals[s]->is_input) {
+            arrival[s] = 0;
+            start[s] = s;
+        }
+    }
+    for (const CompiledRegister& reg : circuit.registers) {
+        if (reg.q < 0) continue;
+        const double clock_to_q = gateDelay(circuit.gates[reg.gate]);
+        if (clock_to_q > arrival[reg.q]) {
+            arrival[reg.q] = clock_to_q;
+            from[reg.q] = reg.clk;
+            start[reg.q] = reg.clk >= 0 ? reg.clk : reg.q;
+        }
+    }
+
+    // Readers and driver counts of the combinational gates
+    std::vector<int> drivers(num_signals, 0);
+    std::vector<int> reader_offsets(num_signals + 1, 0);
+    for (const CompiledGate& gate : circuit.gates) {
+        if (gate.op == GateOp::DFF) continue;
+        drivers[gate.output_signal]++;
+        reader_offsets[gate.in_a + 1]++;
+        if (gate.in_b != gate.in_a) reader_offsets[gate.in_b + 1]++;
+    }
+    for (int s = 0; s < num_signals; ++s) reader_offsets[s + 1] += reader_offsets[s];
+    std::vector<int> readers(reader_offsets[num_signals]);
+    std::vector<int> indegree(num_gates, 0);
+    std::vector<int> frontier;
+    {
+        std::vector<int> cursor(reader_offsets.begin(), reader_offsets.end() - 1);
+        for (int g = 0; g < num_gates; ++g) {
+            const CompiledGate& gate = circuit.gates[g];
+            if (gate.op == GateOp::DFF) continue;
+            readers[cursor[gate.in_a]++] = g;
+            indegree[g] += drivers[gate.in_a];
+            if (gate.in_b != gate.in_a) {
+                readers[cursor[gate.in_b]++] = g;
+                indegree[g] += drivers[gate.in_b];
+            }
+            if (indegree[g] == 0) frontier.push_back(g);
+        }
+    }
+
+    // One visit per gate: by the time a gate leaves the frontier, every
+    // driver of its inputs has been visited
+    size_t combinational = 0;
+    for (const CompiledGate& gate : circuit.gates) combinational += gate.op != GateOp::DFF;
+    while (!frontier.empty()) {
+        const int g = frontier.back();
+        frontier.pop_back();
+        report.timed_gates++;
+        const CompiledGate& gate = circuit.gates[g];
+        const int latest = arrival[gate.in_b] > arrival[gate.in_a] ? gate.in_b : gate.in_a;
+        const int out = gate.output_signal;
+        if (arrival[latest] >= 0 && arrival[latest] + gateDelay(gate) > arrival[out]) {
+            arrival[out] = arrival[latest] + gateDelay(gate);
+            from[out] = latest;
+            start[out] = start[latest];
+        }
+        for (int r = reader_offsets[out]; r < reader_offsets[out + 1]; ++r) {
+            if (--indegree[readers[r]] == 0) frontier.push_back(readers[r]);
+        }
+    }
+    report.loop_gates = combinational - report.timed_gates;
+
+    // Endpoints, slowest first
+    std::vector<char> endpoint(num_signals, 0);
+    for (int s = 0; s < num_signals; ++s) {
+        if (signals[s]->is_output) endpoint[s] = 1;
+    }
+    for (const CompiledRegister& reg : circuit.registers) {
+        if (reg.d >= 0 && !endpoint[reg.d]) endpoint[reg.d] = 2;
+    }
+    std::vector<int> order;
+    for (int s = 0; s < num_signals; ++s) {
+        if (endpoint[s]) order.push_back(s);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return arrival[a] > arrival[b]; });
+    for (int s : order) {
+        report.endpoints.push_back(TimingEndpoint{signals[s]->getName(),
+                                                  start[s] >= 0 ? signals[start[s]]->getName() : std::string(),
+                                                  arrival[s], endpoint[s] == 2});
+    }
+
+    // Full paths of the slowest endpoints
+    for (size_t i = 0; i < order.size() && report.paths.size() < max_paths; ++i) {
+        const int end = order[i];
+        if (arrival[end] < 0) break;
+        TimingPath path;
+        path.delay_ns = arrival[end];
+        for (int s = end; s >= 0 && path.steps.size() < signals.size(); s = from[s]) {
+            path.steps.push_back(TimingPathStep{signals[s]->getName(), arrival[s]});
+        }
+        std::reverse(path.steps.begin(), path.steps.end());
+        report.paths.push_back(std::move(path));
+    }
+
+    if (report_level != ReportLevel::SILENT) printStaticTimingReport(report);
+    return true;
+}
+
+void FModel::printStaticTimingReport(const StaticTimingReport& report) const {
+    std::cout << "\n=== Static Timing Report ===" << std::endl;
+    std::cout << "Gates: " << report.timed_gates << " timed";
+    if (report.loop_gates > 0) std::cout << ", " << report.loop_gates << " on combinational loops (not timed)";
+    std::cout << "; " << report.endpoints.size() << " endpoints" << std::endl;
+
+    if (report.paths.empty()) {
+        std::cout << "No path reaches an endpoint" << std::endl;
+    } else {
+        const TimingPath& worst = report.paths.front();
+        std::cout << "Longest path: " << formatDelay(worst.delay_ns) << " ns (" << worst.steps.front().signal
+                  << " -> " << worst.steps.back().signal << ")";
+        if (worst.delay_ns > 0) std::cout << ", max input rate " << formatDelay(1000.0 / worst.delay_ns) << " MHz";
+        std::cout << std::endl;
+        std::cout << "Critical paths:" << std::endl;
+        for (size_t i = 0; i < report.paths.size(); ++i) {
+            const TimingPath& path = report.paths[i];
+            std::cout << "  " << (i + 1) << ". " << formatDelay(path.delay_ns) << " ns:";
+            for (size_t k = 0; k < path.steps.size(); ++k) {
+                std::cout << (k ? " -> " : " ") << path.steps[k].signal << " @" << formatDelay(path.steps[k].arrival_ns);
+            }
+            std::cout << std::endl;
+        }
+    }
+    if (report_level != ReportLevel::VERBOSE && report_level != ReportLevel::FAILURES) return;
+
+    std::cout << "Endpoints:" << std::endl;
+    for (const TimingEndpoint& end : report.endpoints) {
+        std::cout << "  " << end.signal << (end.registered ? " (flip-flop D)" : "") << ": ";
+        if (end.delay_ns < 0) {
+            std::cout << "no path" << std::endl;
+        } else {
+            std::cout << formatDelay(end.delay_ns) << " ns from " << end.startpoint << std::endl;
+        }
+    }
+}
+
+} // namespace FModel
@@ -0,0 +1,404 @@
+/**
+ * @file stimulus.cpp
+ * @brief Built-in exhaustive and random stimulus checked against a golden model
+ */
+
+#include "stimulus.h"
+#include "bitparallel.h"
+#include "profile.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+namespace FModel {
+
+namespace {
+
+constexpr size_t PASSES_PER_TASK = 4;   // kernel passes per thread and chunk
+
+// Exhaustive patterns of the six inputs that change within one 64-lane word
+constexpr uint64_t LANE_PATTERNS[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+LogicLevel planeLevel(const uint64_t* value, const uint64_t* z, size_t word, unsigned bit) {
+    if ((z[word] >> bit) & 1) return LogicLevel::FLOATING;
+    return ((value[word] >> bit) & 1) ? LogicLevel::HIGH : LogicLevel::LOW;
+}
+
+void setPlaneLevel(uint64_t* value, uint64_t* z, size_t word, unsigned bit, LogicLevel level) {
+    const uint64_t mask = uint64_t(1) << bit;
+    if (level == LogicLevel::HIGH) value[word] |= mask;
+    if (level == LogicLevel::FLOATING) z[word] |= mask;
+}
+
+} // namespace
+
+StimulusGenerator::StimulusGenerator(const StimulusOptions& options, size_t num_inputs)
+    : mode(options.mode), num_inputs(num_inputs),
+      total(options.mode == StimulusMode::EXHAUSTIVE ? uint64_t(1) << num_inputs : options.count),
+      state(options.seed ? options.seed : 0x9E3779B97F4A7C15ULL) {}
+
+uint64_t StimulusGenerator::next() {
+    // xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+void StimulusGenerator::fill(uint64_t first, size_t words, uint64_t* planes) {
+    for (size_t w = 0; w < words; ++w) {
+        const uint64_t base = first + 64 * w;
+        const uint64_t lanes = base < total ? std::min<uint64_t>(64, total - base) : 0;
+        const uint64_t mask = lanes == 64 ? ~uint64_t(0) : (uint64_t(1) << lanes) - 1;
+        for (size_t i = 0; i < num_inputs; ++i) {
+            uint64_t bits = 0;
+            if (lanes == 0) {
+                bits = 0;
+            } else if (mode == StimulusMode::RANDOM) {
+                bits = next();
+            } else if (i < 6) {
+                bits = LANE_PATTERNS[i];
+            } else {
+                bits = ((base >> i) & 1) ? ~uint64_t(0) : 0;
+            }
+            planes[i * words + w] = bits & mask;
+        }
+    }
+}
+
+std::vector<int> FModel::stimulusSignals(bool outputs) const {
+    // Primary inputs are the JIN_ nets (outputs the JOUT_ nets), in netlist order
+    std::vector<int> result;
+    for (const auto& signal : signals) {
+        if (signal->index == circuit.vcc_signal || signal->index == circuit.gnd_signal) continue;
+        if (outputs ? signal->is_output : signal->is_input) result.push_back(signal->index);
+    }
+    return result;
+}
+
+std::vector<std::string> FModel::getInputNames() const {
+    std::vector<std::string> names;
+    for (int signal : stimulusSignals(false)) names.push_back(signals[signal]->getName());
+    return names;
+}
+
+std::vector<std::string> FModel::getOutputNames() const {
+    std::vector<std::string> names;
+    for (int signal : stimulusSignals(true)) names.push_back(signals[signal]->getName());
+    return names;
+}
+
+void FModel::simulatePlanes(SimulationState& sim, const PackedKernel& kernel, const std::vector<int>& inputs,
+                            const uint64_t* input_planes, size_t lanes, const std::vector<int>& outputs,
+                            uint64_t* value, uint64_t* z) const {
+    // Drive inputs[k] with input_planes[k * W ...] and read outputs[k] (signal
+    // index, or -1 for a net this circuit lacks) into value/z[k * W ...]
+    const size_t words = static_cast<size_t>(kernel.words);
+    bool packable = circuit.bit_parallel;
+    for (int signal : inputs) packable = packable && !circuit.dead_signals[signal];
+
+    if (packable) {
+        resetPackedState(sim, words);
+        for (size_t k = 0; k < inputs.size(); ++k) {
+            for (size_t w = 0; w < words; ++w) {
+                sim.packed_value[inputs[k] * words + w] = input_planes[k * words + w];
+                sim.packed_z[inputs[k] * words + w] = 0;
+            }
+        }
+        evaluatePackedSchedule(sim, kernel);
+        for (size_t k = 0; k < outputs.size(); ++k) {
+            for (size_t w = 0; w < words; ++w) {
+                value[k * words + w] = outputs[k] >= 0 ? sim.packed_value[outputs[k] * words + w] : 0;
+                z[k * words + w] = outputs[k] >= 0 ? sim.packed_z[outputs[k] * words + w] : ~uint64_t(0);
+            }
+        }
+        return;
+    }
+
+    // Scalar fallback (loops, flip-flops, driven dead nets), lane by lane in
+    // vector order so register state carries as it would from a file
+    std::fill(value, value + outputs.size() * words, 0);
+    std::fill(z, z + outputs.size() * words, 0);
+    const bool levelized = circuit.levelized && propagation_mode == PropagationMode::LEVELIZED;
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        const size_t word = lane / 64;
+        const unsigned bit = lane % 64;
+        resetCircuit(sim);
+        bool single_pass = levelized;
+        for (size_t k = 0; k < inputs.size(); ++k) {
+            sim.signal_levels[inputs[k]] = ((input_planes[k * words + word] >> bit) & 1) ? LogicLevel::HIGH : LogicLevel::LOW;
+            if (circuit.dead_signals[inputs[k]]) single_pass = false;
+        }
+        if (!module_instances.empty()) {
+            // A golden model keeps its hierarchy
+            evaluateHierarchy(sim, sim.signal_levels.data());
+        } else if (single_pass) {
+            evaluateLevelized(sim);
+        } else {
+            propagateSignals(sim);
+        }
+        for (size_t k = 0; k < outputs.size(); ++k) {
+            const LogicLevel level = outputs[k] >= 0 ? sim.signal_levels[outputs[k]] : LogicLevel::FLOATING;
+            setPlaneLevel(value + k * words, z + k * words, word, bit, level);
+        }
+    }
+}
+
+bool FModel::runStimulus(const StimulusOptions& options, const std::string& golden_name, const GoldenBlock& golden,
+                         int golden_slots, StimulusReport& report) {
+    report = StimulusReport();
+    const std::vector<int> inputs = stimulusSignals(false);
+    const std::vector<int> outputs = stimulusSignals(true);
+    if (optimize_gates) {
+        optimizeCircuit({}, false);   // primary inputs and outputs are always kept
+    } else if (!unoptimize()) {
+        return false;
+    }
+    if (options.mode == StimulusMode::EXHAUSTIVE && inputs.size() > MAX_EXHAUSTIVE_INPUTS) {
+        std::cerr << "Exhaustive stimulus over " << inputs.size() << " inputs is too large (limit "
+                  << MAX_EXHAUSTIVE_INPUTS << "); use random stimulus" << std::endl;
+        return false;
+    }
+
+    StimulusGenerator generator(options, inputs.size());
+    const PackedKernel kernel = selectPackedKernel(packed_backend);
+    const size_t words = static_cast<size_t>(kernel.words);
+    const uint64_t lanes_per_pass = 64 * words;
+    const uint64_t total = generator.size();
+
+    // Passes are split across the threads when both circuits are packed;
+    // each task then runs on a state of its own, without the level barrier
+    const int tasks = thread_pool && circuit.bit_parallel ? std::min(thread_pool->size(), golden_slots) : 1;
+    const size_t passes_per_chunk = tasks > 1 ? static_cast<size_t>(tasks) * PASSES_PER_TASK : 1;
+    std::vector<SimulationState> task_states;
+    for (int t = 0; tasks > 1 && t < tasks; ++t) task_states.push_back(makeState());
+
+    const bool print = report_level != ReportLevel::SILENT;
+    if (print) {
+        std::cout << "\n=== Stimulus Check ===" << std::endl;
+        if (options.mode == StimulusMode::EXHAUSTIVE) {
+            std::cout << "Exhaustive: " << inputs.size() << " inputs, " << total << " vectors" << std::endl;
+        } else {
+            std::cout << "Random: " << total << " vectors over " << inputs.size() << " inputs (seed " << options.seed << ")" << std::endl;
+        }
+        std::cout << "Golden: " << golden_name << std::endl;
+        if (circuit.bit_parallel) {
+            std::cout << "Bit-parallel backend: " << kernel.name << " (" << lanes_per_pass << " vectors per pass)" << std::endl;
+        } else {
+            std::cout << "Circuit is not bit-parallel; simulating one vector at a time" << std::endl;
+        }
+        if (tasks > 1) std::cout << "Threads: " << tasks << " (passes split across threads)" << std::endl;
+    }
+
+    // One slot per pass of a chunk
+    const size_t input_words = inputs.size() * words;
+    const size_t output_words = outputs.size() * words;
+    std::vector<uint64_t> input_planes(input_words * passes_per_chunk);
+    std::vector<uint64_t> value(output_words * passes_per_chunk), z(output_words * passes_per_chunk);
+    std::vector<uint64_t> golden_value(output_words * passes_per_chunk), golden_z(output_words * passes_per_chunk);
+
+    FMODEL_PROFILE_ADD(profile.get(), vectors, total);
+    for (uint64_t chunk = 0; chunk < total; chunk += lanes_per_pass * passes_per_chunk) {
+        FMODEL_PROFILE_SCOPE(profile.get(), SIMULATE);
+        const size_t passes = static_cast<size_t>(std::min<uint64_t>(passes_per_chunk, (total - chunk + lanes_per_pass - 1) / lanes_per_pass));
+        // The generator is sequential, so the chunk's patterns come first
+        for (size_t p = 0; p < passes; ++p) {
+            generator.fill(chunk + p * lanes_per_pass, words, input_planes.data() + p * input_words);
+        }
+        auto simulatePasses = [&](int task) {
+            SimulationState& sim = tasks > 1 ? task_states[task] : state;
+            for (size_t p = static_cast<size_t>(task); p < passes; p += static_cast<size_t>(tasks)) {
+                const size_t lanes = static_cast<size_t>(std::min(lanes_per_pass, total - chunk - p * lanes_per_pass));
+                const uint64_t* in = input_planes.data() + p * input_words;
+                simulatePlanes(sim, kernel, inputs, in, lanes, outputs, value.data() + p * output_words, z.data() + p * output_words);
+                golden(task, in, lanes, golden_value.data() + p * output_words, golden_z.data() + p * output_words);
+            }
+        };
+        if (tasks > 1) {
+            thread_pool->parallelFor(tasks, simulatePasses);
+        } else {
+            simulatePasses(0);
+        }
+
+        // Compared in vector order, so the counterexamples are the first ones
+        for (size_t p = 0; p < passes; ++p) {
+            const uint64_t first = chunk + p * lanes_per_pass;
+            const size_t lanes = static_cast<size_t>(std::min(lanes_per_pass, total - first));
+            const uint64_t* in = input_planes.data() + p * input_words;
+            const uint64_t* out_value = value.data() + p * output_words;
+            const uint64_t* out_z = z.data() + p * output_words;
+            const uint64_t* good_value = golden_value.data() + p * output_words;
+            const uint64_t* good_z = golden_z.data() + p * output_words;
+            for (size_t w = 0; w * 64 < lanes; ++w) {
+                const size_t lanes_in_word = std::min<size_t>(64, lanes - w * 64);
+                uint64_t diff = 0;
+                for (size_t k = 0; k < outputs.size(); ++k) {
+                    const size_t word = k * words + w;
+                    diff |= (out_value[word] ^ good_value[word]) | (out_z[word] ^ good_z[word]);
+                }
+                if (lanes_in_word < 64) diff &= (uint64_t(1) << lanes_in_word) - 1;
+
+                for (; diff; diff &= diff - 1) {
+                    report.mismatches++;
+                    if (report.counterexamples.size() >= options.max_counterexamples) continue;
+                    const unsigned bit = static_cast<unsigned>(__builtin_ctzll(diff));
+                    TestVector test_vector("stimulus vector " + std::to_string(first + w * 64 + bit));
+                    TestResult result;
+                    result.passed = false;
+                    for (size_t k = 0; k < inputs.size(); ++k) {
+                        test_vector.addInput(signals[inputs[k]]->getName(),
+                                             ((in[k * words + w] >> bit) & 1) ? LogicLevel::HIGH : LogicLevel::LOW);
+                    }
+                    for (size_t k = 0; k < outputs.size(); ++k) {
+                        const std::string name = signals[outputs[k]]->getName();
+                        const LogicLevel expected = planeLevel(good_value + k * words, good_z + k * words, w, bit);
+                        test_vector.addExpectedOutput(name, expected);
+                        result.outputs.push_back(TestResult::Output{name, expected,
+                                                                    planeLevel(out_value + k * words, out_z + k * words, w, bit)});
+                    }
+                    report.counterexamples.emplace_back(std::move(test_vector), std::move(result));
+                }
+            }
+        }
+    }
+    report.vectors = total;
+
+    if (print) {
+        if (report_level == ReportLevel::VERBOSE || report_level == ReportLevel::FAILURES) {
+            for (const auto& counterexample : report.counterexamples) {
+                std::cout << "\n--- Mismatch: " << counterexample.first.description << " ---\n";
+                printInputs(counterexample.first);
+                printOutputs(counterexample.second);
+            }
+        }
+        std::cout << "\nVectors: " << (total - report.mismatches) << " matched, " << report.mismatches
+                  << " mismatched (" << total << " total)" << std::endl;
+        std::cout << "Overall Result: " << (report.mismatches == 0 ? "PASS" : "FAIL") << std::endl;
+    }
+    return report.mismatches == 0;
+}
+
+bool FModel::checkStimulus(const StimulusOptions& options, const FModel& golden, StimulusReport& report) {
+    if (!simulation_ready || (!compiled && !compile()) || !flattenFor("Stimulus checks")) {
+        std::cerr << "Circuit not ready for simulation!" << std::endl;
+        return false;
+    }
+    if (!golden.simulation_ready || !golden.compiled) {
+        std::cerr << "Golden circuit not ready for simulation!" << std::endl;
+        return false;
+    }
+
+    // Match the golden circuit's nets to ours by name
+    std::vector<int> golden_inputs, golden_outputs;
+    for (int signal : stimulusSignals(false)) {
+        const int match = golden.findSignal(signals[signal]->name);
+        if (match < 0) {
+            std::cerr << "Golden circuit has no input " << signals[signal]->name << std::endl;
+            return false;
+        }
+        golden_inputs.push_back(match);
+    }
+    for (int signal : stimulusSignals(true)) {
+        const int match = golden.findSignal(signals[signal]->name);
+        if (match < 0) {
+            std::cerr << "Golden circuit has no output " << signals[signal]->name << std::endl;
+            return false;
+        }
+        golden_outputs.push_back(match);
+    }
+
+    // A packed golden circuit takes one state per thread
+    const PackedKernel kernel = selectPackedKernel(packed_backend);
+    const int slots = golden.circuit.bit_parallel ? getThreads() : 1;
+    std::vector<SimulationState> golden_states;
+    for (int slot = 0; slot < slots; ++slot) golden_states.push_back(golden.makeState());
+    return runStimulus(options, golden.module_name, [&](int slot, const uint64_t* inputs, size_t lanes, uint64_t* value, uint64_t* z) {
+        golden.simulatePlanes(golden_states[slot], kernel, golden_inputs, inputs, lanes, golden_outputs, value, z);
+    }, slots, report);
+}
+
+bool FModel::checkStimulus(const StimulusOptions& options, const GoldenFunction& golden, StimulusReport& report) {
+    if (!simulation_ready || (!compiled && !compile()) || !flattenFor("Stimulus checks")) {
+        std::cerr << "Circuit not ready for simulation!" << std::endl;
+        return false;
+    }
+
+    const size_t num_inputs = stimulusSignals(false).size();
+    const size_t num_outputs = stimulusSignals(true).size();
+    const size_t words = static_cast<size_t>(selectPackedKernel(packed_backend).words);
+    std::vector<LogicLevel> input_levels(num_inputs), output_levels(num_outputs);
+    return runStimulus(options, "function", [&](int, const uint64_t* inputs, size_t lanes, uint64_t* value, uint64_t* z) {
+        std::fill(value, value + num_outputs * words, 0);
+        std::fill(z, z + num_outputs * words, 0);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            const size_t word = lane / 64;
+            const unsigned bit = lane % 64;
+            for (size_t k = 0; k < num_inputs; ++k) {
+                input_levels[k] = ((inputs[k * words + word] >> bit) & 1) ? LogicLevel::HIGH : LogicLevel::LOW;
+            }
+            std::fill(output_levels.begin(), output_levels.end(), LogicLevel::FLOATING);
+            golden(input_levels, output_levels);
+            for (size_t k = 0; k < num_outputs; ++k) {
+                setPlaneLevel(value + k * words, z + k * words, word, bit, output_levels[k]);
+            }
+        }
+    }, 1, report);
+}
+
+bool FModel::checkEquivalence(StimulusOptions options, const FModel& reference, StimulusReport& report) {
+    report = StimulusReport();
+    if (!simulation_ready || (!compiled && !compile())) {
+        std::cerr << "Circuit not ready for simulation!" << std::endl;
+        return false;
+    }
+    if (!reference.simulation_ready || !reference.compiled) {
+        std::cerr << "Reference circuit not ready for simulation!" << std::endl;
+        return false;
+    }
+
+    // Both netlists must have the same primary inputs and outputs
+    bool same_interface = true;
+    auto compareNames = [&](std::vector<std::string> ours, std::vector<std::string> theirs, const char* kind) {
+        std::sort(ours.begin(), ours.end());
+        std::sort(theirs.begin(), theirs.end());
+        std::vector<std::string> missing;
+        std::set_difference(ours.begin(), ours.end(), theirs.begin(), theirs.end(), std::back_inserter(missing));
+        for (const std::string& name : missing) {
+            std::cerr << "Reference circuit has no " << kind << " " << name << std::endl;
+        }
+        std::vector<std::string> extra;
+        std::set_difference(theirs.begin(), theirs.end(), ours.begin(), ours.end(), std::back_inserter(extra));
+        for (const std::string& name : extra) {
+            std::cerr << "Circuit has no " << kind << " " << name << " of the reference" << std::endl;
+        }
+        same_interface = same_interface && missing.empty() && extra.empty();
+    };
+    compareNames(getInputNames(), reference.getInputNames(), "input");
+    compareNames(getOutputNames(), reference.getOutputNames(), "output");
+    if (!same_interface) return false;
+
+    const size_t num_inputs = stimulusSignals(false).size();
+    if (num_inputs <= MAX_EQUIVALENCE_INPUTS) {
+        options.mode = StimulusMode::EXHAUSTIVE;
+    } else {
+        options.mode = StimulusMode::RANDOM;
+        if (options.count == 0) options.count = DEFAULT_EQUIVALENCE_VECTORS;
+    }
+    const bool equivalent = checkStimulus(options, reference, report);
+    if (report_level != ReportLevel::SILENT && report.vectors) {
+        if (!equivalent) {
+            std::cout << "Equivalence: NOT equivalent (" << report.mismatches << " mismatching vectors)" << std::endl;
+        } else if (options.mode == StimulusMode::EXHAUSTIVE) {
+            std::cout << "Equivalence: proven over all " << report.vectors << " input combinations" << std::endl;
+        } else {
+            std::cout << "Equivalence: no counterexample in " << report.vectors << " random vectors (not a proof)" << std::endl;
+        }
+    }
+    return equivalent;
+}
+
+} // namespace FModel
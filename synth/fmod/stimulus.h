@@ -0,0 +1,51 @@
+/**
+ * @file stimulus.h
+ * @brief Built-in stimulus: exhaustive and seeded random input patterns
+ *
+ * Patterns are produced directly as packed bit planes (see bitparallel.h),
+ * 64 vectors per word, over the circuit's primary inputs in
+ * FModel::getInputNames() order. Vector k of an exhaustive run drives input
+ * i with bit i of k; random runs draw one xorshift64* word per input and
+ * 64 vectors, so a seed always yields the same vectors whatever the kernel
+ * width.
+ */
+
+#ifndef STIMULUS_H
+#define STIMULUS_H
+
+#include "fmodel.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace FModel {
+
+class StimulusGenerator {
+public:
+    StimulusGenerator(const StimulusOptions& options, size_t num_inputs);
+
+    /**
+     * @brief Total number of vectors
+     */
+    uint64_t size() const { return total; }
+
+    /**
+     * @brief Fill planes[i * words + w] with the levels of input i for
+     *        vectors [first + 64 * w, first + 64 * w + 64)
+     *
+     * Blocks must be requested in order, first advancing by 64 * words.
+     * Lanes past size() are left zero.
+     */
+    void fill(uint64_t first, size_t words, uint64_t* planes);
+
+private:
+    uint64_t next();
+
+    StimulusMode mode;
+    size_t num_inputs;
+    uint64_t total;
+    uint64_t state;
+};
+
+} // namespace FModel
+
+#endif // STIMULUS_H
@@ -0,0 +1,63 @@
+/**
+ * @file string_table.cpp
+ * @brief Interning table
+ */
+
+#include "string_table.h"
+#include <cstring>
+
+namespace FModel {
+
+uint32_t StringTable::intern(std::string_view str) {
+    const size_t hash = hashOf(str);
+    if ((views.size() + 1) * 2 > slots.size()) rehash((views.size() + 1) * 2);
+    const size_t slot = slotOf(str, hash);
+    if (slots[slot] != NOT_FOUND) return slots[slot];
+
+    const uint32_t id = static_cast<uint32_t>(views.size());
+    views.emplace_back(store(str), str.size());
+    hashes.push_back(hash);
+    slots[slot] = id;
+    return id;
+}
+
+void StringTable::rehash(size_t min_slots) {
+    size_t size = 16;
+    while (size < min_slots) size *= 2;
+    if (size <= slots.size()) return;
+    slots.assign(size, NOT_FOUND);
+    for (uint32_t id = 0; id < views.size(); ++id) {
+        size_t i = hashes[id] & (size - 1);
+        while (slots[i] != NOT_FOUND) i = (i + 1) & (size - 1);
+        slots[i] = id;
+    }
+}
+
+void StringTable::clear() {
+    slots.clear();
+    hashes.clear();
+    views.clear();
+    blocks.clear();
+    large_blocks.clear();
+    block_used = BLOCK_SIZE;
+}
+
+const char* StringTable::store(std::string_view str) {
+    if (str.empty()) return "";
+    if (str.size() > BLOCK_SIZE / 4) {
+        // Long strings get a block of their own; the current block stays open
+        large_blocks.push_back(std::unique_ptr<char[]>(new char[str.size()]));
+        std::memcpy(large_blocks.back().get(), str.data(), str.size());
+        return large_blocks.back().get();
+    }
+    if (block_used + str.size() > BLOCK_SIZE) {
+        blocks.push_back(std::unique_ptr<char[]>(new char[BLOCK_SIZE]));
+        block_used = 0;
+    }
+    char* dest = blocks.back().get() + block_used;
+    std::memcpy(dest, str.data(), str.size());
+    block_used += str.size();
+    return dest;
+}
+
+} // namespace FModel
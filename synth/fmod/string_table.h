@@ -0,0 +1,83 @@
+/**
+ * @file string_table.h
+ * @brief Interning table: each distinct string stored once, named by a 32-bit ID
+ */
+
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace FModel {
+
+/**
+ * IDs are dense and assigned in first-seen order. Characters live in
+ * fixed blocks that never move, so views returned by view() stay valid for
+ * the lifetime of the table. The index is an open-addressed array of IDs,
+ * so neither lookups nor clear() touch per-entry heap nodes.
+ */
+class StringTable {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    StringTable() : block_used(BLOCK_SIZE) {}
+
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    /**
+     * @brief ID of str, adding it if it is new
+     */
+    uint32_t intern(std::string_view str);
+
+    /**
+     * @brief ID of str, or NOT_FOUND
+     */
+    uint32_t find(std::string_view str) const {
+        return slots.empty() ? NOT_FOUND : slots[slotOf(str, hashOf(str))];
+    }
+
+    std::string_view view(uint32_t id) const { return views[id]; }
+    size_t size() const { return views.size(); }
+
+    void reserve(size_t count) {
+        views.reserve(count);
+        hashes.reserve(count);
+        if (count * 2 > slots.size()) rehash(count * 2);
+    }
+
+    /**
+     * @brief Forget every string; previously returned views become invalid
+     */
+    void clear();
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    const char* store(std::string_view str);
+    static size_t hashOf(std::string_view str) { return std::hash<std::string_view>()(str); }
+    // Slot holding str, or the empty slot it would go in
+    size_t slotOf(std::string_view str, size_t hash) const {
+        const size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const uint32_t id = slots[i];
+            if (id == NOT_FOUND || (hashes[id] == hash && views[id] == str)) return i;
+        }
+    }
+    void rehash(size_t min_slots);
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::unique_ptr<char[]>> large_blocks;
+    size_t block_used;   // bytes used in blocks.back()
+    std::vector<std::string_view> views;
+    std::vector<size_t> hashes;   // hash of each ID's string
+    std::vector<uint32_t> slots;  // power-of-two table of IDs, at most half full
+};
+
+} // namespace FModel
+
+#endif // STRING_TABLE_H
@@ -0,0 +1,99 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Work-stealing thread pool
+ */
+
+#include "thread_pool.h"
+
+namespace FModel {
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_threads(num_threads > 0 ? num_threads : hardwareThreads()),
+      job(nullptr), generation(0), remaining(0), stopping(false) {
+    for (int i = 0; i < this->num_threads; ++i) queues.push_back(std::make_unique<TaskQueue>());
+    for (int i = 1; i < this->num_threads; ++i) workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+int ThreadPool::hardwareThreads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& body) {
+    if (count <= 0) return;
+    if (num_threads == 1 || count == 1) {
+        for (int t = 0; t < count; ++t) body(t);
+        return;
+    }
+
+    // Publish the job before any task becomes visible in a queue
+    job = &body;
+    remaining.store(count);
+    for (int q = 0; q < num_threads; ++q) {
+        const int begin = static_cast<int>(static_cast<int64_t>(count) * q / num_threads);
+        const int end = static_cast<int>(static_cast<int64_t>(count) * (q + 1) / num_threads);
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        for (int t = begin; t < end; ++t) queues[q]->tasks.push_back(t);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+    }
+    work_ready.notify_all();
+
+    while (runOneTask(0)) {}
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [&] { return remaining.load() == 0; });
+    job = nullptr;
+}
+
+bool ThreadPool::runOneTask(int id) {
+    // Own queue from the back (most recently dealt, still cache-warm), then
+    // steal from the front of the others
+    int task = -1;
+    for (int k = 0; k < num_threads && task < 0; ++k) {
+        TaskQueue& queue = *queues[(id + k) % num_threads];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (k == 0) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        } else {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+    }
+    if (task < 0) return false;
+
+    (*job)(task);
+    if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        work_done.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop(int id) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        while (runOneTask(id)) {}
+    }
+}
+
+} // namespace FModel
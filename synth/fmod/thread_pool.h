@@ -0,0 +1,74 @@
+/**
+ * @file thread_pool.h
+ * @brief Work-stealing thread pool with fork/join parallel loops
+ *
+ * parallelFor() splits a loop into tasks, deals them out to per-thread
+ * queues in contiguous blocks and returns once every task has run, so each
+ * call doubles as a barrier. Threads drain their own queue from the back
+ * and steal from the front of the others when it runs dry. The calling
+ * thread takes part in the work.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FModel {
+
+class ThreadPool {
+public:
+    /**
+     * @brief Create a pool of num_threads participants (the caller plus
+     *        num_threads - 1 workers); 0 means one per hardware thread
+     */
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return num_threads; }
+
+    /**
+     * @brief Run body(task) for every task in [0, count) and wait for all
+     *
+     * Must not be called from inside a task.
+     */
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+    static int hardwareThreads();
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    void workerLoop(int id);
+    bool runOneTask(int id);
+
+    int num_threads;
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    const std::function<void(int)>* job;
+    uint64_t generation;
+    std::atomic<int> remaining;
+    bool stopping;
+};
+
+} // namespace FModel
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,346 @@
+/**
+ * @file timed.cpp
+ * @brief Timed simulation on a timing wheel using each part's propagation delay
+ *
+ * Gates switch with transport delay: when a net changes at tick t, every
+ * gate reading it is re-evaluated once all changes of tick t have been
+ * applied, and a gate whose output level differs from the last one it
+ * scheduled queues that level at t + its delay. Nets carry over from one
+ * vector to the next, as on a board, so each vector's arrival times are
+ * measured from the moment its inputs change.
+ */
+
+#include "timed.h"
+#include "component_base.h"
+#include "part_descriptors.h"
+#include "vcd.h"
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+namespace FModel {
+
+namespace {
+
+constexpr size_t MAX_REPORTED_GLITCHES = 10;
+
+std::string formatNs(double ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f", ns);
+    return text;
+}
+
+} // namespace
+
+void TimingWheel::reset(uint32_t horizon) {
+    size_t slots = 2;
+    while (slots <= horizon) slots *= 2;
+    mask = slots - 1;
+    heads.assign(slots, -1);
+    tails.assign(slots, -1);
+    counts.assign(slots, 0);
+    // Keep the node storage, all of it free again
+    free_list = -1;
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; --i) {
+        nodes[i].next = free_list;
+        free_list = i;
+    }
+    now_tick = 0;
+    pending = 0;
+    taken_tail = -1;
+}
+
+void TimingWheel::schedule(uint32_t delay, int signal, LogicLevel level, int cause) {
+    int node = free_list;
+    if (node >= 0) {
+        free_list = nodes[node].next;
+    } else {
+        node = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+    }
+    nodes[node] = Event{signal, cause, level, -1};
+
+    const size_t slot = (now_tick + delay) & mask;
+    if (tails[slot] >= 0) {
+        nodes[tails[slot]].next = node;
+    } else {
+        heads[slot] = node;
+    }
+    tails[slot] = node;
+    counts[slot]++;
+    pending++;
+}
+
+int TimingWheel::advance() {
+    if (pending == 0) return -1;
+    size_t slot;
+    do {
+        now_tick++;
+        slot = now_tick & mask;
+    } while (heads[slot] < 0);
+
+    const int first = heads[slot];
+    taken_tail = tails[slot];
+    pending -= counts[slot];
+    heads[slot] = tails[slot] = -1;
+    counts[slot] = 0;
+    return first;
+}
+
+void TimingWheel::release(int first) {
+    if (first < 0) return;
+    nodes[taken_tail].next = free_list;
+    free_list = first;
+    taken_tail = -1;
+}
+
+void FModel::startTimedRun() {
+    // Build the gate-level tables, then start from an unpowered board: every
+    // net Z except the rails, every gate due for a first evaluation
+    timed_engine = std::make_unique<TimedEngine>();
+    TimedEngine& engine = *timed_engine;
+    const int num_signals = static_cast<int>(signals.size());
+    const int num_gates = static_cast<int>(circuit.gates.size());
+
+    // The tick is the GCD of the delays in picoseconds
+    std::vector<uint64_t> delays_ps(num_gates);
+    uint64_t tick = 0;
+    for (int g = 0; g < num_gates; ++g) {
+        const double ns = circuit.components[circuit.gates[g].component].component->getPropagationDelay();
+        delays_ps[g] = std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(ns * 1000.0)));
+        tick = std::gcd(tick, delays_ps[g]);
+    }
+    engine.tick_ps = tick > 0 ? tick : 1;
+    engine.gate_delays.resize(num_gates);
+    engine.horizon = 1;
+    for (int g = 0; g < num_gates; ++g) {
+        engine.gate_delays[g] = static_cast<uint32_t>(delays_ps[g] / engine.tick_ps);
+        engine.horizon = std::max(engine.horizon, engine.gate_delays[g]);
+    }
+    engine.wheel.reset(engine.horizon);
+
+    engine.reader_offsets.assign(num_signals + 1, 0);
+    for (const CompiledGate& gate : circuit.gates) {
+        for (int i = gate.inputs_begin; i < gate.inputs_end; ++i) engine.reader_offsets[circuit.gate_input_pins[i].signal + 1]++;
+    }
+    for (int s = 0; s < num_signals; ++s) engine.reader_offsets[s + 1] += engine.reader_offsets[s];
+    engine.readers.resize(engine.reader_offsets[num_signals]);
+    std::vector<int> cursor(engine.reader_offsets.begin(), engine.reader_offsets.end() - 1);
+    for (int g = 0; g < num_gates; ++g) {
+        for (int i = circuit.gates[g].inputs_begin; i < circuit.gates[g].inputs_end; ++i) {
+            engine.readers[cursor[circuit.gate_input_pins[i].signal]++] = g;
+        }
+    }
+
+    std::vector<int> drivers(num_signals, 0);
+    for (const CompiledGate& gate : circuit.gates) drivers[gate.output_signal]++;
+    engine.sole_driver.resize(num_gates);
+    for (int g = 0; g < num_gates; ++g) engine.sole_driver[g] = drivers[circuit.gates[g].output_signal] == 1;
+
+    engine.projected.assign(num_gates, LogicLevel::FLOATING);
+    engine.gate_cause.assign(num_gates, -1);
+    engine.marked.assign(num_gates, 1);
+    engine.worklist.resize(num_gates);
+    std::iota(engine.worklist.begin(), engine.worklist.end(), 0);
+    engine.cause.assign(num_signals, -1);
+    engine.last_change.assign(num_signals, 0);
+    engine.vector_transitions.assign(num_signals, 0);
+    engine.vector_initial.assign(num_signals, LogicLevel::FLOATING);
+    engine.driving.assign(num_signals, 0);
+
+    signal_timing.assign(num_signals, SignalTiming());
+    critical_path.clear();
+    resetCircuit(state);
+    if (waveform) waveform->sample(state.signal_levels.data());
+}
+
+void FModel::simulateTimed() {
+    for (size_t i = 0; i < test_vectors.size(); ++i) {
+        test_results[i] = runTimedVector(test_vectors[i]);
+    }
+}
+
+TestResult FModel::runTimedVector(const TestVector& test_vector) {
+    TimedEngine& engine = *timed_engine;
+    TimingWheel& wheel = engine.wheel;
+    LogicLevel* levels = state.signal_levels.data();
+    const size_t vector_index = engine.vectors++;
+    // The wheel is empty between vectors; times are taken from this tick
+    const uint64_t start = wheel.now();
+
+    auto change = [&](int signal, LogicLevel level, int cause) {
+        if (levels[signal] == level) return;
+        if (engine.vector_transitions[signal]++ == 0) {
+            engine.touched.push_back(signal);
+            engine.vector_initial[signal] = levels[signal];
+        }
+        levels[signal] = level;
+        if (waveform) waveform->change(signal, level);
+        engine.last_change[signal] = wheel.now();
+        engine.cause[signal] = cause;
+        for (int r = engine.reader_offsets[signal]; r < engine.reader_offsets[signal + 1]; ++r) {
+            const int g = engine.readers[r];
+            if (engine.marked[g]) {
+                if (engine.gate_cause[g] < 0) engine.gate_cause[g] = signal;
+                continue;
+            }
+            engine.marked[g] = 1;
+            engine.gate_cause[g] = signal;
+            engine.worklist.push_back(g);
+        }
+    };
+
+    // Waveform times are in picoseconds since the start of the run
+    auto traceTime = [&]() {
+        if (waveform) waveform->at((engine.epoch + wheel.now()) * engine.tick_ps);
+    };
+    traceTime();
+
+    // Tick 0: nets the previous vector drove and this one does not float,
+    // the rest take this vector's levels
+    std::vector<int>& driven = engine.next_driven;
+    driven.clear();
+    for (const auto& input : test_vector.inputs) {
+        const int signal = findSignal(input.first);
+        if (signal < 0) continue;
+        driven.push_back(signal);
+        engine.driving[signal] = 1;
+        change(signal, input.second, -1);
+    }
+    for (int signal : engine.driven) {
+        if (!engine.driving[signal]) change(signal, LogicLevel::FLOATING, -1);
+    }
+    for (int signal : driven) engine.driving[signal] = 0;
+    engine.driven.swap(driven);
+
+    // Guard against circuits that never settle, as propagateSignals() does
+    const uint64_t max_events = static_cast<uint64_t>(std::max<size_t>(1, circuit.gates.size())) * MAX_EVALUATIONS_PER_COMPONENT;
+    uint64_t vector_events = 0;
+    std::vector<int>& evaluate = engine.evaluate;
+    while (true) {
+        // Every change of this tick is applied; now the gates that saw one
+        evaluate.swap(engine.worklist);
+        engine.worklist.clear();
+        for (int g : evaluate) {
+            const int cause = engine.gate_cause[g];
+            engine.marked[g] = 0;
+            engine.gate_cause[g] = -1;
+            const CompiledGate& gate = circuit.gates[g];
+            const LogicLevel out = evaluateGateOutput(state, gate);
+            // A gate whose inputs float releases its net, unless another
+            // gate drives it too (the last non-Z write wins, as untimed)
+            if (out == engine.projected[g] || (out == LogicLevel::FLOATING && !engine.sole_driver[g])) continue;
+            engine.projected[g] = out;
+            wheel.schedule(engine.gate_delays[g], gate.output_signal, out, cause);
+        }
+        evaluate.clear();
+        engine.peak_pending = std::max(engine.peak_pending, wheel.size());
+
+        const int first = wheel.advance();
+        if (first < 0) break;
+        traceTime();
+        for (int node = first; node >= 0; node = wheel.event(node).next) {
+            const TimingWheel::Event& event = wheel.event(node);
+            change(event.signal, event.level, event.cause);
+            vector_events++;
+        }
+        wheel.release(first);
+        if (vector_events > max_events) {
+            std::cerr << "Warning: circuit did not settle after " << max_events
+                      << " timed events (oscillation?)" << std::endl;
+            for (int g : engine.worklist) {
+                engine.marked[g] = 0;
+                engine.gate_cause[g] = -1;
+            }
+            engine.worklist.clear();
+            engine.epoch += wheel.now();
+            wheel.reset(engine.horizon);
+            break;
+        }
+    }
+    engine.events += vector_events;
+
+    // Fold this vector into the per-net worst case
+    const double tick_ns = engine.tick_ps / 1000.0;
+    int worst_output = -1;
+    for (int signal : engine.touched) {
+        SignalTiming& timing = signal_timing[signal];
+        const uint32_t count = engine.vector_transitions[signal];
+        const uint32_t settled = levels[signal] != engine.vector_initial[signal] ? 1 : 0;
+        timing.transitions += count;
+        timing.glitches += (count - settled) / 2;
+        const double arrival = (engine.last_change[signal] - start) * tick_ns;
+        timing.arrival_ns = std::max(timing.arrival_ns, arrival);
+        if (signals[signal]->is_output && arrival > engine.worst_output_ns) {
+            engine.worst_output_ns = arrival;
+            worst_output = signal;
+        }
+        engine.vector_transitions[signal] = 0;
+    }
+    engine.touched.clear();
+
+    if (worst_output >= 0) {
+        // New worst output: walk back the changes that led to it
+        engine.worst_vector = vector_index;
+        critical_path.clear();
+        for (int signal = worst_output; signal >= 0 && critical_path.size() < signals.size();
+             signal = engine.cause[signal]) {
+            critical_path.push_back(TimingPathStep{signals[signal]->getName(), (engine.last_change[signal] - start) * tick_ns});
+        }
+        std::reverse(critical_path.begin(), critical_path.end());
+    }
+
+    return checkOutputs(state, test_vector);
+}
+
+void FModel::printTimingReport() const {
+    if (!timed_engine) return;
+    const TimedEngine& engine = *timed_engine;
+    std::cout << "\n=== Timing Report ===" << std::endl;
+    std::cout << "Resolution: " << formatNs(engine.tick_ps / 1000.0) << " ns; " << engine.events
+              << " events (at most " << engine.peak_pending << " pending)" << std::endl;
+
+    if (engine.worst_output_ns < 0) {
+        std::cout << "No output changed" << std::endl;
+    } else {
+        std::cout << "Worst output arrival: " << critical_path.back().signal << " at "
+                  << formatNs(engine.worst_output_ns) << " ns (vector " << engine.worst_vector + 1 << ")";
+        if (engine.worst_output_ns > 0) {
+            std::cout << ", max input rate " << formatNs(1000.0 / engine.worst_output_ns) << " MHz";
+        }
+        std::cout << std::endl;
+        std::cout << "Critical path:";
+        for (size_t i = 0; i < critical_path.size(); ++i) {
+            std::cout << (i ? " -> " : " ") << critical_path[i].signal << " @" << formatNs(critical_path[i].arrival_ns);
+        }
+        std::cout << std::endl;
+    }
+
+    uint64_t glitches = 0;
+    std::vector<int> glitching;
+    for (size_t s = 0; s < signal_timing.size(); ++s) {
+        if (signal_timing[s].glitches == 0) continue;
+        glitches += signal_timing[s].glitches;
+        glitching.push_back(static_cast<int>(s));
+    }
+    std::cout << "Glitches: " << glitches << " on " << glitching.size() << " nets" << std::endl;
+    if (report_level != ReportLevel::VERBOSE && report_level != ReportLevel::FAILURES) return;
+
+    std::cout << "Outputs:" << std::endl;
+    for (const auto& signal : signals) {
+        if (!signal->is_output) continue;
+        const SignalTiming& timing = signal_timing[signal->index];
+        std::cout << "  " << signal->name << ": "
+                  << (timing.arrival_ns < 0 ? std::string("never changed") : formatNs(timing.arrival_ns) + " ns")
+                  << ", " << timing.transitions << " transitions, " << timing.glitches << " glitches" << std::endl;
+    }
+    std::stable_sort(glitching.begin(), glitching.end(),
+                     [&](int a, int b) { return signal_timing[a].glitches > signal_timing[b].glitches; });
+    if (glitching.size() > MAX_REPORTED_GLITCHES) glitching.resize(MAX_REPORTED_GLITCHES);
+    if (!glitching.empty()) std::cout << "Most glitches:" << std::endl;
+    for (int s : glitching) {
+        std::cout << "  " << signals[s]->name << ": " << signal_timing[s].glitches << std::endl;
+    }
+}
+
+} // namespace FModel
@@ -0,0 +1,115 @@
+/**
+ * @file timed.h
+ * @brief Timing wheel and tables of the timed (delay-aware) simulation
+ *
+ * Time advances in integer ticks: the greatest common divisor of the part
+ * delays, so every gate delay is a whole number of ticks and the wheel needs
+ * only (largest delay + 1) slots, rounded up to a power of two. An event is
+ * never scheduled further ahead than the largest delay, so all pending
+ * events fit in one turn of the wheel and each slot holds a single tick.
+ */
+
+#ifndef TIMED_H
+#define TIMED_H
+
+#include "fmodel.h"
+#include <cstdint>
+#include <vector>
+
+namespace FModel {
+
+/**
+ * @brief Calendar queue of net changes with pooled event nodes
+ *
+ * schedule() and advance() are O(1) amortized (advance() skips at most one
+ * turn of empty slots); nodes are recycled through a free list, so a warmed
+ * up wheel does not allocate.
+ */
+class TimingWheel {
+public:
+    struct Event {
+        int signal;
+        int cause;          // net whose change made the driving gate switch, -1 for none
+        LogicLevel level;
+        int next;           // next node in the slot, or in the free list
+    };
+
+    TimingWheel() : now_tick(0), pending(0), mask(0), free_list(-1), taken_tail(-1) {}
+
+    /**
+     * @brief Drop every event and size the wheel for delays up to horizon ticks
+     */
+    void reset(uint32_t horizon);
+
+    uint64_t now() const { return now_tick; }
+    size_t size() const { return pending; }
+
+    /**
+     * @brief Queue a change at now() + delay, 1 <= delay <= horizon;
+     *        events of one tick come out in scheduling order
+     */
+    void schedule(uint32_t delay, int signal, LogicLevel level, int cause);
+
+    /**
+     * @brief Move to the next tick that has events and detach them
+     * @return First node of the detached list, or -1 when nothing is pending
+     */
+    int advance();
+
+    const Event& event(int node) const { return nodes[node]; }
+
+    /**
+     * @brief Return the list detached by the last advance() to the pool
+     */
+    void release(int first);
+
+private:
+    uint64_t now_tick;
+    size_t pending;
+    uint64_t mask;
+    int free_list;
+    int taken_tail;
+    std::vector<Event> nodes;
+    std::vector<int> heads;
+    std::vector<int> tails;
+    std::vector<uint32_t> counts;
+};
+
+/**
+ * @brief Gate-level tables and scratch state of one timed run
+ */
+struct TimedEngine {
+    uint64_t tick_ps = 1;
+    uint32_t horizon = 1;                  // largest gate delay, in ticks
+    std::vector<uint32_t> gate_delays;     // in ticks
+    // Gates reading signal s: readers[reader_offsets[s] .. reader_offsets[s + 1])
+    std::vector<int> reader_offsets;
+    std::vector<int> readers;
+    std::vector<char> sole_driver;         // gate is the only driver of its net
+    // Last level each gate scheduled, and the gates to evaluate at this tick
+    std::vector<LogicLevel> projected;
+    std::vector<char> marked;
+    std::vector<int> gate_cause;           // net whose change marked the gate, -1 for none
+    std::vector<int> worklist;
+    std::vector<int> evaluate;
+    // Per-net bookkeeping of the current vector
+    std::vector<int> cause;
+    std::vector<uint64_t> last_change;
+    std::vector<uint32_t> vector_transitions;
+    std::vector<LogicLevel> vector_initial;
+    std::vector<int> touched;
+    std::vector<int> driven;               // nets the previous vector drove
+    std::vector<int> next_driven;
+    std::vector<char> driving;
+    TimingWheel wheel;
+    uint64_t epoch = 0;                    // ticks before the wheel was last reset
+    uint64_t vectors = 0;
+    uint64_t events = 0;
+    size_t peak_pending = 0;
+    double worst_output_ns = -1;
+    uint64_t worst_vector = 0;
+};
+
+} // namespace FModel
+
+#endif // TIMED_H
@@ -0,0 +1,167 @@
+/**
+ * @file vcd.cpp
+ * @brief Buffered VCD waveform writer and the choice of traced nets
+ */
+
+#include "vcd.h"
+#include <charconv>
+#include <iostream>
+
+namespace FModel {
+
+namespace {
+
+constexpr int8_t NOT_WRITTEN = 2;
+
+// Identifier codes: base 94 over the printable characters '!' .. '~'
+std::string identifierCode(size_t index) {
+    std::string code;
+    do {
+        code.push_back(static_cast<char>('!' + index % 94));
+        index /= 94;
+    } while (index > 0);
+    return code;
+}
+
+char levelChar(LogicLevel level) {
+    switch (level) {
+        case LogicLevel::LOW: return '0';
+        case LogicLevel::HIGH: return '1';
+        case LogicLevel::FLOATING: default: return 'z';
+    }
+}
+
+// VCD names end at whitespace
+std::string vcdName(std::string_view name) {
+    std::string out(name.empty() ? std::string_view("unnamed") : name);
+    for (char& c : out) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') c = '_';
+    }
+    return out;
+}
+
+} // namespace
+
+bool globMatch(std::string_view pattern, std::string_view text) {
+    // Greedy, backtracking only to the last '*'
+    size_t p = 0, t = 0;
+    size_t star = std::string_view::npos, resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = t;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+bool VcdWriter::open(const std::string& path, const std::string& module, const std::string& timescale,
+                     const std::vector<std::pair<int, std::string_view>>& traced, size_t num_signals) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    buffer.clear();
+    buffer.reserve(BUFFER_SIZE + 256);
+    signals.clear();
+    codes.clear();
+    slot.assign(num_signals, -1);
+    now_time = 0;
+    time_written = false;
+    dumped = false;
+
+    buffer += "$version fmodel_sim $end\n$timescale " + timescale + " $end\n";
+    buffer += "$scope module " + vcdName(module) + " $end\n";
+    for (const auto& net : traced) {
+        if (net.first < 0 || net.first >= static_cast<int>(num_signals) || slot[net.first] >= 0) continue;
+        slot[net.first] = static_cast<int>(signals.size());
+        signals.push_back(net.first);
+        codes.push_back(identifierCode(codes.size()));
+        buffer += "$var wire 1 " + codes.back() + " " + vcdName(net.second) + " $end\n";
+        if (buffer.size() >= BUFFER_SIZE) flush();
+    }
+    buffer += "$upscope $end\n$enddefinitions $end\n";
+    written.assign(signals.size(), NOT_WRITTEN);
+    return static_cast<bool>(file);
+}
+
+void VcdWriter::put(int traced, LogicLevel level) {
+    if (written[traced] == static_cast<int8_t>(level)) return;
+    written[traced] = static_cast<int8_t>(level);
+    if (!time_written) {
+        char stamp[24];
+        stamp[0] = '#';
+        char* end = std::to_chars(stamp + 1, stamp + sizeof(stamp) - 1, now_time).ptr;
+        *end++ = '\n';
+        buffer.append(stamp, end);
+        if (!dumped) buffer += "$dumpvars\n";
+        time_written = true;
+    }
+    buffer += levelChar(level);
+    buffer += codes[traced];
+    buffer += '\n';
+    if (buffer.size() >= BUFFER_SIZE) flush();
+}
+
+void VcdWriter::sample(const LogicLevel* levels) {
+    for (size_t i = 0; i < signals.size(); ++i) put(static_cast<int>(i), levels[signals[i]]);
+    if (!dumped && time_written) {
+        // The first sample is the initial value of every net
+        buffer += "$end\n";
+        dumped = true;
+    }
+}
+
+void VcdWriter::flush() {
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+bool VcdWriter::close() {
+    if (!file.is_open()) return false;
+    flush();
+    const bool ok = static_cast<bool>(file);
+    file.close();
+    return ok;
+}
+
+bool FModel::startWaveform() {
+    // Nets matching any pattern, all of them without patterns, in index order
+    std::vector<std::pair<int, std::string_view>> traced;
+    for (const auto& signal : signals) {
+        bool match = waveform_patterns.empty();
+        for (size_t i = 0; i < waveform_patterns.size() && !match; ++i) {
+            match = globMatch(waveform_patterns[i], signal->name);
+        }
+        if (match) traced.emplace_back(signal->index, signal->name);
+    }
+
+    waveform = std::make_unique<VcdWriter>();
+    const std::string timescale = timed_mode ? "1ps" : "1ns";
+    if (!waveform->open(waveform_path, module_name.empty() ? "top" : module_name, timescale, traced, signals.size())) {
+        std::cerr << "Cannot write waveform file: " << waveform_path << std::endl;
+        waveform.reset();
+        return false;
+    }
+    if (traced.empty()) {
+        std::cerr << "Warning: no net matches the waveform signal patterns" << std::endl;
+    }
+    return true;
+}
+
+bool FModel::finishWaveform() {
+    if (!waveform) return true;
+    const bool ok = waveform->close();
+    if (!ok) std::cerr << "Error writing waveform file: " << waveform_path << std::endl;
+    waveform.reset();
+    return ok;
+}
+
+} // namespace FModel
@@ -0,0 +1,86 @@
+/**
+ * @file vcd.h
+ * @brief Buffered VCD waveform writer
+ *
+ * Only changes are written: the writer remembers the last level it wrote
+ * for every traced net and drops samples that repeat it. Output collects
+ * in a large in-memory buffer and reaches the file in big blocks, so a long
+ * trace costs a few string appends per change and no per-line flushes.
+ */
+
+#ifndef VCD_H
+#define VCD_H
+
+#include "fmodel.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace FModel {
+
+/**
+ * @brief Shell-style match of text against pattern (`*` any run, `?` any character)
+ */
+bool globMatch(std::string_view pattern, std::string_view text);
+
+class VcdWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    VcdWriter() : now_time(0), time_written(false), dumped(false) {}
+    ~VcdWriter() { close(); }
+
+    /**
+     * @brief Create the file and write the header
+     * @param traced (signal index, net name) of every net to record
+     * @param num_signals Size of the level arrays passed to sample()
+     */
+    bool open(const std::string& path, const std::string& module, const std::string& timescale,
+              const std::vector<std::pair<int, std::string_view>>& traced, size_t num_signals);
+
+    /**
+     * @brief Move to a later time; changes from now on are stamped with it
+     */
+    void at(uint64_t time) { if (time > now_time) { now_time = time; time_written = false; } }
+    void advance(uint64_t ticks) { at(now_time + ticks); }
+    uint64_t now() const { return now_time; }
+
+    /**
+     * @brief Record one net's level at the current time if it changed
+     */
+    void change(int signal, LogicLevel level) {
+        if (signal < static_cast<int>(slot.size()) && slot[signal] >= 0) put(slot[signal], level);
+    }
+
+    /**
+     * @brief Record every traced net whose level differs from the one last written
+     */
+    void sample(const LogicLevel* levels);
+
+    size_t size() const { return codes.size(); }
+
+    /**
+     * @brief Write out the buffer and close the file
+     */
+    bool close();
+
+private:
+    void put(int traced, LogicLevel level);
+    void flush();
+
+    std::ofstream file;
+    std::string buffer;
+    std::vector<int> signals;          // signal index of each traced net
+    std::vector<int> slot;             // traced position of each signal, -1 if not traced
+    std::vector<std::string> codes;    // VCD identifier of each traced net
+    std::vector<int8_t> written;       // last level written, as LogicLevel; 2 before the first
+    uint64_t now_time;
+    bool time_written;
+    bool dumped;
+};
+
+} // namespace FModel
+
+#endif // VCD_H
@@ -0,0 +1,232 @@
+/**
+ * @file vector_file.cpp
+ * @brief Packed columnar test vector files and a streaming reader
+ */
+
+#include "vector_file.h"
+#include <algorithm>
+#include <numeric>
+
+namespace FModel {
+
+namespace {
+
+constexpr uint8_t CODE_LOW = 0;
+constexpr uint8_t CODE_HIGH = 1;
+constexpr uint8_t CODE_Z = 2;
+constexpr uint8_t CODE_ABSENT = 3;
+
+// Refuse headers that cannot be a real vector file before allocating for them
+constexpr uint32_t MAX_COLUMNS = 1u << 20;
+constexpr uint32_t MAX_NAME_LENGTH = 1u << 16;
+
+uint8_t encodeLevel(LogicLevel level) {
+    switch (level) {
+        case LogicLevel::LOW: return CODE_LOW;
+        case LogicLevel::HIGH: return CODE_HIGH;
+        case LogicLevel::FLOATING: default: return CODE_Z;
+    }
+}
+
+LogicLevel decodeLevel(uint8_t code) {
+    return code == CODE_LOW ? LogicLevel::LOW : code == CODE_HIGH ? LogicLevel::HIGH : LogicLevel::FLOATING;
+}
+
+uint8_t columnCode(const uint8_t* row, size_t column) {
+    return (row[column >> 2] >> ((column & 3) * 2)) & 3;
+}
+
+template<typename T>
+void writeLittleEndian(std::ostream& out, T value) {
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i) bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    out.write(bytes, sizeof(T));
+}
+
+template<typename T>
+bool readLittleEndian(std::istream& in, T& value) {
+    unsigned char bytes[sizeof(T)];
+    if (!in.read(reinterpret_cast<char*>(bytes), sizeof(T))) return false;
+    value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<T>(bytes[i]) << (8 * i);
+    return true;
+}
+
+bool readColumnNames(std::istream& in, uint32_t count, std::vector<std::string>& names) {
+    names.resize(count);
+    for (std::string& name : names) {
+        uint32_t length = 0;
+        if (!readLittleEndian(in, length) || length > MAX_NAME_LENGTH) return false;
+        name.resize(length);
+        if (!in.read(&name[0], length)) return false;
+    }
+    return true;
+}
+
+std::vector<int> nameOrder(const std::vector<std::string>& names) {
+    std::vector<int> order(names.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return names[a] < names[b]; });
+    return order;
+}
+
+} // namespace
+
+bool isVectorFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    uint32_t magic = 0;
+    return file.is_open() && readLittleEndian(file, magic) && magic == VECTOR_FILE_MAGIC;
+}
+
+bool VectorFileWriter::open(const std::string& path, const std::vector<std::string>& input_columns,
+                            const std::vector<std::string>& output_columns) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    inputs = input_columns;
+    outputs = output_columns;
+    row.assign((2 * (inputs.size() + outputs.size()) + 7) / 8, 0);
+    rows = 0;
+
+    writeLittleEndian(file, VECTOR_FILE_MAGIC);
+    writeLittleEndian(file, VECTOR_FILE_VERSION);
+    writeLittleEndian(file, static_cast<uint32_t>(inputs.size()));
+    writeLittleEndian(file, static_cast<uint32_t>(outputs.size()));
+    for (const auto* names : {&inputs, &outputs}) {
+        for (const std::string& name : *names) {
+            writeLittleEndian(file, static_cast<uint32_t>(name.size()));
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+    }
+    count_offset = file.tellp();
+    writeLittleEndian(file, static_cast<uint64_t>(0));
+    return static_cast<bool>(file);
+}
+
+bool VectorFileWriter::write(const TestVector& test_vector) {
+    std::fill(row.begin(), row.end(), 0);
+    size_t column = 0;
+    auto put = [&](const std::map<std::string, LogicLevel>& levels, const std::vector<std::string>& names) {
+        for (const std::string& name : names) {
+            auto it = levels.find(name);
+            const uint8_t code = it != levels.end() ? encodeLevel(it->second) : CODE_ABSENT;
+            row[column >> 2] |= static_cast<uint8_t>(code << ((column & 3) * 2));
+            column++;
+        }
+    };
+    put(test_vector.inputs, inputs);
+    put(test_vector.expected_outputs, outputs);
+    file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+    rows++;
+    return static_cast<bool>(file);
+}
+
+bool VectorFileWriter::close() {
+    if (!file.is_open()) return false;
+    file.seekp(count_offset);
+    writeLittleEndian(file, rows);
+    const bool ok = static_cast<bool>(file);
+    file.close();
+    return ok;
+}
+
+bool VectorFileReader::open(const std::string& path) {
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        error_message = "cannot open file";
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0, input_count = 0, output_count = 0;
+    if (!readLittleEndian(file, magic) || magic != VECTOR_FILE_MAGIC) {
+        error_message = "not a packed vector file";
+        return false;
+    }
+    if (!readLittleEndian(file, version) || version != VECTOR_FILE_VERSION) {
+        error_message = "unsupported packed vector file version";
+        return false;
+    }
+    if (!readLittleEndian(file, input_count) || !readLittleEndian(file, output_count) ||
+        input_count > MAX_COLUMNS || output_count > MAX_COLUMNS ||
+        !readColumnNames(file, input_count, inputs) || !readColumnNames(file, output_count, outputs) ||
+        !readLittleEndian(file, rows)) {
+        error_message = "truncated or corrupt header";
+        return false;
+    }
+
+    input_order = nameOrder(inputs);
+    output_order = nameOrder(outputs);
+    row_bytes = (2 * (inputs.size() + outputs.size()) + 7) / 8;
+    data_offset = file.tellg();
+    rows_read = 0;
+    return true;
+}
+
+bool VectorFileReader::rewind() {
+    file.clear();
+    file.seekg(data_offset);
+    rows_read = 0;
+    error_message.clear();
+    return static_cast<bool>(file);
+}
+
+size_t VectorFileReader::readBatch(std::vector<TestVector>& batch, size_t max_rows) {
+    const size_t count = static_cast<size_t>(std::min<uint64_t>(max_rows, rows - rows_read));
+    buffer.resize(count * row_bytes);
+    if (count > 0 && !file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+        error_message = "file ends before the last row";
+        batch.clear();
+        return 0;
+    }
+    batch.resize(count);
+    for (size_t i = 0; i < count; ++i) decodeRow(&buffer[i * row_bytes], batch[i]);
+    rows_read += count;
+    return count;
+}
+
+void VectorFileReader::decodeRow(const uint8_t* data, TestVector& test_vector) const {
+    const size_t output_base = inputs.size();
+    test_vector.description.clear();
+    test_vector.cycles = 1;   // batch slots may hold a text file's cycle counts
+
+    // Fast path: the vector already holds exactly these columns (the usual
+    // case when batches are reused), so only the levels change
+    bool complete = test_vector.inputs.size() == inputs.size() && test_vector.expected_outputs.size() == outputs.size();
+    for (size_t c = 0; complete && c < inputs.size() + outputs.size(); ++c) {
+        complete = columnCode(data, c) != CODE_ABSENT;
+    }
+    if (complete) {
+        size_t k = 0;
+        for (auto& input : test_vector.inputs) {
+            const int column = input_order[k++];
+            if (input.first != inputs[column]) {
+                complete = false;
+                break;
+            }
+            input.second = decodeLevel(columnCode(data, column));
+        }
+        k = 0;
+        for (auto& output : test_vector.expected_outputs) {
+            if (!complete) break;
+            const int column = output_order[k++];
+            if (output.first != outputs[column]) {
+                complete = false;
+                break;
+            }
+            output.second = decodeLevel(columnCode(data, output_base + column));
+        }
+        if (complete) return;
+    }
+
+    test_vector.inputs.clear();
+    test_vector.expected_outputs.clear();
+    for (size_t c = 0; c < inputs.size(); ++c) {
+        const uint8_t code = columnCode(data, c);
+        if (code != CODE_ABSENT) test_vector.addInput(inputs[c], decodeLevel(code));
+    }
+    for (size_t c = 0; c < outputs.size(); ++c) {
+        const uint8_t code = columnCode(data, output_base + c);
+        if (code != CODE_ABSENT) test_vector.addExpectedOutput(outputs[c], decodeLevel(code));
+    }
+}
+
+} // namespace FModel
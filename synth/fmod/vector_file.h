@@ -0,0 +1,109 @@
+/**
+ * @file vector_file.h
+ * @brief Packed columnar test vector files (.fmv) and a streaming reader
+ *
+ * Layout, all integers little-endian:
+ *   u32 magic "FMVP", u32 version
+ *   u32 input count, u32 output count
+ *   column names, inputs then outputs, each as u32 length + bytes
+ *   u64 row count
+ *   rows: 2 bits per column, column c in bits 2*(c%4) of byte c/4 of the row,
+ *         rows padded to whole bytes
+ * A 2-bit code is 0 = LOW, 1 = HIGH, 2 = Z, 3 = absent (input not driven,
+ * output not checked).
+ */
+
+#ifndef VECTOR_FILE_H
+#define VECTOR_FILE_H
+
+#include "fmodel.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace FModel {
+
+static constexpr uint32_t VECTOR_FILE_MAGIC = 0x50564D46;   // "FMVP"
+static constexpr uint32_t VECTOR_FILE_VERSION = 1;
+
+/**
+ * @brief Whether path starts with the packed vector file magic
+ */
+bool isVectorFile(const std::string& path);
+
+class VectorFileWriter {
+public:
+    VectorFileWriter() : rows(0), count_offset(0) {}
+
+    bool open(const std::string& path, const std::vector<std::string>& input_columns,
+              const std::vector<std::string>& output_columns);
+    /**
+     * @brief Append one row; signals that are not columns are ignored
+     */
+    bool write(const TestVector& test_vector);
+    /**
+     * @brief Patch the row count into the header and close the file
+     */
+    bool close();
+
+private:
+    std::ofstream file;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    std::vector<uint8_t> row;
+    uint64_t rows;
+    std::streamoff count_offset;
+};
+
+/**
+ * @brief Reads rows in batches through a fixed-size buffer, so memory does
+ *        not grow with the number of vectors
+ */
+class VectorFileReader {
+public:
+    VectorFileReader() : rows(0), rows_read(0), row_bytes(0), data_offset(0) {}
+
+    bool open(const std::string& path);
+
+    uint64_t size() const { return rows; }
+    const std::vector<std::string>& inputColumns() const { return inputs; }
+    const std::vector<std::string>& outputColumns() const { return outputs; }
+    uint64_t position() const { return rows_read; }
+
+    /**
+     * @brief Go back to the first row
+     */
+    bool rewind();
+
+    /**
+     * @brief Decode up to max_rows rows into batch (resized to the number
+     *        read; 0 at the end of the file or on a read error)
+     *
+     * Vectors already in batch are reused: when a row drives every input
+     * and checks every output, its values are updated in place.
+     */
+    size_t readBatch(std::vector<TestVector>& batch, size_t max_rows);
+
+    const char* error() const { return error_message.empty() ? nullptr : error_message.c_str(); }
+
+private:
+    void decodeRow(const uint8_t* data, TestVector& test_vector) const;
+
+    std::ifstream file;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    // Columns visited in name order, matching TestVector's sorted maps
+    std::vector<int> input_order;
+    std::vector<int> output_order;
+    std::vector<uint8_t> buffer;
+    uint64_t rows;
+    uint64_t rows_read;
+    size_t row_bytes;
+    std::streamoff data_offset;
+    std::string error_message;
+};
+
+} // namespace FModel
+
+#endif // VECTOR_FILE_H
@@ -115,24 +115,10 @@ class VerilogParser:
         return content
     
     def _extract_module_body(self, content: str, start_pos: int) -> str:
-        """Extract the body of a module until the matching endmodule"""
-        brace_count = 0
-        pos = start_pos
-        in_module = False
-        
-        while pos < len(content):
-            if content[pos:pos+6].lower() == 'module':
-                brace_count += 1
-                in_module = True
-                pos += 6
-            elif content[pos:pos+9].lower() == 'endmodule':
-                if in_module and brace_count == 1:
-                    return content[start_pos:pos].strip()
-                brace_count -= 1
-                pos += 9
-            else:
-                pos += 1
-                
+        """Extract the body of a module until its endmodule (modules do not nest)"""
+        match = re.search(r'\bendmodule\b', content[start_pos:], re.IGNORECASE)
+        if match:
+            return content[start_pos:start_pos + match.start()].strip()
         return content[start_pos:].strip()
     
     def _parse_module(self, name: str, port_list: str, body: str) -> Module:
@@ -505,31 +491,37 @@ def sanitize_signal_name(name: str) -> str:
     name = name.replace(':', '_')
     return name
 
+def unit_dffe_gate(inst: ModuleInstance) -> Optional[Gate]:
+    """DFF gate for a UNIT_DFFE instance, or None if a port is unconnected"""
+    # Accept common port names (D/d, CLK/clk, Q/q)
+    d_port = 'D' if 'D' in inst.connections else 'd'
+    clk_port = 'CLK' if 'CLK' in inst.connections else 'clk'
+    q_port = 'Q' if 'Q' in inst.connections else 'q'
+    if d_port in inst.connections and clk_port in inst.connections and q_port in inst.connections:
+        d_sig = sanitize_signal_name(inst.connections[d_port])
+        clk_sig = sanitize_signal_name(inst.connections[clk_port])
+        q_sig = sanitize_signal_name(inst.connections[q_port])
+        return Gate(gate_type='DFF', inputs=[d_sig, clk_sig], output=q_sig, instance_name=f"{inst.instance_name}_DFF")
+    return None
+
 def flatten_module_gates(module: Module, modules: Dict[str, Module]) -> List[Gate]:
     flat: List[Gate] = []
-    # If this module has no instances, copy local gates; otherwise rely on flattened instances
-    if not module.instances:
-        for g in module.gates:
-            new_g = Gate(gate_type=g.gate_type,
-                         inputs=[sanitize_signal_name(s) for s in g.inputs],
-                         output=sanitize_signal_name(g.output),
-                         instance_name=g.instance_name)
-            flat.append(new_g)
+    # Local gates first, then the inlined submodules
+    for g in module.gates:
+        new_g = Gate(gate_type=g.gate_type,
+                     inputs=[sanitize_signal_name(s) for s in g.inputs],
+                     output=sanitize_signal_name(g.output),
+                     instance_name=g.instance_name)
+        flat.append(new_g)
     # Inline submodules
     port_names_in = set(s.name for s in module.inputs)
     port_names_out = set(s.name for s in module.outputs)
     for inst in module.instances:
         # Virtual primitive: UNIT_DFFE maps directly to a DFF gate
         if inst.module_name == 'UNIT_DFFE':
-            # Accept common port names (D/d, CLK/clk, Q/q)
-            d_port = 'D' if 'D' in inst.connections else 'd'
-            clk_port = 'CLK' if 'CLK' in inst.connections else 'clk'
-            q_port = 'Q' if 'Q' in inst.connections else 'q'
-            if d_port in inst.connections and clk_port in inst.connections and q_port in inst.connections:
-                d_sig = sanitize_signal_name(inst.connections[d_port])
-                clk_sig = sanitize_signal_name(inst.connections[clk_port])
-                q_sig = sanitize_signal_name(inst.connections[q_port])
-                flat.append(Gate(gate_type='DFF', inputs=[d_sig, clk_sig], output=q_sig, instance_name=f"{inst.instance_name}_DFF"))
+            dff = unit_dffe_gate(inst)
+            if dff:
+                flat.append(dff)
             continue
         if inst.module_name not in modules:
             continue
@@ -564,6 +556,72 @@ def flatten_module_gates(module: Module, modules: Dict[str, Module]) -> List[Gat
                              instance_name=f"{inst.instance_name}_{g.instance_name}"))
     return flat
 
+def module_local_gates(module: Module) -> List[Gate]:
+    """Gates that stay in the module when its submodules are kept as templates:
+    what flatten_module_gates() emits before inlining any submodule"""
+    local: List[Gate] = []
+    for g in module.gates:
+        local.append(Gate(gate_type=g.gate_type,
+                          inputs=[sanitize_signal_name(s) for s in g.inputs],
+                          output=sanitize_signal_name(g.output),
+                          instance_name=g.instance_name))
+    for inst in module.instances:
+        if inst.module_name == 'UNIT_DFFE':
+            dff = unit_dffe_gate(inst)
+            if dff:
+                local.append(dff)
+    return local
+
+def ic_instance_json(ic: 'ICInstance') -> Dict:
+    return {
+        'instance_id': ic.instance_id,
+        'part_number': ic.part_number,
+        'package': ic.package,
+        'pin_assignments': ic.pin_assignments,
+        'gates': [{'type': g.gate_type, 'inputs': g.inputs, 'output': g.output} for g in ic.gates]
+    }
+
+def hierarchical_netlist_json(top: Module, modules: Dict[str, Module]) -> Dict:
+    """JSON netlist keeping every instantiated module as one shared template.
+
+    Each module lists its own ICs and its 'module_instances' (port -> net
+    connections, names sanitized as flatten_module_gates() maps them); the
+    top-level object also carries every module it reaches under 'modules'.
+    Flattening this description gives the same logic as the flat export.
+    """
+    def module_json(module: Module) -> Dict:
+        ic_instances = GateToICMapper().map_gates_to_ics(module_local_gates(module))
+        return {
+            'module_name': module.name,
+            'inputs': [{'name': s.name, 'width': s.width} for s in module.inputs],
+            'outputs': [{'name': s.name, 'width': s.width} for s in module.outputs],
+            'ic_instances': [ic_instance_json(ic) for ic in ic_instances],
+            'module_instances': [
+                {
+                    'instance_name': inst.instance_name,
+                    'module_name': inst.module_name,
+                    'connections': {port: sanitize_signal_name(net) for port, net in inst.connections.items()}
+                }
+                for inst in module.instances
+                if inst.module_name != 'UNIT_DFFE' and inst.module_name in modules
+            ]
+        }
+
+    # Every module the top reaches, each once, submodules first
+    order: List[str] = []
+    seen = {top.name}
+    def visit(module: Module):
+        for inst in module.instances:
+            if inst.module_name in modules and inst.module_name != 'UNIT_DFFE' and inst.module_name not in seen:
+                seen.add(inst.module_name)
+                visit(modules[inst.module_name])
+                order.append(inst.module_name)
+    visit(top)
+
+    netlist = module_json(top)
+    netlist['modules'] = [module_json(modules[name]) for name in order]
+    return netlist
+
 class GateToICMapper:
     """Gate-to-IC mapper with proper pin assignments"""
     
@@ -1116,6 +1174,8 @@ def main():
                        help='Verbose output')
     parser.add_argument('--json', help='Export netlist as JSON', 
                        action='store_true')
+    parser.add_argument('--hierarchical', action='store_true',
+                       help='Also export a JSON netlist keeping each instantiated module as a shared template')
     
     args = parser.parse_args()
     
@@ -1185,16 +1245,7 @@ def main():
                 'module_name': name,
                 'inputs': [{'name': s.name, 'width': s.width} for s in module.inputs],
                 'outputs': [{'name': s.name, 'width': s.width} for s in module.outputs],
-                'ic_instances': [
-                    {
-                        'instance_id': ic.instance_id,
-                        'part_number': ic.part_number,
-                        'package': ic.package,
-                        'pin_assignments': ic.pin_assignments,
-                        'gates': [{'type': g.gate_type, 'inputs': g.inputs, 'output': g.output} for g in ic.gates]
-                    }
-                    for ic in ic_instances
-                ]
+                'ic_instances': [ic_instance_json(ic) for ic in ic_instances]
             }
             json_file = gen_dir / f"{name}_netlist.json"
             with open(json_file, 'w') as f:
@@ -1203,5 +1254,13 @@ def main():
             if args.verbose:
                 print(f"Exported JSON netlist to: {json_file}")
 
+        if args.hierarchical:
+            hier_file = gen_dir / f"{name}_hier_netlist.json"
+            with open(hier_file, 'w') as f:
+                json.dump(hierarchical_netlist_json(module, modules), f, indent=2)
+
+            if args.verbose:
+                print(f"Exported hierarchical JSON netlist to: {hier_file}")
+
 if __name__ == '__main__':
     main()